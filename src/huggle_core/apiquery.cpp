@@ -10,9 +10,13 @@
 
 #include "apiquery.hpp"
 #include <QFile>
+#include <QTimer>
+#include <QUrlQuery>
 #include <QtNetwork>
 #include <QUrl>
 #include "apiqueryresult.hpp"
+#include "querypool.hpp"
+#include "queryscheduler.hpp"
 #include "configuration.hpp"
 #include "syslog.hpp"
 #include "revertquery.hpp"
@@ -23,6 +27,13 @@
 
 using namespace Huggle;
 
+unsigned long ApiQuery::CoalescedHits = 0;
+unsigned long ApiQuery::CoalescedMisses = 0;
+QHash<QString, QPointer<ApiQuery>> ApiQuery::running;
+QHash<QString, ApiQuery::RecentReply> ApiQuery::recentReplies;
+QQueue<QPair<QString, qint64>> ApiQuery::recentOrder;
+QHash<QString, qint64> ApiQuery::lastWrite;
+
 ApiQuery::ApiQuery(Action action, WikiSite *site) : MediaWikiObject(site)
 {
     this->RequestFormat = XML;
@@ -250,20 +261,36 @@ void ApiQuery::finished()
         throw new Huggle::NullPointerException("loc ApiQuery::Result", BOOST_CURRENT_FUNCTION);
     if (this->reply == nullptr)
         throw new Huggle::NullPointerException("loc ApiQuery::reply", BOOST_CURRENT_FUNCTION);
+    // other queries to this wiki may use the slot now
+    if (QueryPool::HugglePool)
+        QueryPool::HugglePool->Scheduler->Finished(this);
+    // callbacks often read the page that was just changed, so they must not get data from before the change
+    if (this->UsingPOST || this->EditingQuery)
+        this->forgetReplies();
     ApiQueryResult *result = reinterpret_cast<ApiQueryResult*>(this->Result);
     this->temp += this->reply->readAll();
-    result->Data = QString(this->temp);
-    Query::bytesReceived += static_cast<unsigned long>(this->temp.size());
+    // results are parsed right from these bytes, so that we don't need to convert the data back from string
+    QByteArray data = this->temp;
+    result->Data = QString(data);
+    Query::bytesReceived += static_cast<unsigned long>(data.size());
     // remove the temporary data so that we save the ram
     this->temp.clear();
+    // identical queries that were waiting for us get same data, but only after we are finished
+    QList<QPointer<ApiQuery>> waiting = this->takeFollowers();
     // now we need to check if request was successful or not
     if (this->reply->error())
     {
-        this->Result->SetError(HUGGLE_EUNKNOWN, this->reply->errorString());
+        QString error = this->reply->errorString();
+        this->Result->SetError(HUGGLE_EUNKNOWN, error);
         this->reply->deleteLater();
         this->reply = nullptr;
-        this->status = StatusDone;
+        this->SetStatus(StatusDone);
         this->processFailure();
+        foreach (QPointer<ApiQuery> query, waiting)
+        {
+            if (!query.isNull())
+                query->finishCoalesced(data, error);
+        }
         return;
     }
     //! \todo This bellow needs to be fixed, rollback handling doesn't belong here
@@ -278,18 +305,263 @@ void ApiQuery::finished()
     WriteIn(this, this->reply);
     this->reply->deleteLater();
     this->reply = nullptr;
+    QString key = this->coalescingKey;
+    this->processReply(data);
+    // result might have been replaced if the query was only validating the cache
+    if (!key.isEmpty() && !this->GetApiQueryResult()->IsFailed())
+        ApiQuery::rememberReply(key, data, this->sentTime);
+    foreach (QPointer<ApiQuery> query, waiting)
+    {
+        if (!query.isNull())
+            query->finishCoalesced(data, QString());
+    }
+}
+
+void ApiQuery::processReply(const QByteArray &data)
+{
+    ApiQueryResult *result = this->GetApiQueryResult();
     if (result->Data.isEmpty() || result->IsFailed())
     {
-        this->status = StatusInError;
+        this->SetStatus(StatusInError);
         this->processFailure();
         return;
     }
     if (this->RequestFormat == XML)
-        result->Process();
-    this->status = StatusDone;
+        result->ProcessXml(data);
+    else if (this->RequestFormat == JSON)
+        result->ProcessJson(data);
+    if (this->validatingCache)
+    {
+        this->finishValidation();
+        return;
+    }
+    if (!this->cacheKey.isEmpty() && !result->IsFailed())
+        this->storeInCache(data);
+    this->SetStatus(StatusDone);
     this->processCallback();
 }
 
+ResponseCache::Policy ApiQuery::GetCachePolicy()
+{
+    // writes and everything that contains tokens or passwords must never end up on disk
+    if (!ResponseCache::IsOpen() || this->CachePolicy == ResponseCache::PolicyNever || this->UsingPOST || this->EditingQuery ||
+            this->HiddenQuery || this->Parameters.contains("token"))
+        return ResponseCache::PolicyNever;
+    QUrlQuery query(this->Parameters);
+    if (this->CachePolicy == ResponseCache::PolicyValidated)
+    {
+        // we can only check revision of content of single page, and only if its id is part of the result
+        QStringList properties = query.queryItemValue("rvprop", QUrl::FullyDecoded).split("|");
+        if (this->actionPart == "query" && query.queryItemValue("prop") == "revisions" && properties.count() == 2 &&
+                properties.contains("ids") && properties.contains("content") && query.hasQueryItem("titles") &&
+                !query.queryItemValue("titles", QUrl::FullyDecoded).contains("|"))
+            return ResponseCache::PolicyValidated;
+        return ResponseCache::PolicyNever;
+    }
+    if (this->actionPart == "compare")
+    {
+        // diff to current version of page changes with every edit, diff between two revisions doesn't
+        if (query.hasQueryItem("fromrev") && (query.hasQueryItem("torev") || query.queryItemValue("torelative") == "prev"))
+            return ResponseCache::PolicyPermanent;
+    } else if (this->actionPart == "query")
+    {
+        // revisions never change, but lists, meta data and pages by title do, tags and visibility of user and
+        // comment of revision can change as well, so only properties that can't are allowed
+        if (!query.hasQueryItem("revids") || query.queryItemValue("prop") != "revisions" || query.hasQueryItem("titles") ||
+                query.hasQueryItem("list") || query.hasQueryItem("meta") || query.hasQueryItem("generator") || !query.hasQueryItem("rvprop"))
+            return ResponseCache::PolicyNever;
+        QStringList immutable = QStringList() << "ids" << "timestamp" << "size" << "sha1" << "content";
+        foreach (QString property, query.queryItemValue("rvprop", QUrl::FullyDecoded).split("|"))
+        {
+            if (!immutable.contains(property))
+                return ResponseCache::PolicyNever;
+        }
+        return ResponseCache::PolicyPermanent;
+    }
+    return ResponseCache::PolicyNever;
+}
+
+void ApiQuery::storeInCache(const QByteArray &data)
+{
+    QString revision;
+    if (this->cachePolicy == ResponseCache::PolicyValidated)
+    {
+        // missing page has no revision we could check later
+        revision = ResponseCache::GetRevision(this->GetApiQueryResult());
+        if (revision.isEmpty())
+            return;
+    } else if (this->GetApiQueryResult()->GetNode("badrevids") != nullptr)
+    {
+        // revision that doesn't exist yet or was deleted
+        return;
+    }
+    ResponseCache::Store(this->cacheKey, data, revision);
+}
+
+void ApiQuery::finishValidation()
+{
+    this->validatingCache = false;
+    this->URL = this->cacheKey;
+    QByteArray data = this->cachedData;
+    this->cachedData.clear();
+    bool current = ResponseCache::GetRevision(this->GetApiQueryResult()) == this->cachedRevision;
+    // result of the check is not what caller asked for
+    delete this->Result;
+    this->Result = new ApiQueryResult();
+    if (current)
+    {
+        ResponseCache::Hits++;
+        ResponseCache::Validated++;
+        this->cacheKey.clear();
+        this->Result->Data = QString(data);
+        this->processReply(data);
+        return;
+    }
+    ResponseCache::Misses++;
+    if (!this->HiddenQuery)
+        HUGGLE_DEBUG("Cached response of " + this->URL + " is outdated", 6);
+    this->coalescingKey.clear();
+    this->schedule();
+}
+
+void ApiQuery::finishCoalesced(const QByteArray &data, const QString &error)
+{
+    // query might have been killed while it was waiting
+    if (this->status != StatusProcessing)
+        return;
+    this->GetApiQueryResult()->Data = QString(data);
+    if (!error.isEmpty())
+    {
+        this->Result->SetError(HUGGLE_EUNKNOWN, error);
+        this->SetStatus(StatusDone);
+        this->processFailure();
+        return;
+    }
+    if (!this->HiddenQuery)
+        HUGGLE_DEBUG("Finished coalesced request " + this->URL, 6);
+    this->processReply(data);
+}
+
+void ApiQuery::finishFromRecent()
+{
+    QByteArray data = this->coalescedData;
+    this->coalescedData.clear();
+    this->finishCoalesced(data, QString());
+}
+
+bool ApiQuery::IsProcessed()
+{
+    if (this->isQueued && this->status == StatusProcessing)
+        return false;
+    return Query::IsProcessed();
+}
+
+bool ApiQuery::isCoalescable()
+{
+    if (this->UsingPOST || this->EditingQuery)
+        return false;
+    if (this->actionPart != "query" && this->actionPart != "parse" && this->actionPart != "compare")
+        return false;
+    // tokens are different after relogin, so each request for them must really be sent
+    return !this->Parameters.contains("meta=tokens");
+}
+
+bool ApiQuery::attachToIdentical()
+{
+    ApiQuery::removeOldReplies();
+    if (ApiQuery::recentReplies.contains(this->coalescingKey))
+    {
+        // callers expect the query to finish later, not inside of Process()
+        this->coalescedData = ApiQuery::recentReplies[this->coalescingKey].Data;
+        QTimer::singleShot(0, this, SLOT(finishFromRecent()));
+        return true;
+    }
+    QPointer<ApiQuery> query = ApiQuery::running.value(this->coalescingKey);
+    if (query.isNull() || query == this || query->status != StatusProcessing)
+        return false;
+    query->followers.append(this);
+    return true;
+}
+
+QList<QPointer<ApiQuery>> ApiQuery::takeFollowers()
+{
+    if (!this->coalescingKey.isEmpty() && ApiQuery::running.value(this->coalescingKey) == this)
+        ApiQuery::running.remove(this->coalescingKey);
+    QList<QPointer<ApiQuery>> result = this->followers;
+    this->followers.clear();
+    return result;
+}
+
+void ApiQuery::restartFollowers(const QString &key, const QList<QPointer<ApiQuery>> &followers)
+{
+    ApiQuery *leader = nullptr;
+    foreach (QPointer<ApiQuery> query, followers)
+    {
+        if (query.isNull() || query->status != StatusProcessing)
+            continue;
+        if (leader == nullptr)
+        {
+            leader = query;
+            ApiQuery::running.insert(key, leader);
+            leader->schedule();
+        } else
+        {
+            leader->followers.append(query);
+        }
+    }
+}
+
+void ApiQuery::rememberReply(const QString &key, const QByteArray &data, qint64 sent)
+{
+    if (hcfg->SystemConfig_QueryCoalescingWindow <= 0)
+        return;
+    // reply might contain data from before the wiki was changed
+    if (sent <= ApiQuery::lastWrite.value(key.section("api.php", 0, 0), 0))
+        return;
+    RecentReply reply;
+    reply.Data = data;
+    reply.Time = QDateTime::currentMSecsSinceEpoch();
+    ApiQuery::recentReplies.insert(key, reply);
+    ApiQuery::recentOrder.enqueue(QPair<QString, qint64>(key, reply.Time));
+}
+
+void ApiQuery::forgetReplies()
+{
+    QString wiki = this->URL.section("api.php", 0, 0);
+    ApiQuery::lastWrite.insert(wiki, QDateTime::currentMSecsSinceEpoch());
+    QHash<QString, RecentReply>::iterator reply = ApiQuery::recentReplies.begin();
+    while (reply != ApiQuery::recentReplies.end())
+    {
+        if (reply.key().section("api.php", 0, 0) == wiki)
+            reply = ApiQuery::recentReplies.erase(reply);
+        else
+            ++reply;
+    }
+    // queries that are running were sent before the change, so new queries must not wait for them,
+    // queries that already wait for them still get their data
+    QHash<QString, QPointer<ApiQuery>>::iterator query = ApiQuery::running.begin();
+    while (query != ApiQuery::running.end())
+    {
+        if (query.key().section("api.php", 0, 0) == wiki && !query.value().isNull() && query.value()->sentTime > 0)
+            query = ApiQuery::running.erase(query);
+        else
+            ++query;
+    }
+}
+
+void ApiQuery::removeOldReplies()
+{
+    qint64 oldest = QDateTime::currentMSecsSinceEpoch() - hcfg->SystemConfig_QueryCoalescingWindow;
+    while (!ApiQuery::recentOrder.isEmpty() && ApiQuery::recentOrder.head().second < oldest)
+    {
+        QPair<QString, qint64> item = ApiQuery::recentOrder.dequeue();
+        // same query might have been remembered again later, in which case it's not old yet
+        QHash<QString, RecentReply>::iterator reply = ApiQuery::recentReplies.find(item.first);
+        if (reply != ApiQuery::recentReplies.end() && reply.value().Time == item.second)
+            ApiQuery::recentReplies.erase(reply);
+    }
+}
+
 void ApiQuery::Process()
 {
     if (this->status != Query::StatusNull)
@@ -306,7 +578,7 @@ void ApiQuery::Process()
     {
         this->failureReason = "Unable to edit read-only wiki";
         this->Result->SetError(HUGGLE_EREADONLY, this->failureReason);
-        this->status = StatusInError;
+        this->SetStatus(StatusInError);
         this->processFailure();
         return;
     }
@@ -319,31 +591,102 @@ void ApiQuery::Process()
         // remove the trailing symbol
         this->Parameters = this->Parameters.mid(1);
     }
+    if (this->validatingCache)
+    {
+        // query was restarted while it was checking revision of cached content
+        this->URL = this->cacheKey;
+        this->validatingCache = false;
+        this->cachedData.clear();
+    }
     if (!this->URL.size() && !this->UsingPOST)
         this->constructUrl();
-    this->status = StatusProcessing;
-    QUrl url;
+    this->SetStatus(StatusProcessing);
     if (this->UsingPOST)
-    {
         this->URL = this->constructParameterLessUrl();
-        url = QUrl::fromEncoded(this->URL.toUtf8());
-    } else
-    {
-        url = QUrl::fromEncoded(this->URL.toUtf8());
-    }
-    QNetworkRequest request(url);
-    request.setRawHeader("User-Agent", Configuration::HuggleConfiguration->WebRequest_UserAgent);
-    if (this->UsingPOST)
-        request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
     if (Configuration::HuggleConfiguration->SystemConfig_DryMode && this->EditingQuery)
     {
         this->Result->Data = "DM (didn't run a query)";
-        this->status = StatusDone;
+        this->SetStatus(StatusDone);
         this->processCallback();
         Syslog::HuggleLogs->Log("If I wasn't in dry mode I would execute this query (post=" + Generic::Bool2String(this->UsingPOST) +
                                 ") " + this->URL + "\ndata: " + QUrl::fromPercentEncoding(this->Parameters.toUtf8()));
         return;
     }
+    this->cacheKey.clear();
+    this->cachePolicy = this->GetCachePolicy();
+    if (this->cachePolicy != ResponseCache::PolicyNever)
+    {
+        QByteArray data;
+        QString revision;
+        if (!ResponseCache::Lookup(this->URL, &data, &revision))
+        {
+            ResponseCache::Misses++;
+            this->cacheKey = this->URL;
+        } else if (this->cachePolicy == ResponseCache::PolicyPermanent)
+        {
+            ResponseCache::Hits++;
+            if (!this->HiddenQuery)
+                HUGGLE_DEBUG("Using cached response of " + this->URL, 6);
+            // callers expect the query to finish later, not inside of Process()
+            this->coalescedData = data;
+            QTimer::singleShot(0, this, SLOT(finishFromRecent()));
+            return;
+        } else
+        {
+            // only id of current revision is retrieved, cached content is used if it's same
+            this->cacheKey = this->URL;
+            this->validatingCache = true;
+            this->cachedData = data;
+            this->cachedRevision = revision;
+            this->URL = ResponseCache::GetValidationUrl(this->URL);
+        }
+    }
+    this->coalescingKey.clear();
+    if (this->isCoalescable())
+    {
+        // URL contains the wiki, action and all parameters, so same URL means same request
+        this->coalescingKey = this->URL;
+        if (this->attachToIdentical())
+        {
+            ApiQuery::CoalescedHits++;
+            if (!this->HiddenQuery)
+                HUGGLE_DEBUG("Coalesced api request " + this->URL, 6);
+            return;
+        }
+        ApiQuery::CoalescedMisses++;
+        ApiQuery::running.insert(this->coalescingKey, this);
+    }
+    this->schedule();
+}
+
+void ApiQuery::schedule()
+{
+    if (QueryPool::HugglePool)
+        QueryPool::HugglePool->Scheduler->Schedule(this);
+    else
+        this->sendRequest();
+}
+
+ApiQuery::Priority ApiQuery::GetPriority()
+{
+    if (this->RequestPriority != PriorityAuto)
+        return this->RequestPriority;
+    return this->EditingQuery ? PriorityInteractiveWrite : PriorityInteractiveRead;
+}
+
+QString ApiQuery::QueryStatusToString()
+{
+    if (this->isQueued && this->status == StatusProcessing && this->CustomStatus.isEmpty())
+        return "Queued (" + QueryScheduler::PriorityToString(this->GetPriority()) + ")";
+    return Query::QueryStatusToString();
+}
+
+void ApiQuery::sendRequest()
+{
+    QNetworkRequest request(QUrl::fromEncoded(this->URL.toUtf8()));
+    request.setRawHeader("User-Agent", Configuration::HuggleConfiguration->WebRequest_UserAgent);
+    if (this->UsingPOST)
+        request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
     // Calculate size of outgoing request
     int request_size = 0;
     QList<QByteArray> headerList = request.rawHeaderList();
@@ -354,6 +697,7 @@ void ApiQuery::Process()
     else
         request_size += this->URL.size();
     Query::bytesSent += static_cast<unsigned long>(request_size);
+    this->sentTime = QDateTime::currentMSecsSinceEpoch();
     WriteOut(this, &request);
     if (this->UsingPOST)
     {
@@ -384,13 +728,31 @@ void ApiQuery::Kill()
                 this->Result = new ApiQueryResult();
                 this->Result->SetError(HUGGLE_EKILLED, "Killed");
             }
-            this->status = StatusKilled;
+            this->SetStatus(StatusKilled);
             this->disconnect(this->reply);
             this->reply->abort();
             this->reply->disconnect(this);
             this->reply->deleteLater();
             this->reply = nullptr;
+            if (QueryPool::HugglePool)
+                QueryPool::HugglePool->Scheduler->Finished(this);
+            QString key = this->coalescingKey;
+            ApiQuery::restartFollowers(key, this->takeFollowers());
+        }
+    } else if (this->status == StatusProcessing && (this->isQueued || !this->coalescingKey.isEmpty() || !this->coalescedData.isEmpty()))
+    {
+        // query is waiting in scheduler, for result of identical query or for data from cache, all will just skip it
+        if (this->Result == nullptr)
+        {
+            this->Result = new ApiQueryResult();
+            this->Result->SetError(HUGGLE_EKILLED, "Killed");
         }
+        this->SetStatus(StatusKilled);
+        this->isQueued = false;
+        this->coalescedData.clear();
+        // others might be waiting for this query if it didn't get out of the scheduler yet
+        QString key = this->coalescingKey;
+        ApiQuery::restartFollowers(key, this->takeFollowers());
     }
 }
 
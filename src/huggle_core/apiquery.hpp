@@ -14,10 +14,16 @@
 #include "definitions.hpp"
 
 #include <QString>
+#include <QHash>
+#include <QList>
 #include <QObject>
+#include <QPair>
+#include <QPointer>
+#include <QQueue>
 #include "collectable_smartptr.hpp"
 #include "query.hpp"
 #include "mediawikiobject.hpp"
+#include "responsecache.hpp"
 class QNetworkReply;
 
 namespace Huggle
@@ -53,26 +59,44 @@ namespace Huggle
     //! This class can be used to execute any kind of api query on any MW wiki
     class HUGGLE_EX_CORE ApiQuery : public QObject, public Query, public MediaWikiObject
     {
-        //! Format in which the result will be returned
-        enum Format
-        {
-            XML,
-            JSON,
-            PlainText,
-            Default
-        };
-
-        enum Token
-        {
-            TokenLogin,
-            TokenCsrf,
-            TokenRollback,
-            TokenPatrol,
-            TokenWatch
-        };
-
             Q_OBJECT
         public:
+            //! Format in which the result will be returned, only XML results are processed into
+            //! nodes, for other formats the caller needs to parse Result->Data on its own
+            enum Format
+            {
+                XML,
+                JSON,
+                PlainText,
+                Default
+            };
+
+            //! Order in which queries are sent by QueryScheduler when there are more of them than free slots for the wiki
+            enum Priority
+            {
+                //! Interactive write for queries that edit the wiki, interactive read for the rest
+                PriorityAuto = -1,
+                PriorityInteractiveWrite = 0,
+                PriorityInteractiveRead = 1,
+                //! Data that are retrieved in advance, for example when edits are post processed
+                PriorityPrefetch = 2,
+                PriorityBackground = 3
+            };
+
+            enum Token
+            {
+                TokenLogin,
+                TokenCsrf,
+                TokenRollback,
+                TokenPatrol,
+                TokenWatch
+            };
+
+            //! Number of read queries that got their result from identical query that was running or finished just before
+            static unsigned long CoalescedHits;
+            //! Number of read queries that could have been coalesced, but had to be sent
+            static unsigned long CoalescedMisses;
+
             explicit ApiQuery(Action action, WikiSite *site);
             ~ApiQuery() override;
             Action GetAction();
@@ -92,7 +116,14 @@ namespace Huggle
             QString QueryTargetToString() override;
             //! Returns a type of query as a string
             QString QueryTypeToString() override;
+            QString QueryStatusToString() override;
+            //! Api queries are finished by their network reply, so they never need to be polled
+            bool IsPolled() override { return false; }
+            //! Query that waits in QueryScheduler is never processed, its time out starts once it's sent
+            bool IsProcessed() override;
             QString GetURL();
+            //! Returns priority of query, which is never PriorityAuto
+            Priority GetPriority();
             void SetParam(const QString& name, const QString& value);
             void SetToken(Token token, QString name = "", QString value = "");
             bool EnforceLogin = true;
@@ -102,6 +133,11 @@ namespace Huggle
             bool UsingPOST = false;
             //! This is a requested format in which the result should be written in
             Format RequestFormat;
+            Priority RequestPriority = PriorityAuto;
+            //! Whether the response may be stored to ResponseCache and used from it, writes and tokens are never cached
+            ResponseCache::Policy CachePolicy = ResponseCache::PolicyAuto;
+            //! Returns how the response of this query is cached, which is never PolicyAuto, parameters must be already set
+            ResponseCache::Policy GetCachePolicy();
             bool IsContinuous = false;
             //! This is an url of api request, you probably don't want to change it unless
             //! you want to construct whole api request yourself
@@ -115,7 +151,59 @@ namespace Huggle
         private slots:
             void readData();
             void finished();
+            void finishFromRecent();
         private:
+            struct RecentReply
+            {
+                QByteArray Data;
+                qint64 Time;
+            };
+            //! Reads that don't depend on tokens or login state can share result with identical queries
+            bool isCoalescable();
+            //! Wait for result of identical query instead of sending this one, returns false if there is none
+            bool attachToIdentical();
+            //! Pass the query to QueryScheduler, which sends it once there is a free slot for it
+            void schedule();
+            void sendRequest();
+            //! Finish this query with data that were received by identical query
+            void finishCoalesced(const QByteArray &data, const QString &error);
+            void processReply(const QByteArray &data);
+            void storeInCache(const QByteArray &data);
+            //! Use cached content if revision didn't change, otherwise send the original request
+            void finishValidation();
+            //! Remove this query from list of running queries and return queries that were waiting for it
+            QList<QPointer<ApiQuery>> takeFollowers();
+            //! Queries that were waiting for identical query which was killed need to send it on their own
+            static void restartFollowers(const QString &key, const QList<QPointer<ApiQuery>> &followers);
+            //! Remember result of query that was sent at given time (ms since epoch), unless something was written to wiki since then
+            static void rememberReply(const QString &key, const QByteArray &data, qint64 sent);
+            static void removeOldReplies();
+            //! Drop results and running queries of wiki that were read before this query wrote to it
+            void forgetReplies();
+            //! Running queries that others may wait for, by URL
+            static QHash<QString, QPointer<ApiQuery>> running;
+            //! Results of queries that finished within SystemConfig_QueryCoalescingWindow
+            static QHash<QString, RecentReply> recentReplies;
+            static QQueue<QPair<QString, qint64>> recentOrder;
+            //! Time of last finished write to wiki, by url of its api
+            static QHash<QString, qint64> lastWrite;
+            //! Time when the request was sent, in ms since epoch
+            qint64 sentTime = 0;
+            QList<QPointer<ApiQuery>> followers;
+            QString coalescingKey;
+            QByteArray coalescedData;
+            //! URL under which the response is cached, empty if it shouldn't be cached
+            QString cacheKey;
+            ResponseCache::Policy cachePolicy = ResponseCache::PolicyNever;
+            //! Request that is running only checks the revision of content we have in cache
+            bool validatingCache = false;
+            QByteArray cachedData;
+            QString cachedRevision;
+            //! Query waits in a queue of QueryScheduler
+            bool isQueued = false;
+            //! Request was sent by QueryScheduler, which needs to know when it's finished
+            bool isScheduled = false;
+            friend class QueryScheduler;
             //! Generate api url
             void constructUrl();
             QString constructParameterLessUrl();
@@ -0,0 +1,148 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "apiquerybatch.hpp"
+#include <QUrl>
+#include "apiqueryresult.hpp"
+#include "configuration.hpp"
+#include "exception.hpp"
+#include "projectconfiguration.hpp"
+#include "querypool.hpp"
+#include "syslog.hpp"
+#include "wikisite.hpp"
+
+using namespace Huggle;
+
+QHash<QString, ApiQueryBatch*> ApiQueryBatch::batches;
+unsigned long long ApiQueryBatch::QueriesSent = 0;
+unsigned long long ApiQueryBatch::ValuesRequested = 0;
+
+Collectable_SmartPtr<ApiQuery> ApiQueryBatch::Request(WikiSite *site, const QString &parameters, const QString &list_parameter,
+                                                      const QString &value, int limit)
+{
+    if (site == nullptr)
+        throw new Huggle::NullPointerException("WikiSite *site", BOOST_CURRENT_FUNCTION);
+
+    // batches are identified by site and everything except for the list of values
+    QString key = site->Name + "\n" + parameters + "\n" + list_parameter;
+    ApiQueryBatch *batch = ApiQueryBatch::batches.value(key, nullptr);
+    if (batch == nullptr)
+    {
+        if (limit < 1)
+            limit = ApiQueryBatch::GetLimit(site);
+        batch = new ApiQueryBatch(site, parameters, list_parameter, limit);
+        ApiQueryBatch::batches.insert(key, batch);
+    }
+    return batch->Append(value);
+}
+
+int ApiQueryBatch::GetLimit(WikiSite *site)
+{
+    if (site->GetProjectConfig()->Rights.contains("apihighlimits"))
+        return HUGGLE_APIQUERY_BATCH_HIGH_LIMIT;
+    return HUGGLE_APIQUERY_BATCH_LIMIT;
+}
+
+void ApiQueryBatch::FlushAll()
+{
+    foreach (ApiQueryBatch *batch, ApiQueryBatch::batches)
+        batch->Flush();
+}
+
+void ApiQueryBatch::DeleteAll()
+{
+    qDeleteAll(ApiQueryBatch::batches);
+    ApiQueryBatch::batches.clear();
+}
+
+ApiQueryResultNode *ApiQueryBatch::FindPage(ApiQuery *query, const QString &title)
+{
+    if (query == nullptr)
+        throw new Huggle::NullPointerException("ApiQuery *query", BOOST_CURRENT_FUNCTION);
+
+    // mediawiki returns titles in normalized form, so we need to look up the name it was normalized to first
+    QString normalized_title = title;
+    ApiQueryResultNode *normalized = ApiQueryBatch::FindNode(query, "n", "from", title);
+    if (normalized != nullptr)
+        normalized_title = normalized->GetAttribute("to");
+    return ApiQueryBatch::FindNode(query, "page", "title", normalized_title);
+}
+
+ApiQueryResultNode *ApiQueryBatch::FindNode(ApiQuery *query, const QString &name, const QString &attribute, const QString &value)
+{
+    if (query == nullptr)
+        throw new Huggle::NullPointerException("ApiQuery *query", BOOST_CURRENT_FUNCTION);
+
+    foreach (ApiQueryResultNode *node, query->GetApiQueryResult()->GetNodes(name))
+    {
+        if (node->GetAttribute(attribute) == value)
+            return node;
+    }
+    return nullptr;
+}
+
+ApiQueryBatch::ApiQueryBatch(WikiSite *site, const QString &parameters, const QString &list_parameter, int limit)
+{
+    this->site = site;
+    this->parameters = parameters;
+    this->listParameter = list_parameter;
+    this->limit = limit;
+    this->timer = new QTimer(this);
+    this->timer->setSingleShot(true);
+    connect(this->timer, SIGNAL(timeout()), this, SLOT(OnTimer()));
+}
+
+ApiQueryBatch::~ApiQueryBatch()
+{
+    // batches are only deleted on shutdown, so there is no point in sending what's left in them
+    this->timer->stop();
+}
+
+Collectable_SmartPtr<ApiQuery> ApiQueryBatch::Append(const QString &value)
+{
+    if (this->query == nullptr)
+    {
+        this->query = new ApiQuery(ActionQuery, this->site);
+        // batches are only used to retrieve data of edits in advance
+        this->query->RequestPriority = ApiQuery::PriorityPrefetch;
+        // list of values may be too long for url
+        this->query->UsingPOST = true;
+        this->timer->start(HUGGLE_APIQUERY_BATCH_WINDOW);
+    }
+    Collectable_SmartPtr<ApiQuery> result = this->query;
+    if (!this->values.contains(value))
+    {
+        this->values.append(value);
+        if (this->values.count() >= this->limit)
+            this->Flush();
+    }
+    return result;
+}
+
+void ApiQueryBatch::Flush()
+{
+    this->timer->stop();
+    if (this->query == nullptr)
+        return;
+    this->query->Target = this->listParameter + ": " + this->values.join(", ");
+    this->query->Parameters = this->parameters + "&" + this->listParameter + "=" + QUrl::toPercentEncoding(this->values.join("|"));
+    HUGGLE_DEBUG("Sending batch of " + QString::number(this->values.count()) + " " + this->listParameter + " to " + this->site->Name, 3);
+    HUGGLE_QP_APPEND(this->query);
+    this->query->Process();
+    ApiQueryBatch::QueriesSent++;
+    ApiQueryBatch::ValuesRequested += static_cast<unsigned long long>(this->values.count());
+    this->query = nullptr;
+    this->values.clear();
+}
+
+void ApiQueryBatch::OnTimer()
+{
+    this->Flush();
+}
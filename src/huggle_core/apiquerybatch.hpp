@@ -0,0 +1,92 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef APIQUERYBATCH_HPP
+#define APIQUERYBATCH_HPP
+
+#include "definitions.hpp"
+
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include "apiquery.hpp"
+#include "collectable_smartptr.hpp"
+
+//! How long a batch waits for more values before it's sent, in ms
+#define HUGGLE_APIQUERY_BATCH_WINDOW        50
+//! Number of values that can be in one request (titles, revids, ususers)
+#define HUGGLE_APIQUERY_BATCH_LIMIT         50
+//! Number of values that can be in one request when user has apihighlimits
+#define HUGGLE_APIQUERY_BATCH_HIGH_LIMIT    500
+
+namespace Huggle
+{
+    class ApiQueryResultNode;
+    class WikiSite;
+
+    /*!
+     * \brief Merges api requests that differ only in a list of values into one request
+     *
+     * Many edits need same kind of information at same time, for example information about users who made them.
+     * Instead of sending a request for each of them, every edit appends its value (user name, title, revid) to a
+     * batch and gets the query of that batch, which is shared by all of them and contains results for all values.
+     * Batch is sent once it reaches the limit of api or HUGGLE_APIQUERY_BATCH_WINDOW ms after first value was appended.
+     */
+    class HUGGLE_EX_CORE ApiQueryBatch : public QObject
+    {
+            Q_OBJECT
+        public:
+            /*!
+             * \brief Append a value to batch with given parameters, batch is created if there is none
+             * \param site Site to query
+             * \param parameters Parameters of action=query that are same for all values
+             * \param list_parameter Name of parameter that contains list of values, for example titles
+             * \param value Value to append
+             * \param limit Maximal number of values in one request, 0 means limit of api for current user
+             * \return Query that will contain the result, it's not running until batch is sent
+             */
+            static Collectable_SmartPtr<ApiQuery> Request(WikiSite *site, const QString &parameters, const QString &list_parameter,
+                                                          const QString &value, int limit = 0);
+            //! Number of values that can be requested in one query on given site
+            static int GetLimit(WikiSite *site);
+            //! Send all batches that are waiting
+            static void FlushAll();
+            //! Delete all batches without sending them, this is called on shutdown
+            static void DeleteAll();
+            //! Find a page node for given title in result of batch, following normalization of titles
+            static ApiQueryResultNode *FindPage(ApiQuery *query, const QString &title);
+            //! Find a node with given name and attribute value in result of batch
+            static ApiQueryResultNode *FindNode(ApiQuery *query, const QString &name, const QString &attribute, const QString &value);
+
+            ApiQueryBatch(WikiSite *site, const QString &parameters, const QString &list_parameter, int limit);
+            ~ApiQueryBatch() override;
+            Collectable_SmartPtr<ApiQuery> Append(const QString &value);
+            //! Send the batch now, in case there is anything in it
+            void Flush();
+            //! Number of queries that were sent by all batches
+            static unsigned long long QueriesSent;
+            //! Number of values that were requested by all batches
+            static unsigned long long ValuesRequested;
+        private slots:
+            void OnTimer();
+        private:
+            static QHash<QString, ApiQueryBatch*> batches;
+            WikiSite *site;
+            QString parameters;
+            QString listParameter;
+            int limit;
+            QStringList values;
+            Collectable_SmartPtr<ApiQuery> query;
+            QTimer *timer;
+    };
+}
+
+#endif // APIQUERYBATCH_HPP
@@ -9,7 +9,8 @@
 //GNU General Public License for more details.
 
 #include "apiqueryresult.hpp"
-#include <QtXml>
+#include <QJsonObject>
+#include <QXmlStreamReader>
 #include "configuration.hpp"
 #include "exception.hpp"
 #include "syslog.hpp"
@@ -22,97 +23,156 @@ ApiQueryResult::ApiQueryResult()
 }
 
 ApiQueryResult::~ApiQueryResult()
+{
+    this->clear();
+}
+
+void ApiQueryResult::clear()
 {
     this->Nodes.clear();
-    delete this->Root;
+    this->index.clear();
+    this->nodes.clear();
+    this->Root = nullptr;
+}
+
+void ApiQueryResult::Process()
+{
+    this->ProcessXml(this->Data.toUtf8());
 }
 
-static void ProcessChildXMLNodes(ApiQueryResultNode *hiearchy_root, ApiQueryResult *result, const QDomNodeList& nodes)
+void ApiQueryResult::ProcessXml(const QByteArray &data)
 {
-    int id = 0;
-    while (id < nodes.count())
+    if (data.isEmpty())
+        throw new Huggle::Exception("There is no data to be processed", BOOST_CURRENT_FUNCTION);
+    if (this->IsFailed())
+        throw new Huggle::Exception("Not processing a failed result", BOOST_CURRENT_FUNCTION);
+
+    this->clear();
+    ApiQueryResultNode root;
+    root.Name = "Huggle_ApiQueryResultRoot";
+    this->nodes.append(root);
+    // nodes are referred to by position while the vector grows, pointers are only valid once it's complete
+    QVector<int> parents;
+    parents.append(-1);
+    QVector<int> open;
+    QXmlStreamReader reader(data);
+    while (!reader.atEnd())
     {
-        QDomElement element = nodes.at(id++).toElement();
-        if (element.tagName().isEmpty())
-            continue;
-        if (element.tagName() != "warnings")
+        QXmlStreamReader::TokenType token = reader.readNext();
+        if (token == QXmlStreamReader::StartElement)
         {
-            ApiQueryResultNode *node = new ApiQueryResultNode();
-            hiearchy_root->ChildNodes.append(node);
-            node->Name = element.tagName();
-            int attr = 0;
-            while (attr < element.attributes().count())
+            if (reader.name() == "warnings")
             {
-                QDomAttr ca = element.attributes().item(attr).toAttr();
-                attr++;
-                if (!node->Attributes.contains(ca.name()))
-                    node->Attributes.insert(ca.name(), ca.value());
-                else
-                    Syslog::HuggleLogs->WarningLog("Invalid xml node (present multiple times) " + ca.name() + " in " + element.tagName());
+                this->readWarnings(&reader);
+                continue;
             }
-            result->Nodes.append(node);
-            if (element.childNodes().count())
-                ProcessChildXMLNodes(node, result, element.childNodes());
-
-            node->Value = element.text();
-            if (node->Name == "error")
-            {
-                QString code = node->GetAttribute("code");
-                result->SetError(HUGGLE_EUNKNOWN, "code: " + code + " details: " + node->Value);
-                HUGGLE_DEBUG1("Query failed: " + code + " details: " + node->Value);
-                HUGGLE_DEBUG(result->Data, 8);
-            }
-        }
-        if (element.tagName() == "warnings" && !hcfg->SystemConfig_SuppressWarnings)
+            ApiQueryResultNode node;
+            node.Name = reader.name().toString();
+            foreach (QXmlStreamAttribute attribute, reader.attributes())
+                node.Attributes.insert(attribute.name().toString(), attribute.value().toString());
+            parents.append(open.isEmpty() ? 0 : open.last());
+            open.append(this->nodes.count());
+            this->nodes.append(node);
+        } else if (token == QXmlStreamReader::Characters)
         {
-            // there are some warnings which we need to find now
-            int cn = 0;
-            while (element.childNodes().count() > cn)
+            // value of node is all text inside of it, including text of child nodes
+            QString text = reader.text().toString();
+            foreach (int id, open)
+                this->nodes[id].Value += text;
+        } else if (token == QXmlStreamReader::EndElement && !open.isEmpty())
+        {
+            const ApiQueryResultNode &node = this->nodes.at(open.takeLast());
+            if (node.Name == "error")
             {
-                QDomElement warning = element.childNodes().at(cn++).toElement();
-                Syslog::HuggleLogs->WarningLog("API query (" + warning.tagName() + "): " + warning.text());
-                result->Warning = warning.text();
+                QString code = node.Attributes.value("code");
+                this->SetError(HUGGLE_EUNKNOWN, "code: " + code + " details: " + node.Value);
+                HUGGLE_DEBUG1("Query failed: " + code + " details: " + node.Value);
+                HUGGLE_DEBUG(this->Data, 8);
             }
-            HUGGLE_DEBUG(result->Data, 5);
         }
     }
+    if (reader.hasError())
+        HUGGLE_DEBUG1("Invalid XML in result of API query: " + reader.errorString());
+
+    this->Root = &this->nodes[0];
+    this->Nodes.reserve(this->nodes.count() - 1);
+    int id = 1;
+    while (id < this->nodes.count())
+    {
+        ApiQueryResultNode *node = &this->nodes[id];
+        this->nodes[parents.at(id)].ChildNodes.append(node);
+        this->Nodes.append(node);
+        this->index[node->Name].append(node);
+        id++;
+    }
 }
 
-void ApiQueryResult::Process()
+void ApiQueryResult::readWarnings(QXmlStreamReader *reader)
 {
-    if (this->Data.isEmpty())
+    // there are some warnings which we need to find now
+    while (reader->readNextStartElement())
+    {
+        QString module = reader->name().toString();
+        QString text = reader->readElementText(QXmlStreamReader::IncludeChildElements);
+        if (hcfg->SystemConfig_SuppressWarnings)
+            continue;
+        Syslog::HuggleLogs->WarningLog("API query (" + module + "): " + text);
+        this->Warning = text;
+    }
+    if (!hcfg->SystemConfig_SuppressWarnings)
+        HUGGLE_DEBUG(this->Data, 5);
+}
+
+void ApiQueryResult::ProcessJson(const QByteArray &data)
+{
+    if (data.isEmpty())
         throw new Huggle::Exception("There is no data to be processed", BOOST_CURRENT_FUNCTION);
     if (this->IsFailed())
         throw new Huggle::Exception("Not processing a failed result", BOOST_CURRENT_FUNCTION);
 
-    QDomDocument result;
-    result.setContent(this->Data);
-    this->Root = new ApiQueryResultNode();
-    this->Root->Name = "Huggle_ApiQueryResultRoot";
-    ProcessChildXMLNodes(this->Root, this, result.childNodes());
+    QJsonParseError error;
+    this->Json = QJsonDocument::fromJson(data, &error);
+    if (error.error != QJsonParseError::NoError)
+    {
+        HUGGLE_DEBUG1("Invalid JSON in result of API query: " + error.errorString());
+        return;
+    }
+    QJsonObject root = this->Json.object();
+    if (root.contains("error"))
+    {
+        QJsonObject e = root.value("error").toObject();
+        QString code = e.value("code").toString();
+        QString details = e.value("info").toString();
+        this->SetError(HUGGLE_EUNKNOWN, "code: " + code + " details: " + details);
+        HUGGLE_DEBUG1("Query failed: " + code + " details: " + details);
+        HUGGLE_DEBUG(this->Data, 8);
+    }
+    if (root.contains("warnings") && !hcfg->SystemConfig_SuppressWarnings)
+    {
+        QJsonObject warnings = root.value("warnings").toObject();
+        foreach (QString module, warnings.keys())
+        {
+            QJsonObject warning = warnings.value(module).toObject();
+            // old json format has text of warning in "*", the new one in "warnings"
+            QString text = warning.contains("warnings") ? warning.value("warnings").toString() : warning.value("*").toString();
+            Syslog::HuggleLogs->WarningLog("API query (" + module + "): " + text);
+            this->Warning = text;
+        }
+        HUGGLE_DEBUG(this->Data, 5);
+    }
 }
 
 ApiQueryResultNode *ApiQueryResult::GetNode(const QString& node_name)
 {
-    foreach (ApiQueryResultNode *node, this->Nodes)
-    {
-        if (node->Name == node_name)
-            return node;
-    }
-    return nullptr;
+    QHash<QString, QList<ApiQueryResultNode*>>::const_iterator nodes = this->index.constFind(node_name);
+    if (nodes == this->index.constEnd())
+        return nullptr;
+    return nodes.value().first();
 }
 
 QList<ApiQueryResultNode*> ApiQueryResult::GetNodes(const QString& node_name)
 {
-    QList<ApiQueryResultNode*> result;
-
-    foreach (ApiQueryResultNode *node, this->Nodes)
-    {
-        if (node->Name == node_name)
-            result.append(node);
-    }
-
-    return result;
+    return this->index.value(node_name);
 }
 
 QString ApiQueryResult::GetNodeValue(const QString &node_name, const QString &default_value)
@@ -134,16 +194,42 @@ ApiQueryResultNode::ApiQueryResultNode()
     this->Name = "Huggle_None";
 }
 
-ApiQueryResultNode::~ApiQueryResultNode()
+QString ApiQueryResultNode::GetAttribute(const QString &name, const QString &default_val)
+{
+    return this->Attributes.value(name, default_val);
+}
+
+bool ApiQueryResultAttributes::contains(const QString &name) const
 {
-    HUGGLE_CLEAR_PQ_LIST(this->ChildNodes);
+    foreach (const QPair<QString, QString> &attribute, this->attributes)
+    {
+        if (attribute.first == name)
+            return true;
+    }
+    return false;
 }
 
-QString ApiQueryResultNode::GetAttribute(const QString &name, const QString &default_val)
+QString ApiQueryResultAttributes::value(const QString &name, const QString &default_value) const
 {
-    if (!this->Attributes.contains(name))
-        return default_val;
+    foreach (const QPair<QString, QString> &attribute, this->attributes)
+    {
+        if (attribute.first == name)
+            return attribute.second;
+    }
+    return default_value;
+}
 
-    // we get the value user requested from local hash
-    return this->Attributes[name];
+void ApiQueryResultAttributes::insert(const QString &name, const QString &value)
+{
+    int i = 0;
+    while (i < this->attributes.count())
+    {
+        if (this->attributes.at(i).first == name)
+        {
+            this->attributes[i].second = value;
+            return;
+        }
+        i++;
+    }
+    this->attributes.append(QPair<QString, QString>(name, value));
 }
@@ -15,17 +15,34 @@
 #include <QString>
 #include <QList>
 #include <QHash>
+#include <QJsonDocument>
+#include <QPair>
+#include <QVector>
 #include "queryresult.hpp"
 
+class QXmlStreamReader;
+
 namespace Huggle
 {
+    //! Attributes of a node, nodes have only few of them so they are kept in a vector instead of a hash table
+    class HUGGLE_EX_CORE ApiQueryResultAttributes
+    {
+        public:
+            bool contains(const QString &name) const;
+            QString value(const QString &name, const QString &default_value = "") const;
+            QString operator[](const QString &name) const { return this->value(name); }
+            void insert(const QString &name, const QString &value);
+            int count() const { return this->attributes.count(); }
+        private:
+            QVector<QPair<QString, QString>> attributes;
+    };
+
     //! Key/value node for data from API queries
     //! \todo Currently value is provided even for nodes that shouldn't have it
     class HUGGLE_EX_CORE ApiQueryResultNode
     {
           public:
             ApiQueryResultNode();
-            ~ApiQueryResultNode();
             /*!
             * \brief GetAttribute Return the specified attribute if it exists, otherwise return the default
             * \param name Name of attribute
@@ -37,8 +54,8 @@ namespace Huggle
             QString Name;
             //! Value of attribute
             QString Value;
-            //! Hashtable of attribtues
-            QHash<QString, QString> Attributes;
+            ApiQueryResultAttributes Attributes;
+            //! Child nodes, these are owned by ApiQueryResult
             QList<ApiQueryResultNode*> ChildNodes;
     };
 
@@ -47,6 +64,9 @@ namespace Huggle
     //! this is a universal result class that uses same format for all known
     //! formats we are going to use, including XML or JSON, so that it shouldn't
     //! matter which one we use, we always get this structure as output
+
+    //! XML is parsed in a single pass of stream reader, all nodes are stored in one vector and indexed by name,
+    //! so that looking them up doesn't depend on size of the result
     class HUGGLE_EX_CORE ApiQueryResult : public QueryResult
     {
         public:
@@ -57,6 +77,10 @@ namespace Huggle
             * \brief Process Process the data into Nodes and handle any warnings / errors
             */
             void Process();
+            //! Same as Process(), but it reads the data right from the reply, so that they don't need to be converted
+            void ProcessXml(const QByteArray &data);
+            //! Parse the result of query with format=json into Json and handle errors and warnings
+            void ProcessJson(const QByteArray &data);
             /*!
             * \brief GetNode Get the first node with the specified name
             * IMPORTANT: do not delete this node, it's a pointer to item in a list which get deleted in destructor of class
@@ -80,10 +104,18 @@ namespace Huggle
             //! List of result nodes unsorted with no hierarchy
             QList<ApiQueryResultNode*> Nodes;
             ApiQueryResultNode *Root;
+            //! Parsed result of query with format=json
+            QJsonDocument Json;
             //! Warning from API query
             QString Warning;
             //! If any error was encountered during the query
             bool HasErrors = false;
+        private:
+            void clear();
+            void readWarnings(QXmlStreamReader *reader);
+            //! Storage of all nodes, first one is the root, it must not be resized once the pointers are handed out
+            QVector<ApiQueryResultNode> nodes;
+            QHash<QString, QList<ApiQueryResultNode*>> index;
     };
 }
 
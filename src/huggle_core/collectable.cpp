@@ -16,6 +16,9 @@
 #include "exception.hpp"
 #include "huggleprofiler.hpp"
 #include "syslog.hpp"
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 
 using namespace Huggle;
 
@@ -23,25 +26,44 @@ using namespace Huggle;
 unsigned long Collectable::LockCt = 0;
 #endif
 
-unsigned long Collectable::LastCID = 0;
-QMutex *Collectable::WideLock = new QMutex(QMutex::Recursive);
+QAtomicInteger<unsigned long> Collectable::LastCID(0);
+
+//! Consumers that don't have a bit in the mask, these are rare so all objects share one table and one lock
+struct CollectableSideConsumers
+{
+    QStringList Strings;
+    QList<int> Ints;
+};
+
+static QMutex sideLock;
+static QHash<const Collectable*, CollectableSideConsumers> sideTable;
+//! Consumer ids that have a bit in the mask, index in this array is the bit
+static const int maskConsumers[] =
+{
+    HUGGLECONSUMER_WIKIEDIT, HUGGLECONSUMER_QUEUE, HUGGLECONSUMER_CORE_POSTPROCESS, HUGGLECONSUMER_EDITQUERY,
+    HUGGLECONSUMER_REVERTQUERY, HUGGLECONSUMER_MESSAGE_SEND, HUGGLECONSUMER_HISTORYWIDGET, HUGGLECONSUMER_CORE_MESSAGE,
+    HUGGLECONSUMER_PROCESSOR, HUGGLECONSUMER_MAINPEND, HUGGLECONSUMER_QP, HUGGLECONSUMER_QP_UNCHECKED,
+    HUGGLECONSUMER_QP_REVERTBUFFER, HUGGLECONSUMER_MAINFORM_HISTORICAL, HUGGLECONSUMER_QP_MODS, 15,
+    HUGGLECONSUMER_REVERTQUERYTMR, HUGGLECONSUMER_QP_WATCHLIST, 18, 19,
+    HUGGLECONSUMER_CALLBACK, HUGGLECONSUMER_PYTHON, HUGGLECONSUMER_JS_POOL, HUGGLECONSUMER_JS_CACHE,
+    HUGGLECONSUMER_CORE
+};
 
 Collectable::Collectable()
 {
-    Collectable::WideLock->lock();
-    this->CID = Collectable::LastCID;
-    Collectable::LastCID++;
-    Collectable::WideLock->unlock();
+    this->CID = Collectable::LastCID.fetchAndAddRelaxed(1);
 #if PRODUCTION_BUILD == 1
-    this->ReclaimingAllowed = true;
+    this->state.storeRelease(HUGGLE_COLLECTABLE_RECLAIMABLE);
 #else
     // don't crash huggle purposefuly unless it's for development
-    this->ReclaimingAllowed = false;
+    this->state.storeRelease(0);
 #endif
-    this->_collectableLocked = false;
-    this->_collectableManaged = false;
-    this->_collectableRefs = 0;
-    this->_collectableQL = new QMutex(QMutex::Recursive);
+    this->consumers.storeRelease(0);
+    this->refs.storeRelease(0);
+    this->gcPrev = nullptr;
+    this->gcNext = nullptr;
+    this->gcListed = false;
+    this->gcReadyNext = nullptr;
 }
 
 Collectable::~Collectable()
@@ -50,32 +72,36 @@ Collectable::~Collectable()
     {
         Huggle::Exception::ThrowSoftException("Request to delete managed entity", BOOST_CURRENT_FUNCTION);
     }
-    this->Unlock();
-    delete this->_collectableQL;
+    if (this->consumers.loadAcquire() & HUGGLE_COLLECTABLE_SIDE_BIT)
+    {
+        QMutexLocker locker(&sideLock);
+        sideTable.remove(this);
+    }
+}
+
+bool Collectable::IsManaged()
+{
+    if (this->state.loadAcquire() & HUGGLE_COLLECTABLE_MANAGED)
+        return true;
+    return this->HasSomeConsumers();
 }
 
 bool Collectable::SafeDelete()
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
-    if (this->_collectableRefs == 0 && this->Consumers.count() == 0 && this->iConsumers.count() == 0)
+    if (!this->HasSomeConsumers())
     {
+        // if the object is in the queue of GC already, it's up to GC to delete it
+        if (!this->setFlag(HUGGLE_COLLECTABLE_QUEUED))
+            return false;
         if (GC::gc != nullptr)
         {
-            GC::gc->Lock->lock();
-            if (GC::gc->list.contains(this))
-            {
-                if (GC::gc->list.removeAll(this) < 1)
-                {
-                    // whoa, the application will crash soon
-                    Syslog::HuggleLogs->DebugLog("Collectable removed 0 references after its deletion from memory");
-                }
-            }
-            GC::gc->Lock->unlock();
+            GC::gc->Release(this);
         } else
         {
             Syslog::HuggleLogs->DebugLog("SafeDelete() called after GC pointer was removed");
         }
-        this->_collectableManaged = false;
+        this->clearFlag(HUGGLE_COLLECTABLE_MANAGED);
         delete this;
         return true;
     }
@@ -86,75 +112,120 @@ bool Collectable::SafeDelete()
 
 void Collectable::SetReclaimable()
 {
-    this->ReclaimingAllowed = true;
+    this->setFlag(HUGGLE_COLLECTABLE_RECLAIMABLE);
 }
 
 void Collectable::DecRef()
 {
-    if (!this->_collectableRefs)
+    int previous = this->refs.fetchAndAddOrdered(-1);
+    if (previous <= 0)
     {
+        this->refs.fetchAndAddOrdered(1);
         throw new Huggle::Exception("Decrementing negative reference", BOOST_CURRENT_FUNCTION);
     }
-    this->_collectableRefs--;
+    if (previous == 1)
+        this->releaseIfUnused();
+}
+
+void Collectable::checkReclaim()
+{
+    if (!(this->state.loadAcquire() & HUGGLE_COLLECTABLE_RECLAIMABLE) && this->IsManaged() && !this->HasSomeConsumers())
+        throw new Huggle::Exception("You can't reclaim this managed resource", BOOST_CURRENT_FUNCTION);
 }
 
 void Collectable::RegisterConsumer(int consumer)
 {
-    this->Lock();
-    if (this->IsManaged() && !this->HasSomeConsumers() && !this->ReclaimingAllowed)
+    this->checkReclaim();
+    int bit = consumerBit(consumer);
+    if (bit >= 0)
     {
-        this->Unlock();
-        throw new Huggle::Exception("You can't reclaim this managed resource", BOOST_CURRENT_FUNCTION);
-    }
-    if (!this->iConsumers.contains(consumer))
+        this->consumers.fetchAndOrOrdered(Q_UINT64_C(1) << bit);
+    } else
     {
-        this->iConsumers.append(consumer);
+        QMutexLocker locker(&sideLock);
+#ifdef HUGGLE_PROFILING
+        Collectable::LockCt++;
+#endif
+        CollectableSideConsumers &side = sideTable[this];
+        if (!side.Ints.contains(consumer))
+            side.Ints.append(consumer);
+        this->consumers.fetchAndOrOrdered(HUGGLE_COLLECTABLE_SIDE_BIT);
     }
     this->SetManaged();
-    this->Unlock();
 }
 
 void Collectable::UnregisterConsumer(int consumer)
 {
-    this->Lock();
     if (this->IsManaged() && !this->HasSomeConsumers())
     {
-        this->Unlock();
         Syslog::HuggleLogs->DebugLog("You are working with class that was already scheduled for collection!");
         //throw new Huggle::Exception("You are working with class that was already scheduled for collection",
         //                            BOOST_CURRENT_FUNCTION);
     }
-    this->iConsumers.removeOne(consumer);
+    int bit = consumerBit(consumer);
+    if (bit >= 0)
+    {
+        this->consumers.fetchAndAndOrdered(~(Q_UINT64_C(1) << bit));
+    } else
+    {
+        QMutexLocker locker(&sideLock);
+#ifdef HUGGLE_PROFILING
+        Collectable::LockCt++;
+#endif
+        if (sideTable.contains(this))
+        {
+            CollectableSideConsumers &side = sideTable[this];
+            side.Ints.removeOne(consumer);
+            if (side.Ints.isEmpty() && side.Strings.isEmpty())
+            {
+                sideTable.remove(this);
+                this->consumers.fetchAndAndOrdered(~HUGGLE_COLLECTABLE_SIDE_BIT);
+            }
+        }
+    }
     this->SetManaged();
-    this->Unlock();
+    this->releaseIfUnused();
 }
 
 void Collectable::RegisterConsumer(const QString &consumer)
 {
-    this->Lock();
-    if (this->IsManaged() && !this->HasSomeConsumers() && !this->ReclaimingAllowed)
-    {
-        this->Unlock();
-        throw new Huggle::Exception("You can't reclaim this managed resource", BOOST_CURRENT_FUNCTION);
-    }
-    this->Consumers.append(consumer);
-    this->Consumers.removeDuplicates();
+    this->checkReclaim();
+    QMutexLocker locker(&sideLock);
+#ifdef HUGGLE_PROFILING
+    Collectable::LockCt++;
+#endif
+    CollectableSideConsumers &side = sideTable[this];
+    if (!side.Strings.contains(consumer))
+        side.Strings.append(consumer);
+    this->consumers.fetchAndOrOrdered(HUGGLE_COLLECTABLE_SIDE_BIT);
+    locker.unlock();
     this->SetManaged();
-    this->Unlock();
 }
 
 void Collectable::UnregisterConsumer(const QString &consumer)
 {
-    this->Lock();
     if (this->IsManaged() && !this->HasSomeConsumers())
     {
-        this->Unlock();
         Huggle::Exception::ThrowSoftException("You are working with class that was already scheduled for collection",
                                               BOOST_CURRENT_FUNCTION);
     }
-    this->Consumers.removeOne(consumer);
+    QMutexLocker locker(&sideLock);
+#ifdef HUGGLE_PROFILING
+    Collectable::LockCt++;
+#endif
+    if (sideTable.contains(this))
+    {
+        CollectableSideConsumers &side = sideTable[this];
+        side.Strings.removeOne(consumer);
+        if (side.Ints.isEmpty() && side.Strings.isEmpty())
+        {
+            sideTable.remove(this);
+            this->consumers.fetchAndAndOrdered(~HUGGLE_COLLECTABLE_SIDE_BIT);
+        }
+    }
+    locker.unlock();
     this->SetManaged();
-    this->Unlock();
+    this->releaseIfUnused();
 }
 
 QString Collectable::ConsumerIdToString(int id)
@@ -175,25 +246,60 @@ QString Collectable::ConsumerIdToString(int id)
     return "Unknown consumer: " + QString::number(id);
 }
 
+int Collectable::consumerBit(int consumer)
+{
+    if (consumer >= 0 && consumer <= HUGGLECONSUMER_CALLBACK)
+        return consumer;
+    switch (consumer)
+    {
+        case HUGGLECONSUMER_PYTHON:
+            return 21;
+        case HUGGLECONSUMER_JS_POOL:
+            return 22;
+        case HUGGLECONSUMER_JS_CACHE:
+            return 23;
+        case HUGGLECONSUMER_CORE:
+            return 24;
+    }
+    return -1;
+}
+
+bool Collectable::setFlag(int flag)
+{
+    return !(this->state.fetchAndOrOrdered(flag) & flag);
+}
+
+void Collectable::clearFlag(int flag)
+{
+    this->state.fetchAndAndOrdered(~flag);
+}
+
 void Collectable::SetManaged()
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
-    if (this->_collectableManaged)
+    if (this->state.loadAcquire() & HUGGLE_COLLECTABLE_MANAGED)
     {
         return;
     }
-    this->_collectableManaged = true;
-    if (GC::gc == nullptr)
+    if (!this->setFlag(HUGGLE_COLLECTABLE_MANAGED))
     {
-        // huggle is probably shutting down
+        // other thread was faster
         return;
     }
-    GC::gc->Lock->lock();
-    if (!GC::gc->list.contains(this))
+    if (GC::gc == nullptr)
     {
-        GC::gc->list.append(this);
+        // huggle is probably shutting down
+        return;
     }
-    GC::gc->Lock->unlock();
+    GC::gc->Manage(this);
+}
+
+void Collectable::releaseIfUnused()
+{
+    if (this->HasSomeConsumers() || GC::gc == nullptr)
+        return;
+    if (this->setFlag(HUGGLE_COLLECTABLE_QUEUED))
+        GC::gc->Enqueue(this);
 }
 
 QString Collectable::DebugHgc()
@@ -202,21 +308,27 @@ QString Collectable::DebugHgc()
     if (this->HasSomeConsumers())
     {
         result += ("GC: Listing all dependencies for " + QString::number(this->CollectableID())) + "\n";
-        if (this->_collectableRefs > 0)
+        int references = this->refs.loadAcquire();
+        if (references > 0)
         {
-            result += QString::number(this->_collectableRefs) + " unknown references\n";
+            result += QString::number(references) + " unknown references\n";
         }
-        int Item=0;
-        while (Item < this->Consumers.count())
+        quint64 mask = this->consumers.loadAcquire();
+        int bit = 0;
+        while (bit < static_cast<int>(sizeof(maskConsumers) / sizeof(int)))
         {
-            result +=("GC: " + QString::number(this->CollectableID()) + " " + this->Consumers.at(Item)) + "\n";
-            Item++;
+            if (mask & (Q_UINT64_C(1) << bit))
+                result +=("GC: " + QString::number(this->CollectableID()) + " " + ConsumerIdToString(maskConsumers[bit])) + "\n";
+            bit++;
         }
-        Item=0;
-        while (Item < this->iConsumers.count())
+        if (mask & HUGGLE_COLLECTABLE_SIDE_BIT)
         {
-            result +=("GC: " + QString::number(this->CollectableID()) + " " + ConsumerIdToString( this->iConsumers.at(Item)) ) + "\n";
-            Item++;
+            QMutexLocker locker(&sideLock);
+            CollectableSideConsumers side = sideTable.value(this);
+            foreach (QString consumer, side.Strings)
+                result +=("GC: " + QString::number(this->CollectableID()) + " " + consumer) + "\n";
+            foreach (int consumer, side.Ints)
+                result +=("GC: " + QString::number(this->CollectableID()) + " " + ConsumerIdToString(consumer)) + "\n";
         }
     } else
     {
@@ -224,28 +336,3 @@ QString Collectable::DebugHgc()
     }
     return result;
 }
-
-void Collectable::Lock()
-{
-#ifdef HUGGLE_PROFILING
-    Collectable::LockCt++;
-#endif
-    // this is actually pretty lame check but better than nothing
-    if (!this->_collectableLocked)
-    {
-        this->_collectableQL->lock();
-        this->_collectableLocked = true;
-    }
-}
-
-void Collectable::Unlock()
-{
-#ifdef HUGGLE_PROFILING
-    Collectable::LockCt++;
-#endif
-    if (this->_collectableLocked)
-    {
-        this->_collectableQL->unlock();
-        this->_collectableLocked = false;
-    }
-}
@@ -17,12 +17,21 @@
 
 #include "definitions.hpp"
 
-#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicInteger>
 #include <QList>
 #include <QString>
 #include <QStringList>
 #include "gc.hpp"
 
+// flags of Collectable::state
+#define HUGGLE_COLLECTABLE_MANAGED          1
+#define HUGGLE_COLLECTABLE_RECLAIMABLE      2
+//! Object is in queue of GC or it's being deleted, so it must not be queued again
+#define HUGGLE_COLLECTABLE_QUEUED           4
+//! Bit of consumer mask which is set when object has consumers in side table
+#define HUGGLE_COLLECTABLE_SIDE_BIT         (Q_UINT64_C(1) << 63)
+
 namespace Huggle
 {
     //! Base for all items that are supposed to be collected by garbage collector
@@ -36,16 +45,21 @@ namespace Huggle
     //! can be only deleted by garbage collector when no consumers are using it. Basically every
     //! object that has 0 consumers, will be deleted.
 
+    //! Ownership state is kept in atomic integers, consumers with HUGGLECONSUMER_ id are bits of a mask and
+    //! only string consumers and unknown ids are stored in a side table, so that registering consumers and
+    //! references doesn't need any lock on hot paths.
+
     //! \image html ../documentation/gc01.png
     class HUGGLE_EX_CORE Collectable
     {
         public:
             /*!
              * \brief This function is useful when you need to create an extension that uses own collectables in GC
-             * \return pointer to last cid
+             * \return last cid that was assigned
              */
-            static unsigned long *GetLastCIDPtr();
+            static unsigned long GetLastCID();
 #ifdef HUGGLE_PROFILING
+            //! Number of times the side table of consumers was locked
             static unsigned long LockCt;
 #endif
 
@@ -66,17 +80,6 @@ namespace Huggle
             //! used by any other but atomic functions, because in theory collectable which lost its last consumer might
             //! be deleted by GC any time.
             void SetReclaimable();
-            //! Whether the object is locked (other threads can't register nor unregister consumers
-            //! neither it is possible to delete this object by any other thread)
-            bool IsLocked();
-            /*!
-             * \brief Lock this object so that other threads can't change consumers or modify its properties
-             */
-            void Lock();
-            /*!
-             * \brief Unlock this object for deletion by other threads
-             */
-            void Unlock();
             /*!
              * \brief Registers a consumer
              *
@@ -129,31 +132,31 @@ namespace Huggle
             unsigned long CollectableID();
             bool HasSomeConsumers();
         private:
+            friend class GC;
             static QString ConsumerIdToString(int id);
-            static QMutex *WideLock;
-            static unsigned long LastCID;
+            //! Returns bit of consumer in the mask, or -1 if it needs to be stored in side table
+            static int consumerBit(int consumer);
+            static QAtomicInteger<unsigned long> LastCID;
 
+            //! Sets a state flag and returns true if it wasn't set before
+            bool setFlag(int flag);
+            void clearFlag(int flag);
             void SetManaged();
+            //! Put the object to queue of GC if nothing is using it anymore and it isn't queued yet
+            void releaseIfUnused();
+            void checkReclaim();
             unsigned long CID;
-            //! Internal variable that contains a cache whether object is managed
-            bool _collectableManaged;
-            //! List of string consumers that are using this object
-
-            //! Every consumer needs to use unique string that identifies them
-            QStringList Consumers;
-            //! Changing to true will prevent an exception from being thrown if you register consumer after deleting last consumer
-
-            //! Doing so may result in unpredictable crashes, because object should never be accessed after last consumer was removed
-            bool ReclaimingAllowed;
-            //! List of int consumers that are using this object
-
-            //! Every consumer needs to use a unique int that identifies them
-            //! if you aren't sure what number to use, or if you are working
-            //! in extension you should use string instead
-            QList<int> iConsumers;
-            QMutex *_collectableQL;
-            unsigned int _collectableRefs;
-            bool _collectableLocked;
+            //! Bit for each int consumer that has a bit, the highest bit means that there are consumers in side table
+            QAtomicInteger<quint64> consumers;
+            QAtomicInt refs;
+            //! Combination of managed, reclaimable and queued flags
+            QAtomicInt state;
+            //! Neighbours in the list of managed objects of GC, protected by GC::Lock
+            Collectable *gcPrev;
+            Collectable *gcNext;
+            bool gcListed;
+            //! Next object in queue of objects that are ready to be freed
+            Collectable *gcReadyNext;
     };
 
     //_________________________________________________________________________
@@ -164,12 +167,12 @@ namespace Huggle
 
     inline bool Collectable::HasSomeConsumers()
     {
-        return (this->_collectableRefs > 0 || this->iConsumers.count() > 0 || this->Consumers.count() > 0);
+        return (this->refs.loadAcquire() > 0 || this->consumers.loadAcquire() != 0);
     }
 
     inline void Collectable::IncRef()
     {
-        this->_collectableRefs++;
+        this->refs.ref();
         this->SetManaged();
     }
 
@@ -178,23 +181,9 @@ namespace Huggle
         return this->CID;
     }
 
-    inline bool Collectable::IsLocked()
-    {
-        return this->_collectableLocked;
-    }
-
-    inline unsigned long *Collectable::GetLastCIDPtr()
-    {
-        return &Collectable::LastCID;
-    }
-
-    inline bool Collectable::IsManaged()
+    inline unsigned long Collectable::GetLastCID()
     {
-        if (this->_collectableManaged)
-        {
-            return true;
-        }
-        return this->HasSomeConsumers();
+        return Collectable::LastCID.loadAcquire();
     }
 }
 #endif // COLLECTABLE_H
@@ -265,9 +265,17 @@ void Configuration::LoadSystemConfig(const QString& fn)
         RCU(IRCPort);
         RC(IRCServer);
         RCN(ProviderCache);
+        RCN(ProviderOverflowPolicy);
+        RCN(ProcessorThreads);
         RCB(AskUserBeforeReport);
         RCN(HistorySize);
         RCN(RingLogMaxSize);
+        RCN(ScriptBudget);
+        RCN(ScriptBudgetOverruns);
+        RCB(ScriptBudgetDisable);
+        RCN(QueryCoalescingWindow);
+        RCN(QueriesPerSite);
+        RCN(ResponseCacheSize);
         RC(GlobalConfigYAML);
         RCB(DynamicColsInList);
         RCB(UnsafeExts);
@@ -384,11 +392,19 @@ void Configuration::SaveSystemConfig()
     INSERT_CONFIG(IRCServer);
     InsertConfig("Language", Localizations::HuggleLocalizations->PreferredLanguage, writer);
     INSERT_CONFIG_N(ProviderCache);
+    INSERT_CONFIG_N(ProviderOverflowPolicy);
+    INSERT_CONFIG_N(ProcessorThreads);
     INSERT_CONFIG_B(AskUserBeforeReport);
     INSERT_CONFIG_N(HistorySize);
     INSERT_CONFIG_B(QueueNewEditsUp);
     INSERT_CONFIG_B(BotPassword);
     INSERT_CONFIG_N(RingLogMaxSize);
+    INSERT_CONFIG_N(ScriptBudget);
+    INSERT_CONFIG_N(ScriptBudgetOverruns);
+    INSERT_CONFIG_B(ScriptBudgetDisable);
+    INSERT_CONFIG_N(QueryCoalescingWindow);
+    INSERT_CONFIG_N(QueriesPerSite);
+    INSERT_CONFIG_N(ResponseCacheSize);
     INSERT_CONFIG_B(TrimOldWarnings);
     INSERT_CONFIG_B(EnableUpdates);
     INSERT_CONFIG_B(NotifyBeta);
@@ -290,8 +290,23 @@ namespace Huggle
             bool            Fuzzy = false;
             //! Size of feed
             int             SystemConfig_ProviderCache = 200;
+            //! Number of threads that score edits, 0 means that it's picked based on number of CPU cores
+            int             SystemConfig_ProcessorThreads = 0;
+            //! What happens when feed is full, see HuggleFeedOverflowPolicy (0 drop oldest, 1 drop lowest score, 2 pause feed)
+            int             SystemConfig_ProviderOverflowPolicy = 0;
             //! Maximum size of ringlog
             int             SystemConfig_RingLogMaxSize = 2000;
+            //! Time in ms that one call of script function may take, longer calls are logged, 0 means there is no budget
+            int             SystemConfig_ScriptBudget = 200;
+            //! Number of overruns in a row after which the hook is disabled, if SystemConfig_ScriptBudgetDisable is true
+            int             SystemConfig_ScriptBudgetOverruns = 5;
+            bool            SystemConfig_ScriptBudgetDisable = false;
+            //! Time in ms for which result of read query is given to identical queries, 0 means only running queries are shared
+            int             SystemConfig_QueryCoalescingWindow = 3000;
+            //! Maximum number of requests that run at once for one wiki, other queries wait in QueryScheduler, 0 means there is no limit
+            int             SystemConfig_QueriesPerSite = 6;
+            //! Size limit of on-disk cache of api responses in megabytes, 0 disables the cache
+            int             SystemConfig_ResponseCacheSize = 100;
             //! Path where huggle contains its data, known as $huggle_home in manual
             QString         HomePath;
             //! If true Huggle will collect debug info from internal and external scoring feeds
@@ -465,6 +480,12 @@ namespace Huggle
             bool        NewMessage = false;
             QString     QueryDebugPath = "querydump.dat";
             bool        QueryDebugging = false;
+            //! File where raw lines received by irc and XmlRcs providers are recorded, empty if recording is disabled
+            QString     FeedRecordPath;
+            //! File that is replayed by replay provider instead of using live feed
+            QString     FeedReplayPath;
+            //! Speed of replay, 1 is real time, 0 is as fast as possible
+            double      FeedReplaySpeed = 1;
             QStringList   IgnoredExtensions;
             //! Operating system that is sent to update server
             QString     Platform;
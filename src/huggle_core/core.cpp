@@ -13,6 +13,7 @@
 #include <QFile>
 #include <QPluginLoader>
 #include <huggle_l10n/huggle_l10n.hpp>
+#include "apiquerybatch.hpp"
 #include "configuration.hpp"
 #include "exception.hpp"
 #include "exceptionhandler.hpp"
@@ -20,6 +21,7 @@
 #include "gc.hpp"
 #include "generic.hpp"
 #include "hugglefeed.hpp"
+#include "hugglefeedproviderreplay.hpp"
 #include "huggleprofiler.hpp"
 #include "hugglequeuefilter.hpp"
 #include "iextension.hpp"
@@ -29,8 +31,10 @@
 #include "resources.hpp"
 #include "query.hpp"
 #include "querypool.hpp"
+#include "responsecache.hpp"
 #include "scripting/script.hpp"
 #include "syslog.hpp"
+#include "userreputation.hpp"
 #include "wikiedit.hpp"
 #include "wikipage.hpp"
 #include "wikisite.hpp"
@@ -79,8 +83,6 @@ void Core::Init()
     Syslog::HuggleLogs->Log("Huggle version " + Configuration::HuggleConfiguration->HuggleVersion);
     Resources::Init();
     Syslog::HuggleLogs->Log("Loading configuration");
-    this->processorThread = new WikiEdit_ProcessorThread();
-    this->processorThread->start();
     this->LoadLocalizations();
     Huggle::Syslog::HuggleLogs->Log("Home: " + hcfg->HomePath);
     if (QFile::exists(Configuration::GetConfigurationPath() + HUGGLE_CONF))
@@ -90,10 +92,30 @@ void Core::Init()
     {
         Configuration::LoadSystemConfig(QCoreApplication::applicationDirPath() + HUGGLE_CONF);
     }
+    if (!UserReputation::Open(Configuration::GetConfigurationPath() + "reputation.db"))
+        Syslog::HuggleLogs->WarningLog("Unable to open user reputation store, users from previous sessions will not be known");
+    ResponseCache::Open(Configuration::GetConfigurationPath() + "cache", static_cast<qint64>(hcfg->SystemConfig_ResponseCacheSize) * 1024 * 1024);
+    this->processorPool = new WikiEdit_ProcessorPool(hcfg->SystemConfig_ProcessorThreads);
+    WikiEdit_ProcessorPool::Pool = this->processorPool;
+    this->processorPool->Start();
+    HUGGLE_DEBUG1("Scoring edits using " + QString::number(this->processorPool->GetWorkerCount()) + " threads");
     hcfg->WebRequest_UserAgent = QString("Huggle/" + QString(HUGGLE_VERSION) + " (http://en.wikipedia.org/wiki/WP:Huggle; " + hcfg->HuggleVersion + ")").toUtf8();
     HUGGLE_DEBUG1("UserAgent: " + QString(hcfg->WebRequest_UserAgent));
     // Create a global wiki, now that we loaded the configuration which is only place where it can be changed
     hcfg->GlobalWiki = new WikiSite("GlobalWiki", hcfg->SystemConfig_GlobalConfigurationWikiAddress);
+    if (!hcfg->FeedRecordPath.isEmpty())
+    {
+        HuggleFeedRecorder::Recorder = new HuggleFeedRecorder(hcfg->FeedRecordPath);
+        if (HuggleFeedRecorder::Recorder->Open())
+        {
+            Syslog::HuggleLogs->Log("Recording feed to " + hcfg->FeedRecordPath);
+        } else
+        {
+            Syslog::HuggleLogs->ErrorLog("Unable to open " + hcfg->FeedRecordPath + " for feed recording");
+            delete HuggleFeedRecorder::Recorder;
+            HuggleFeedRecorder::Recorder = nullptr;
+        }
+    }
     HUGGLE_PROFILER_PRINT_TIME("Core::Init()@conf");
     HUGGLE_DEBUG1("Loading wikis");
     this->LoadDB();
@@ -120,7 +142,7 @@ void Core::Init()
 
 Core::Core()
 {
-    this->processorThread = nullptr;
+    this->processorPool = nullptr;
     this->HuggleSyslog = nullptr;
     this->StartupTime = QDateTime::currentDateTime();
     this->Running = true;
@@ -130,7 +152,9 @@ Core::Core()
 Core::~Core()
 {
     delete this->gc;
-    delete this->processorThread;
+    if (WikiEdit_ProcessorPool::Pool == this->processorPool)
+        WikiEdit_ProcessorPool::Pool = nullptr;
+    delete this->processorPool;
     delete this->exceptionHandler;
 }
 
@@ -324,11 +348,16 @@ void Core::Shutdown()
         if (site->Provider && site->Provider->IsWorking())
             site->Provider->Stop();
     }
+    if (HuggleFeedRecorder::Recorder)
+    {
+        Syslog::HuggleLogs->Log("Recorded " + QString::number(HuggleFeedRecorder::Recorder->Lines) + " lines to " + HuggleFeedRecorder::Recorder->GetPath());
+        delete HuggleFeedRecorder::Recorder;
+        HuggleFeedRecorder::Recorder = nullptr;
+    }
     // Grace time for subthreads to finish
     Syslog::HuggleLogs->Log("SHUTDOWN: giving a gracetime to other threads to finish");
     Sleeper::msleep(200);
-    if (this->processorThread->isRunning())
-        this->processorThread->exit();
+    this->processorPool->Stop();
 
     // We need to make a copy of list here, because calling delete would remove the pointer from original list
     // that could cause some issues.
@@ -339,6 +368,10 @@ void Core::Shutdown()
         delete s;
     }
     QueryPool::HugglePool = nullptr;
+    ApiQueryBatch::DeleteAll();
+    WikiUser::StoreProblematicUsers();
+    UserReputation::Close();
+    ResponseCache::Close();
     Configuration::SaveSystemConfig();
     delete this->HGQP;
     this->HGQP = nullptr;
@@ -351,7 +384,7 @@ void Core::Shutdown()
     // Last garbage removal
     GC::gc->DeleteOld();
     this->WriteProfilerDataIntoSyslog();
-    Syslog::HuggleLogs->DebugLog("GC: " + QString::number(GC::gc->list.count()) + " objects");
+    Syslog::HuggleLogs->DebugLog("GC: " + QString::number(GC::gc->Count()) + " objects");
     delete GC::gc;
     HuggleQueueFilter::Delete();
     GC::gc = nullptr;
@@ -427,11 +460,13 @@ void Core::WriteProfilerDataIntoSyslog()
     Syslog::HuggleLogs->Log("Profiler data:");
     Syslog::HuggleLogs->Log("==========================");
     Syslog::HuggleLogs->Log("Locks " + QString::number(Collectable::LockCt));
-    foreach (Collectable *q, GC::gc->list)
+    GC::gc->Lock->lock();
+    foreach (Collectable *q, GC::gc->GetList())
     {
         // retrieve GC info
         Syslog::HuggleLogs->Log(q->DebugHgc());
     }
+    GC::gc->Lock->unlock();
     Syslog::HuggleLogs->Log("Function calls:");
     QStringList functions = Profiler::GetRegisteredCounterFunctions();
     foreach (QString fx, functions)
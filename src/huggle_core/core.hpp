@@ -22,7 +22,7 @@ namespace Huggle
     class Exception;
     class ExceptionHandler;
     class GC;
-    class WikiEdit_ProcessorThread;
+    class WikiEdit_ProcessorPool;
     class HuggleQueueFilter;
     class Syslog;
     class QueryPool;
@@ -95,7 +95,7 @@ namespace Huggle
             Huggle::GC *gc;
         private:
             //! This is a post-processor for edits
-            WikiEdit_ProcessorThread *processorThread;
+            WikiEdit_ProcessorPool *processorPool;
             ExceptionHandler *exceptionHandler;
             bool loaded = false;
     };
@@ -0,0 +1,167 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "diffextractor.hpp"
+
+using namespace Huggle;
+
+static bool isTag(const QStringRef &tag, const QString &name)
+{
+    return tag.startsWith(name) && (tag.length() == name.length() || tag.at(name.length()).isSpace());
+}
+
+static bool decodeEntity(const QString &entity, uint *code)
+{
+    bool ok = true;
+    if (entity == "lt")
+        *code = '<';
+    else if (entity == "gt")
+        *code = '>';
+    else if (entity == "amp")
+        *code = '&';
+    else if (entity == "quot")
+        *code = '"';
+    else if (entity == "apos")
+        *code = '\'';
+    else if (entity == "nbsp")
+        *code = ' ';
+    else if (entity.startsWith("#x") || entity.startsWith("#X"))
+        *code = entity.midRef(2).toUInt(&ok, 16);
+    else if (entity.startsWith("#"))
+        *code = entity.midRef(1).toUInt(&ok, 10);
+    else
+        return false;
+    return ok && *code > 0 && *code <= 0x10FFFF;
+}
+
+void DiffExtractor::AppendDecoded(QString *target, const QStringRef &text)
+{
+    const QChar *data = text.constData();
+    int length = text.length();
+    int plain_start = 0;
+    int i = 0;
+    while (i < length)
+    {
+        if (data[i] != '&')
+        {
+            ++i;
+            continue;
+        }
+        // entities we care about are short, so we don't need to look far for the semicolon
+        int semicolon = -1;
+        int j = i + 1;
+        while (j < length && j < i + 10)
+        {
+            if (data[j] == ';')
+            {
+                semicolon = j;
+                break;
+            }
+            ++j;
+        }
+        uint code;
+        if (semicolon < 0 || !decodeEntity(QString(data + i + 1, semicolon - i - 1), &code))
+        {
+            ++i;
+            continue;
+        }
+        target->append(data + plain_start, i - plain_start);
+        if (QChar::requiresSurrogates(code))
+            target->append(QString::fromUcs4(&code, 1));
+        else
+            target->append(QChar(static_cast<ushort>(code)));
+        i = semicolon + 1;
+        plain_start = i;
+    }
+    target->append(data + plain_start, length - plain_start);
+}
+
+QString DiffExtractor::ExtractAddedText(const QString &diff, bool *is_diff)
+{
+    QString result;
+    // text of current added cell and text of inserted segments in it, we don't know which one of them is
+    // going to be used until we reach end of the cell
+    QString cell_text;
+    QString inserted_text;
+    bool found_table = false;
+    bool in_added_cell = false;
+    bool cell_has_insertions = false;
+    int insertion_depth = 0;
+    int position = 0;
+    int length = diff.length();
+    while (position < length)
+    {
+        int tag_start = diff.indexOf('<', position);
+        if (tag_start < 0)
+            tag_start = length;
+        if (in_added_cell && tag_start > position)
+        {
+            QStringRef text = diff.midRef(position, tag_start - position);
+            DiffExtractor::AppendDecoded(&cell_text, text);
+            if (insertion_depth > 0)
+                DiffExtractor::AppendDecoded(&inserted_text, text);
+        }
+        if (tag_start == length)
+            break;
+        int tag_end = diff.indexOf('>', tag_start);
+        if (tag_end < 0)
+            break;
+        QStringRef tag = diff.midRef(tag_start + 1, tag_end - tag_start - 1);
+        position = tag_end + 1;
+        if (isTag(tag, "td"))
+        {
+            if (tag.contains("diff-"))
+                found_table = true;
+            in_added_cell = tag.contains("diff-addedline");
+            cell_has_insertions = false;
+            insertion_depth = 0;
+            cell_text.clear();
+            inserted_text.clear();
+        } else if (in_added_cell)
+        {
+            if (isTag(tag, "/td"))
+            {
+                // changed lines contain the old text as well, so only inserted segments are used from them
+                const QString &added = cell_has_insertions ? inserted_text : cell_text;
+                if (!added.isEmpty())
+                {
+                    if (!result.isEmpty())
+                        result += ' ';
+                    result += added;
+                }
+                in_added_cell = false;
+            } else if (isTag(tag, "ins") && tag.contains("diffchange"))
+            {
+                cell_has_insertions = true;
+                insertion_depth++;
+            } else if (isTag(tag, "/ins") && insertion_depth > 0)
+            {
+                insertion_depth--;
+                inserted_text += ' ';
+            }
+        }
+    }
+    if (in_added_cell)
+    {
+        // diff was cut in the middle of a cell
+        const QString &added = cell_has_insertions ? inserted_text : cell_text;
+        if (!added.isEmpty())
+        {
+            if (!result.isEmpty())
+                result += ' ';
+            result += added;
+        }
+    }
+    if (is_diff)
+        *is_diff = found_table;
+    if (!found_table)
+        return diff.toLower();
+    return result.toLower();
+}
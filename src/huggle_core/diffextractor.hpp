@@ -0,0 +1,43 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef DIFFEXTRACTOR_HPP
+#define DIFFEXTRACTOR_HPP
+
+#include "definitions.hpp"
+
+#include <QString>
+
+namespace Huggle
+{
+    /*!
+     * \brief Extracts text that was inserted by an edit from html diff returned by action=compare
+     *
+     * The diff table is walked only once. Lines that were added as a whole (diff-addedline cells) are taken
+     * completely, from lines that were changed only the inserted segments (ins diffchange-inline) are taken.
+     * Markup is removed, html entities are decoded and result is in lower case, so that it can be scored.
+     */
+    class HUGGLE_EX_CORE DiffExtractor
+    {
+        public:
+            /*!
+             * \brief Returns the added text from diff
+             * \param diff Html of diff table
+             * \param is_diff If not null it's set to false when the text doesn't contain any diff table cell, in that case
+             *        the whole text converted to lower case is returned
+             * \return Plain text of added content, separate lines and segments are separated by a space
+             */
+            static QString ExtractAddedText(const QString &diff, bool *is_diff = nullptr);
+            //! Decode html entities in text and append it to target
+            static void AppendDecoded(QString *target, const QStringRef &text);
+    };
+}
+
+#endif // DIFFEXTRACTOR_HPP
@@ -0,0 +1,221 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "editlatency.hpp"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+
+using namespace Huggle;
+
+// powers of two of microseconds up to 2^40 (about 12 days), everything longer goes to the last bucket
+#define HUGGLE_LATENCY_MAX_EXPONENT     40
+#define HUGGLE_LATENCY_BUCKETS          (8 + (HUGGLE_LATENCY_MAX_EXPONENT - 2) * 8)
+
+EditLatencyTrace::EditLatencyTrace()
+{
+    this->Clear();
+}
+
+void EditLatencyTrace::Mark(EditLatencyStage stage)
+{
+    this->times[stage] = EditLatency::Now();
+}
+
+void EditLatencyTrace::Clear()
+{
+    int stage = 0;
+    while (stage < EditLatencyStage_Count)
+        this->times[stage++] = -1;
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    this->buckets.fill(0, HUGGLE_LATENCY_BUCKETS);
+}
+
+int LatencyHistogram::bucketOf(qint64 microseconds)
+{
+    if (microseconds < 8)
+        return static_cast<int>(microseconds);
+    int exponent = 3;
+    while (exponent < HUGGLE_LATENCY_MAX_EXPONENT && (microseconds >> (exponent + 1)) > 0)
+        exponent++;
+    int sub = static_cast<int>(microseconds >> (exponent - 3)) - 8;
+    if (sub > 7)
+        sub = 7;
+    return 8 + (exponent - 3) * 8 + sub;
+}
+
+qint64 LatencyHistogram::bucketLowerBound(int bucket)
+{
+    if (bucket < 8)
+        return bucket;
+    int exponent = (bucket - 8) / 8 + 3;
+    qint64 sub = (bucket - 8) % 8;
+    return (8 + sub) << (exponent - 3);
+}
+
+void LatencyHistogram::Add(qint64 nanoseconds)
+{
+    if (nanoseconds < 0)
+        nanoseconds = 0;
+    this->buckets[bucketOf(nanoseconds / 1000)]++;
+    this->count++;
+    this->total += nanoseconds;
+    if (nanoseconds > this->max)
+        this->max = nanoseconds;
+}
+
+void LatencyHistogram::Clear()
+{
+    this->buckets.fill(0);
+    this->count = 0;
+    this->total = 0;
+    this->max = 0;
+}
+
+double LatencyHistogram::GetPercentile(double percentile) const
+{
+    if (this->count == 0)
+        return 0;
+    unsigned long long rank = static_cast<unsigned long long>(percentile / 100 * this->count + 0.5);
+    if (rank < 1)
+        rank = 1;
+    unsigned long long seen = 0;
+    int bucket = 0;
+    while (bucket < this->buckets.count() - 1)
+    {
+        seen += this->buckets.at(bucket);
+        if (seen >= rank)
+            break;
+        bucket++;
+    }
+    // middle of the bucket, but never more than longest value we have seen
+    double value = static_cast<double>(bucketLowerBound(bucket) + bucketLowerBound(bucket + 1)) / 2 / 1000;
+    return qMin(value, this->GetMax());
+}
+
+double LatencyHistogram::GetAverage() const
+{
+    if (this->count == 0)
+        return 0;
+    return static_cast<double>(this->total) / this->count / 1000000;
+}
+
+double LatencyHistogram::GetMax() const
+{
+    return static_cast<double>(this->max) / 1000000;
+}
+
+const EditLatency::Interval EditLatency::intervals[] =
+{
+    { EditLatencyStage_FeedReceived,       EditLatencyStage_PreProcessed,          "Pre processing" },
+    { EditLatencyStage_PreProcessed,       EditLatencyStage_PostProcessStarted,    "Provider cache" },
+    { EditLatencyStage_PostProcessStarted, EditLatencyStage_TalkPageRetrieved,     "Query: talk page" },
+    { EditLatencyStage_PostProcessStarted, EditLatencyStage_RevisionInfoRetrieved, "Query: revision info" },
+    { EditLatencyStage_PostProcessStarted, EditLatencyStage_DiffRetrieved,         "Query: diff" },
+    { EditLatencyStage_PostProcessStarted, EditLatencyStage_UserInfoRetrieved,     "Query: user info" },
+    { EditLatencyStage_PostProcessStarted, EditLatencyStage_CategoriesRetrieved,   "Query: categories" },
+    { EditLatencyStage_PostProcessStarted, EditLatencyStage_FounderRetrieved,      "Query: founder" },
+    { EditLatencyStage_PostProcessStarted, EditLatencyStage_TextRetrieved,         "Query: page text" },
+    { EditLatencyStage_PostProcessStarted, EditLatencyStage_QueriesFinished,       "All queries" },
+    { EditLatencyStage_QueriesFinished,    EditLatencyStage_ScoringStarted,        "Processor pool wait" },
+    { EditLatencyStage_ScoringStarted,     EditLatencyStage_Scored,                "Scoring" },
+    { EditLatencyStage_Scored,             EditLatencyStage_Finalized,             "Finalization" },
+    { EditLatencyStage_Finalized,          EditLatencyStage_RescoreStarted,        "Pending for rescore" },
+    { EditLatencyStage_RescoreStarted,     EditLatencyStage_Rescored,              "JS rescore" },
+    { EditLatencyStage_Rescored,           EditLatencyStage_Queued,                "Queue insertion" },
+    { EditLatencyStage_FeedReceived,       EditLatencyStage_Queued,                "Total" }
+};
+
+QVector<LatencyHistogram> EditLatency::histograms(sizeof(EditLatency::intervals) / sizeof(EditLatency::Interval));
+QMutex EditLatency::lock;
+
+qint64 EditLatency::Now()
+{
+    static QElapsedTimer clock;
+    // initialization of local static is thread safe, so the clock is started exactly once
+    static bool started = (clock.start(), true);
+    Q_UNUSED(started);
+    return clock.nsecsElapsed();
+}
+
+void EditLatency::Record(const EditLatencyTrace &trace)
+{
+    QMutexLocker locker(&lock);
+    int interval = 0;
+    while (interval < histograms.count())
+    {
+        const Interval &i = intervals[interval];
+        if (trace.Contains(i.From) && trace.Contains(i.To))
+            histograms[interval].Add(trace.Get(i.To) - trace.Get(i.From));
+        interval++;
+    }
+}
+
+void EditLatency::Reset()
+{
+    QMutexLocker locker(&lock);
+    int interval = 0;
+    while (interval < histograms.count())
+        histograms[interval++].Clear();
+}
+
+int EditLatency::GetIntervalCount()
+{
+    return histograms.count();
+}
+
+QString EditLatency::GetIntervalName(int interval)
+{
+    if (interval < 0 || interval >= histograms.count())
+        return "";
+    return QString(intervals[interval].Name);
+}
+
+LatencyHistogram EditLatency::GetHistogram(int interval)
+{
+    QMutexLocker locker(&lock);
+    if (interval < 0 || interval >= histograms.count())
+        return LatencyHistogram();
+    return histograms.at(interval);
+}
+
+QString EditLatency::ToString()
+{
+    QString result = QString("%1 %2 %3 %4 %5 %6 %7\n").arg("Interval", -24).arg("Count", 10).arg("Avg ms", 12).arg("p50 ms", 12)
+                                                       .arg("p95 ms", 12).arg("p99 ms", 12).arg("Max ms", 12);
+    int interval = 0;
+    while (interval < GetIntervalCount())
+    {
+        LatencyHistogram histogram = GetHistogram(interval);
+        result += QString("%1 %2 %3 %4 %5 %6 %7\n").arg(GetIntervalName(interval), -24)
+                                                   .arg(histogram.GetCount(), 10)
+                                                   .arg(histogram.GetAverage(), 12, 'f', 2)
+                                                   .arg(histogram.GetPercentile(50), 12, 'f', 2)
+                                                   .arg(histogram.GetPercentile(95), 12, 'f', 2)
+                                                   .arg(histogram.GetPercentile(99), 12, 'f', 2)
+                                                   .arg(histogram.GetMax(), 12, 'f', 2);
+        interval++;
+    }
+    return result;
+}
+
+bool EditLatency::Dump(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    QString text = "Huggle edit latency statistics, " + QDateTime::currentDateTime().toString(Qt::ISODate) + "\n\n" + ToString();
+    file.write(text.toUtf8());
+    file.close();
+    return true;
+}
@@ -0,0 +1,124 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef EDITLATENCY_HPP
+#define EDITLATENCY_HPP
+
+#include "definitions.hpp"
+
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+namespace Huggle
+{
+    //! Points in the pipeline that every edit passes through, from receipt by feed provider to insertion into queue
+    enum EditLatencyStage
+    {
+        EditLatencyStage_FeedReceived,
+        EditLatencyStage_PreProcessed,
+        EditLatencyStage_PostProcessStarted,
+        EditLatencyStage_TalkPageRetrieved,
+        EditLatencyStage_RevisionInfoRetrieved,
+        EditLatencyStage_DiffRetrieved,
+        EditLatencyStage_UserInfoRetrieved,
+        EditLatencyStage_CategoriesRetrieved,
+        EditLatencyStage_FounderRetrieved,
+        EditLatencyStage_TextRetrieved,
+        EditLatencyStage_QueriesFinished,
+        EditLatencyStage_ScoringStarted,
+        EditLatencyStage_Scored,
+        EditLatencyStage_Finalized,
+        EditLatencyStage_RescoreStarted,
+        EditLatencyStage_Rescored,
+        EditLatencyStage_Queued,
+        EditLatencyStage_Count
+    };
+
+    //! Monotonic timestamps of stages that one edit reached
+    class HUGGLE_EX_CORE EditLatencyTrace
+    {
+        public:
+            EditLatencyTrace();
+            //! Remember current time for a stage, time of stage that was already reached is overwritten
+            void Mark(EditLatencyStage stage);
+            void Clear();
+            //! Returns time in ns as returned by EditLatency::Now() or -1 if edit didn't reach this stage
+            qint64 Get(EditLatencyStage stage) const { return this->times[stage]; }
+            bool Contains(EditLatencyStage stage) const { return this->times[stage] >= 0; }
+        private:
+            qint64 times[EditLatencyStage_Count];
+    };
+
+    /*!
+     * \brief Histogram of latencies with logarithmic buckets
+     *
+     * Each power of two of microseconds is split into 8 buckets, so that percentiles are accurate to about 6%
+     * while the histogram takes constant memory, no matter how many values were added.
+     */
+    class HUGGLE_EX_CORE LatencyHistogram
+    {
+        public:
+            LatencyHistogram();
+            void Add(qint64 nanoseconds);
+            void Clear();
+            unsigned long long GetCount() const { return this->count; }
+            //! Returns value in ms below which given percentage of all values are
+            double GetPercentile(double percentile) const;
+            //! Average in ms
+            double GetAverage() const;
+            //! Maximum in ms
+            double GetMax() const;
+        private:
+            static int bucketOf(qint64 microseconds);
+            static qint64 bucketLowerBound(int bucket);
+            QVector<unsigned long long> buckets;
+            unsigned long long count = 0;
+            qint64 total = 0;
+            qint64 max = 0;
+    };
+
+    /*!
+     * \brief Latency statistics of edit pipeline
+     *
+     * Every edit that gets to queue records the time it spent between stages of the pipeline, so that we can see
+     * whether edits are waiting in provider cache, for queries, for processor threads or for the main timer.
+     * Completion of queries is noticed by the main timer, so these intervals include time until next tick.
+     */
+    class HUGGLE_EX_CORE EditLatency
+    {
+        public:
+            //! Monotonic time in ns, all traces are using this clock
+            static qint64 Now();
+            //! Add all intervals of trace to histograms, intervals which edit didn't pass through are skipped
+            static void Record(const EditLatencyTrace &trace);
+            static void Reset();
+            static int GetIntervalCount();
+            static QString GetIntervalName(int interval);
+            //! Returns copy of histogram of interval, so that it can be read while other edits are recorded
+            static LatencyHistogram GetHistogram(int interval);
+            //! Table with percentiles of all intervals
+            static QString ToString();
+            //! Write the table to a file, returns false if it can't be written
+            static bool Dump(const QString &path);
+        private:
+            struct Interval
+            {
+                EditLatencyStage From;
+                EditLatencyStage To;
+                const char *Name;
+            };
+            static const Interval intervals[];
+            static QVector<LatencyHistogram> histograms;
+            static QMutex lock;
+    };
+}
+
+#endif // EDITLATENCY_HPP
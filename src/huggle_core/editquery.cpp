@@ -52,7 +52,7 @@ void EditQuery::Kill()
     this->qRetrieve.Delete();
     this->hasPreviousPageText = false;
     this->originalText = "";
-    this->status = StatusKilled;
+    this->SetStatus(StatusKilled);
 }
 
 void EditQuery::Process()
@@ -74,7 +74,7 @@ void EditQuery::Process()
         throw new Huggle::NullPointerException("local Page", BOOST_CURRENT_FUNCTION);
     }
 
-    this->status = StatusProcessing;
+    this->SetStatus(StatusProcessing);
     this->StartTime = QDateTime::currentDateTime();
     if (this->Page->GetSite()->GetProjectConfig()->Token_Csrf.isEmpty())
     {
@@ -264,5 +264,5 @@ void EditQuery::setError(const QString& reason)
     this->Result = new QueryResult(true);
     this->Result->SetError(reason);
     this->failureReason = reason;
-    this->status = StatusInError;
+    this->SetStatus(StatusInError);
 }
@@ -0,0 +1,157 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "editregistry.hpp"
+#include <QMutexLocker>
+#include "wikiedit.hpp"
+#include "wikipage.hpp"
+#include "wikiuser.hpp"
+
+using namespace Huggle;
+
+QMutex EditRegistry::lock;
+QHash<WikiEdit*, EditRegistry::Entry> EditRegistry::edits;
+QHash<revid_ht, QList<WikiEdit*>> EditRegistry::byRevID;
+QHash<EditRegistry::PageKey, QList<WikiEdit*>> EditRegistry::byPage;
+QHash<EditRegistry::PageKey, revid_ht> EditRegistry::latestRevert;
+
+void EditRegistry::Insert(WikiEdit *edit)
+{
+    QMutexLocker locker(&lock);
+    edits.insert(edit, Entry());
+}
+
+void EditRegistry::Remove(WikiEdit *edit)
+{
+    QMutexLocker locker(&lock);
+    QHash<WikiEdit*, Entry>::iterator entry = edits.find(edit);
+    if (entry == edits.end())
+        return;
+    unindex(edit, entry.value());
+    edits.erase(entry);
+}
+
+void EditRegistry::unindex(WikiEdit *edit, Entry &entry)
+{
+    if (!entry.Indexed)
+        return;
+    entry.Indexed = false;
+    if (entry.RevID != WIKI_UNKNOWN_REVID)
+    {
+        QList<WikiEdit*> &same_revid = byRevID[entry.RevID];
+        same_revid.removeOne(edit);
+        if (same_revid.isEmpty())
+            byRevID.remove(entry.RevID);
+    }
+    QList<WikiEdit*> &same_page = byPage[entry.Page];
+    same_page.removeOne(edit);
+    if (same_page.isEmpty())
+    {
+        // nothing of this page is in memory anymore, so nobody can ask about its reverts
+        byPage.remove(entry.Page);
+        latestRevert.remove(entry.Page);
+    }
+}
+
+EditRegistry::PageKey EditRegistry::pageOf(WikiEdit *edit)
+{
+    QHash<WikiEdit*, Entry>::const_iterator entry = edits.constFind(edit);
+    if (entry != edits.constEnd() && entry.value().Indexed)
+        return entry.value().Page;
+    return PageKey(edit->Page->Site, edit->Page->SanitizedName());
+}
+
+void EditRegistry::Update(WikiEdit *edit)
+{
+    if (edit->Page == nullptr)
+        return;
+    QMutexLocker locker(&lock);
+    QHash<WikiEdit*, Entry>::iterator it = edits.find(edit);
+    if (it == edits.end())
+        return;
+    Entry &entry = it.value();
+    unindex(edit, entry);
+    entry.RevID = edit->RevID;
+    // sanitized name is computed only once here, instead of every comparison
+    entry.Page = PageKey(edit->Page->Site, edit->Page->SanitizedName());
+    entry.Indexed = true;
+    if (entry.RevID != WIKI_UNKNOWN_REVID)
+        byRevID[entry.RevID].append(edit);
+    byPage[entry.Page].append(edit);
+    if (edit->IsRevert && edit->IsPostProcessed() && entry.RevID != WIKI_UNKNOWN_REVID)
+    {
+        QHash<PageKey, revid_ht>::iterator revert = latestRevert.find(entry.Page);
+        if (revert == latestRevert.end())
+            latestRevert.insert(entry.Page, entry.RevID);
+        else if (revert.value() < entry.RevID)
+            revert.value() = entry.RevID;
+    }
+}
+
+int EditRegistry::Count()
+{
+    QMutexLocker locker(&lock);
+    return edits.count();
+}
+
+Collectable_SmartPtr<WikiEdit> EditRegistry::FindByRevID(revid_ht revid, WikiSite *site, const QString &diff_to, bool post_processed_only)
+{
+    Collectable_SmartPtr<WikiEdit> result;
+    if (revid == WIKI_UNKNOWN_REVID)
+        return result;
+    QMutexLocker locker(&lock);
+    QHash<revid_ht, QList<WikiEdit*>>::const_iterator same_revid = byRevID.constFind(revid);
+    if (same_revid == byRevID.constEnd())
+        return result;
+    foreach (WikiEdit *edit, same_revid.value())
+    {
+        if (site != nullptr && edits.value(edit).Page.first != site)
+            continue;
+        if (!diff_to.isEmpty() && edit->DiffTo != diff_to)
+            continue;
+        if (post_processed_only && !edit->IsPostProcessed())
+            continue;
+        result = edit;
+        break;
+    }
+    return result;
+}
+
+bool EditRegistry::IsReverted(WikiEdit *edit)
+{
+    if (edit->Page == nullptr)
+        return false;
+    QMutexLocker locker(&lock);
+    QHash<PageKey, revid_ht>::const_iterator revert = latestRevert.constFind(pageOf(edit));
+    if (revert == latestRevert.constEnd())
+        return false;
+    // revert with same revision id is the edit itself
+    return revert.value() > edit->RevID || (revert.value() == edit->RevID && !edit->IsRevert);
+}
+
+bool EditRegistry::HasNewerEdits(WikiEdit *edit, bool *made_by_same_user)
+{
+    bool found = false;
+    if (edit->Page == nullptr)
+        return false;
+    QMutexLocker locker(&lock);
+    foreach (WikiEdit *other, byPage.value(pageOf(edit)))
+    {
+        if (other == edit || !other->IsPostProcessed())
+            continue;
+        if (other->Time > edit->Time)
+        {
+            if (!other->User->EqualTo(edit->User))
+                *made_by_same_user = false;
+            found = true;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,80 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef EDITREGISTRY_HPP
+#define EDITREGISTRY_HPP
+
+#include "definitions.hpp"
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include "collectable_smartptr.hpp"
+
+namespace Huggle
+{
+    class WikiEdit;
+    class WikiSite;
+
+    /*!
+     * \brief Registry of all WikiEdit objects that exist in memory
+     *
+     * Edits are indexed by revision id and by page, so that looking up an edit or all edits made to a page doesn't
+     * need to walk through all edits. Every edit is inserted when it's created, but it's indexed only when Update()
+     * is called, which happens when it's pre processed and when it's post processed, because revision id and page
+     * are usually not known before. For each page the revision id of latest revert that was post processed is
+     * remembered, as long as there is some edit of that page in memory.
+     */
+    class HUGGLE_EX_CORE EditRegistry
+    {
+        public:
+            static void Insert(WikiEdit *edit);
+            static void Remove(WikiEdit *edit);
+            //! Index the edit again using its current site, revision id, page and revert status
+            static void Update(WikiEdit *edit);
+            //! Number of edits in memory
+            static int Count();
+            /*!
+             * \brief Find edit by revision id
+             * \param site Site of edit, if null edit of any site matches
+             * \param diff_to If not empty, DiffTo of edit must be same
+             * \param post_processed_only Only return edits that are post processed
+             */
+            static Collectable_SmartPtr<WikiEdit> FindByRevID(revid_ht revid, WikiSite *site = nullptr, const QString &diff_to = "",
+                                                              bool post_processed_only = false);
+            //! Returns true if there is a post processed revert of the same page that is not older than the edit
+            static bool IsReverted(WikiEdit *edit);
+            /*!
+             * \brief Returns true if there is a post processed edit of the same page which is newer than the edit
+             * \param made_by_same_user Set to false if some of the newer edits were made by other user
+             */
+            static bool HasNewerEdits(WikiEdit *edit, bool *made_by_same_user);
+        private:
+            typedef QPair<WikiSite*, QString> PageKey;
+            struct Entry
+            {
+                bool Indexed = false;
+                revid_ht RevID = WIKI_UNKNOWN_REVID;
+                PageKey Page;
+            };
+            static void unindex(WikiEdit *edit, Entry &entry);
+            //! Key of page of edit, the one it's indexed with if it's indexed already
+            static PageKey pageOf(WikiEdit *edit);
+            static QMutex lock;
+            static QHash<WikiEdit*, Entry> edits;
+            static QHash<revid_ht, QList<WikiEdit*>> byRevID;
+            static QHash<PageKey, QList<WikiEdit*>> byPage;
+            static QHash<PageKey, revid_ht> latestRevert;
+    };
+}
+
+#endif // EDITREGISTRY_HPP
@@ -17,6 +17,7 @@
 #include "gc_thread.hpp"
 #include "exception.hpp"
 #include <QMutex>
+#include <QMutexLocker>
 
 using namespace Huggle;
 
@@ -42,71 +43,96 @@ Huggle::GC::~GC()
 
 void Huggle::GC::DeleteOld()
 {
-    this->Lock->lock();
-    int x=0;
-    if (this->list.count() > GC_LIMIT)
+    // objects that are deleted can release other objects, so we keep going until there is nothing left
+    while (this->deleteReady());
+}
+
+bool GC::deleteReady()
+{
+    // take the whole stack at once, that way other threads can keep pushing to it and there is no ABA problem
+    Collectable *object = this->ready.fetchAndStoreAcquire(nullptr);
+    if (object == nullptr)
+        return false;
+    while (object != nullptr)
     {
-        QList<Collectable*> copy(this->list);
-        this->Lock->unlock();
-        while(x < copy.count())
+        Collectable *next = object->gcReadyNext;
+        object->gcReadyNext = nullptr;
+        if (object->HasSomeConsumers())
+        {
+            // object was reclaimed after it was queued, it will be queued again when it loses its consumers
+            object->clearFlag(HUGGLE_COLLECTABLE_QUEUED);
+            // the consumers might have been removed before we reset the flag, in which case nobody queued it
+            object->releaseIfUnused();
+        } else
         {
-            Collectable *q = copy.at(x);
-            if (q->HasSomeConsumers())
-            {
-                // there is no need to work with this collectable item
-                x++;
-                continue;
-            }
-            q->Lock();
-            if (!q->IsManaged())
-            {
-                copy.removeAt(x);
-                // this is very unlikely to happen, so despite this
-                // is rather slow, it needs to be done
-                this->Lock->lock();
-                this->list.removeAll(q);
-                this->Lock->unlock();
-                delete q;
-                continue;
-            }
-            if (!q->SafeDelete())
-            {
-                q->Unlock();
-                x++;
-            } else
-            {
-                // we can remove it now because it's deleted
-                // don't delete this item from this->list
-                // it will happen automatically in
-                // Collectable->SafeDelete()
-                copy.removeAt(x);
-            }
+            this->Release(object);
+            object->clearFlag(HUGGLE_COLLECTABLE_MANAGED);
+            delete object;
         }
-        return;
+        object = next;
     }
-    while(x < this->list.count())
+    return true;
+}
+
+int GC::Count()
+{
+    QMutexLocker locker(this->Lock);
+    return this->count;
+}
+
+QList<Collectable*> GC::GetList()
+{
+    QList<Collectable*> list;
+    QMutexLocker locker(this->Lock);
+    list.reserve(this->count);
+    Collectable *object = this->first;
+    while (object != nullptr)
     {
-        Collectable *q = this->list.at(x);
-        if (q->HasSomeConsumers())
-        {
-            // there is no need to work with this collectable item
-            x++;
-            continue;
-        }
-        q->Lock();
-        if (!q->IsManaged())
-        {
-            this->list.removeAt(x);
-            delete q;
-            continue;
-        }
-        if (!q->SafeDelete())
-        {
-            q->Unlock();
-            x++;
-        }
+        list.append(object);
+        object = object->gcNext;
     }
-    this->Lock->unlock();
+    return list;
+}
+
+void GC::Manage(Collectable *object)
+{
+    QMutexLocker locker(this->Lock);
+    if (object->gcListed)
+        return;
+    object->gcPrev = nullptr;
+    object->gcNext = this->first;
+    if (this->first != nullptr)
+        this->first->gcPrev = object;
+    this->first = object;
+    object->gcListed = true;
+    this->count++;
+}
+
+void GC::Release(Collectable *object)
+{
+    QMutexLocker locker(this->Lock);
+    if (!object->gcListed)
+        return;
+    if (object->gcPrev != nullptr)
+        object->gcPrev->gcNext = object->gcNext;
+    else
+        this->first = object->gcNext;
+    if (object->gcNext != nullptr)
+        object->gcNext->gcPrev = object->gcPrev;
+    object->gcPrev = nullptr;
+    object->gcNext = nullptr;
+    object->gcListed = false;
+    this->count--;
+}
+
+void GC::Enqueue(Collectable *object)
+{
+    Collectable *top;
+    do
+    {
+        top = this->ready.loadAcquire();
+        object->gcReadyNext = top;
+    } while (!this->ready.testAndSetRelease(top, object));
 }
 
 void GC::Start()
@@ -17,6 +17,7 @@
 
 #include "definitions.hpp"
 
+#include <QAtomicPointer>
 #include <QList>
 
 class QMutex;
@@ -42,12 +43,12 @@ class QMutex;
 #define HUGGLECONSUMER_CALLBACK                 20
 #define HUGGLECONSUMER_PYTHON                   60
 #define HUGGLECONSUMER_JS_POOL                  100
+#define HUGGLECONSUMER_JS_CACHE                 101
 #define HUGGLECONSUMER_CORE                     800
 
 // some macros so that people hate us
 #define GC_DECREF(collectable) if (collectable) collectable->DecRef(); collectable=nullptr
 #define GC_DECNAMEDREF(collectable, consumer) if(collectable) collectable->UnregisterConsumer(consumer); collectable=nullptr
-#define GC_LIMIT 60
 
 namespace Huggle
 {
@@ -58,6 +59,11 @@ namespace Huggle
 
     //! Every object must be derived from Collectable, otherwise it
     //! must not be handled by garbage collector
+
+    //! Collectables put themselves to a queue of objects that are ready to be freed at the moment when they lose
+    //! their last consumer or reference, so the collector never needs to walk through all managed objects, it only
+    //! deletes these from the queue. Managed objects are kept in an intrusive list, so that adding or removing them
+    //! is constant no matter how many of them there are.
     class HUGGLE_EX_CORE GC
     {
         public:
@@ -71,20 +77,39 @@ namespace Huggle
 
             GC();
             ~GC();
-            //! Function that walks through the list and delete these that can be deleted
+            //! Delete all objects from the queue of objects that are ready to be freed, unless they were reclaimed meanwhile
             void DeleteOld();
             void Start();
             void Stop();
             bool IsRunning();
-            //! List of all managed queries that qgc keeps track of
-            QList<Collectable*> list;
-            //! QMutex that is used to lock the GC::list object
+            //! Number of managed objects
+            int Count();
+            /*!
+             * \brief Returns all managed objects
+             *
+             * Objects can be deleted by other thread any time, so Lock must be held for as long as the pointers are used
+             */
+            QList<Collectable*> GetList();
+            //! Insert object to list of managed objects, this is called by Collectable when it becomes managed
+            void Manage(Collectable *object);
+            //! Remove object from list of managed objects, this is called by Collectable right before it's deleted
+            void Release(Collectable *object);
+            //! Put object to queue of objects that are ready to be freed, this is thread safe and lock free
+            void Enqueue(Collectable *object);
+            //! QMutex that is used to lock the list of managed objects
 
             //! This lock needs to be aquired every time when you need to access this list
             //! from any thread during runtime
             QMutex * Lock;
         private:
+            //! Deletes the objects from one batch taken from the queue, returns false if there were none
+            bool deleteReady();
             GC_t *gc_t;
+            //! First object of intrusive list of managed objects
+            Collectable *first = nullptr;
+            int count = 0;
+            //! Top of lock free stack of objects that are ready to be freed, linked through Collectable::gcReadyNext
+            QAtomicPointer<Collectable> ready;
     };
 }
 
@@ -9,6 +9,7 @@
 //GNU General Public License for more details.
 
 #include "hooks.hpp"
+#include <QMutex>
 #include "core.hpp"
 #include "configuration.hpp"
 #include "events.hpp"
@@ -26,6 +27,9 @@ bool Huggle::Hooks::EditBeforeScore(Huggle::WikiEdit *edit)
     if (edit == nullptr)
         throw new Huggle::NullPointerException("Huggle::WikiEdit *Edit", BOOST_CURRENT_FUNCTION);
 
+    // this is called by all scoring threads, but extensions expect to be called by one thread at a time
+    static QMutex extensions_lock;
+    QMutexLocker locker(&extensions_lock);
     bool result = true;
     foreach (Huggle::iExtension *extension, Huggle::Core::HuggleCore->Extensions)
     {
@@ -188,11 +192,25 @@ bool Huggle::Hooks::EditCheckIfReady(Huggle::WikiEdit *edit)
 
 void Huggle::Hooks::WikiEdit_ScoreJS(Huggle::WikiEdit *edit)
 {
+    QList<WikiEdit*> edits;
+    edits.append(edit);
+    WikiEdit_ScoreJS(edits);
+}
+
+void Huggle::Hooks::WikiEdit_ScoreJS(const QList<WikiEdit*> &edits)
+{
+    if (edits.isEmpty())
+        return;
     foreach (Script *s, Script::GetScripts())
     {
-        if (s->IsWorking())
+        if (!s->IsWorking())
+            continue;
+        QList<int> scores = s->Hook_EditRescoreBatch(edits);
+        int i = 0;
+        while (i < edits.count())
         {
-            int score = s->Hook_EditRescore(edit);
+            WikiEdit *edit = edits.at(i);
+            int score = scores.at(i++);
             if (!score)
                 continue;
             edit->Score += static_cast<long>(score);
@@ -381,11 +399,17 @@ void Huggle::Hooks::WikiEdit_OnNewHistoryItem(Huggle::HistoryItem *history_item)
 
 void Huggle::Hooks::QueryPool_Remove(Huggle::Query *q)
 {
+    if (!Events::Global)
+        return;
+
     Events::Global->on_QueryPoolRemove(q);
 }
 
 void Huggle::Hooks::QueryPool_Update(Huggle::Query *q)
 {
+    if (!Events::Global)
+        return;
+
     Events::Global->on_QueryPoolUpdate(q);
 }
 
@@ -14,6 +14,7 @@
 #include "definitions.hpp"
 
 #include <QHash>
+#include <QList>
 #include <QString>
 
 namespace Huggle
@@ -71,6 +72,8 @@ namespace Huggle
             static bool EditCheckIfReady(WikiEdit *edit);
             //! This exists for JS to allow scoring of edit by user, called after post processing from main thread
             static void WikiEdit_ScoreJS(WikiEdit *edit);
+            //! Score all edits that finished post processing in one call of every script, see Script::Hook_EditRescoreBatch
+            static void WikiEdit_ScoreJS(const QList<WikiEdit*> &edits);
             static bool RevertPreflight(WikiEdit *edit);
             /*!
              * \brief Event that happens when user attempt to send a warning to editor of page
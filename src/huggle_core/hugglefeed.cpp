@@ -11,7 +11,13 @@
 #include "configuration.hpp"
 #include "hugglefeed.hpp"
 #include "exception.hpp"
+#include "hooks.hpp"
+#include "hugglequeuefilter.hpp"
+#include "querypool.hpp"
+#include "syslog.hpp"
+#include "wikiedit.hpp"
 #include "wikisite.hpp"
+#include <QThread>
 
 using namespace Huggle;
 
@@ -84,6 +90,7 @@ HuggleFeed::HuggleFeed(WikiSite *site) : MediaWikiObject(site)
     this->editCounter = 0;
     this->rvCounter = 0;
     this->startupTime = QDateTime::currentDateTime();
+    this->editBuffer = new HuggleFeedBuffer(hcfg->SystemConfig_ProviderCache);
     providerList.append(this);
 }
 
@@ -99,6 +106,7 @@ HuggleFeed::~HuggleFeed()
     if (providerList.contains(this))
         providerList.removeOne(this);
     delete this->statisticsMutex;
+    delete this->editBuffer;
 }
 
 QString HuggleFeed::GetError()
@@ -142,6 +150,101 @@ double HuggleFeed::GetEditsPerMinute()
     return edits / uptime;
 }
 
+unsigned long long HuggleFeed::GetDroppedEdits()
+{
+    return this->editBuffer->Dropped;
+}
+
+double HuggleFeed::GetDroppedPerMinute()
+{
+    this->rotateStats();
+    if (this->statisticsBlocks.count() < 1)
+        throw new Huggle::Exception("Invalid number of statistics blocks", BOOST_CURRENT_FUNCTION);
+    double uptime = static_cast<double>(this->statisticsBlocks.at(0)->Uptime.secsTo(QDateTime::currentDateTime())) / 60;
+    if (uptime < 0.01)
+        return 0;
+    this->statisticsMutex->lock();
+    double dropped = 0;
+    foreach (StatisticsBlock *ptr, this->statisticsBlocks)
+        dropped += ptr->Dropped;
+    this->statisticsMutex->unlock();
+    return dropped / uptime;
+}
+
+bool HuggleFeed::ContainsEdit()
+{
+    return !this->editBuffer->IsEmpty();
+}
+
+WikiEdit *HuggleFeed::RetrieveEdit()
+{
+    WikiEdit *edit = this->editBuffer->Pop();
+    // if feed was paused because the buffer was full we resume it once there is enough space again
+    if (this->pausedByBuffer && this->editBuffer->Count() <= this->editBuffer->GetCapacity() / 2)
+    {
+        this->pausedByBuffer = false;
+        if (!this->pausedByUser)
+            this->Resume();
+    }
+    return edit;
+}
+
+void HuggleFeed::PauseByUser()
+{
+    this->pausedByUser = true;
+    this->Pause();
+}
+
+void HuggleFeed::ResumeByUser()
+{
+    this->pausedByUser = false;
+    if (!this->pausedByBuffer)
+        this->Resume();
+}
+
+void HuggleFeed::InsertEdit(WikiEdit *edit)
+{
+    if (edit == nullptr)
+        throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
+
+    edit->Latency.Mark(EditLatencyStage_FeedReceived);
+    // Increase the number of edits that were made since provider is up, this is used for statistics
+    this->IncrementEdits();
+    // We need to pre process edit so that we have all its properties ready for queue filter
+    QueryPool::HugglePool->PreProcessEdit(edit);
+    // We only insert it to buffer in case that current filter matches the edit, this is probably not needed
+    // but it might be a performance improvement at some point
+    if (!edit->GetSite()->CurrentFilter->Matches(edit) || !Hooks::EditBeforePreProcess(edit))
+    {
+        edit->DecRef();
+        return;
+    }
+    HuggleFeedOverflowPolicy policy = static_cast<HuggleFeedOverflowPolicy>(hcfg->SystemConfig_ProviderOverflowPolicy);
+    score_ht score = 0;
+    if (policy == HuggleFeedOverflowPolicy_DropLowestScore)
+        score = edit->GetPreliminaryScore();
+    unsigned long long dropped = this->editBuffer->Dropped;
+    if (!this->editBuffer->Push(edit, policy, score))
+        edit->DecRef();
+    if (this->editBuffer->Dropped == dropped)
+    {
+        this->overflowReported = false;
+        return;
+    }
+    this->getLatestStatisticsBlock()->Dropped += static_cast<double>(this->editBuffer->Dropped - dropped);
+    // This warning isn't useful if the provider is not running
+    if (!this->overflowReported && !this->IsPaused())
+    {
+        Huggle::Syslog::HuggleLogs->WarningLog("insufficient space in " + this->ToString() + " cache, increase ProviderCache size, otherwise you will be losing edits");
+        this->overflowReported = true;
+    }
+    if (policy == HuggleFeedOverflowPolicy_PauseFeed && !this->IsPaused())
+    {
+        this->pausedByBuffer = true;
+        this->Pause();
+    }
+}
+
 void HuggleFeed::IncrementEdits()
 {
     if (!this->IsWorking())
@@ -202,4 +305,107 @@ StatisticsBlock::StatisticsBlock()
     this->Uptime = QDateTime::currentDateTime();
     this->Edits = 0;
     this->Reverts = 0;
+    this->Dropped = 0;
+}
+
+HuggleFeedBuffer::HuggleFeedBuffer(int capacity)
+{
+    if (capacity < 1)
+        capacity = 1;
+    this->capacity = capacity;
+    this->slots = new QAtomicPointer<WikiEdit>[capacity];
+    this->scores = new score_ht[capacity];
+}
+
+HuggleFeedBuffer::~HuggleFeedBuffer()
+{
+    WikiEdit *edit;
+    while ((edit = this->Pop()) != nullptr)
+        edit->DecRef();
+    delete[] this->slots;
+    delete[] this->scores;
+}
+
+bool HuggleFeedBuffer::Push(WikiEdit *edit, HuggleFeedOverflowPolicy policy, score_ht score)
+{
+    int tail_index = this->tail.loadAcquire();
+    while (tail_index - this->head.loadAcquire() >= this->capacity)
+    {
+        switch (policy)
+        {
+            case HuggleFeedOverflowPolicy_DropOldest:
+            {
+                WikiEdit *oldest = this->claim();
+                if (oldest != nullptr)
+                {
+                    oldest->DecRef();
+                    this->Dropped++;
+                }
+                break;
+            }
+            case HuggleFeedOverflowPolicy_DropLowestScore:
+            {
+                int lowest = -1;
+                for (int i = this->head.loadAcquire(); i < tail_index; i++)
+                {
+                    if (this->slots[i % this->capacity].loadAcquire() == nullptr)
+                        continue;
+                    if (lowest < 0 || this->scores[i % this->capacity] < this->scores[lowest])
+                        lowest = i % this->capacity;
+                }
+                if (lowest < 0)
+                {
+                    // consumer took everything meanwhile, so there is space now
+                    break;
+                }
+                if (score <= this->scores[lowest])
+                {
+                    this->Dropped++;
+                    return false;
+                }
+                WikiEdit *victim = this->slots[lowest].loadAcquire();
+                if (victim == nullptr)
+                    break;
+                // if consumer takes the victim before we replace it, this fails and we try again
+                if (this->slots[lowest].testAndSetOrdered(victim, edit))
+                {
+                    this->scores[lowest] = score;
+                    victim->DecRef();
+                    this->Dropped++;
+                    return true;
+                }
+                break;
+            }
+            case HuggleFeedOverflowPolicy_PauseFeed:
+            default:
+                this->Dropped++;
+                return false;
+        }
+    }
+    int index = tail_index % this->capacity;
+    this->scores[index] = score;
+    // the consumer may have claimed previous edit in this slot but not yet taken it, that's a matter of few instructions
+    while (!this->slots[index].testAndSetOrdered(nullptr, edit))
+        QThread::yieldCurrentThread();
+    this->tail.storeRelease(tail_index + 1);
+    return true;
+}
+
+WikiEdit *HuggleFeedBuffer::Pop()
+{
+    return this->claim();
+}
+
+WikiEdit *HuggleFeedBuffer::claim()
+{
+    forever
+    {
+        int head_index = this->head.loadAcquire();
+        if (head_index >= this->tail.loadAcquire())
+            return nullptr;
+        // whoever moves the head owns the edit that was there, so that producer dropping the oldest
+        // edit and consumer taking it at same time can't both get it
+        if (this->head.testAndSetOrdered(head_index, head_index + 1))
+            return this->slots[head_index % this->capacity].fetchAndStoreOrdered(nullptr);
+    }
 }
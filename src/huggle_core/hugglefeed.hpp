@@ -13,6 +13,8 @@
 
 #include "definitions.hpp"
 
+#include <QAtomicInt>
+#include <QAtomicPointer>
 #include <QDateTime>
 #include <QList>
 #include <QMutex>
@@ -21,6 +23,7 @@
 #define HUGGLE_FEED_PROVIDER_IRC          0
 #define HUGGLE_FEED_PROVIDER_WIKI         1
 #define HUGGLE_FEED_PROVIDER_XMLRPC       2
+#define HUGGLE_FEED_PROVIDER_REPLAY       3
 
 namespace Huggle
 {
@@ -28,6 +31,17 @@ namespace Huggle
     class WikiEdit;
     class WikiSite;
 
+    //! What the provider does when its buffer of edits is full
+    enum HuggleFeedOverflowPolicy
+    {
+        //! Oldest edits in buffer are dropped to make space for new ones
+        HuggleFeedOverflowPolicy_DropOldest,
+        //! Edit with lowest preliminary score is dropped, this might be the new edit as well
+        HuggleFeedOverflowPolicy_DropLowestScore,
+        //! New edits are dropped and the feed is paused until there is space in buffer again
+        HuggleFeedOverflowPolicy_PauseFeed
+    };
+
     class HUGGLE_EX_CORE StatisticsBlock
     {
         public:
@@ -35,8 +49,62 @@ namespace Huggle
             QDateTime Uptime;
             double Edits;
             double Reverts;
+            double Dropped;
+    };
+
+    //! Fixed size ring buffer that provider inserts edits to and main thread takes them from
+
+    //! It is meant for a single producer (the provider) and a single consumer, neither of them
+    //! ever needs to lock it. When the buffer is full the producer resolves it using an overflow
+    //! policy, edits are always removed from it by claiming their index the same way the consumer
+    //! does, so that it's safe even if the consumer is taking edits at same time.
+    class HUGGLE_EX_CORE HuggleFeedBuffer
+    {
+        public:
+            HuggleFeedBuffer(int capacity);
+            ~HuggleFeedBuffer();
+            /*!
+             * \brief Insert an edit into buffer, this can be only called by the producer
+             * \param edit Edit to insert
+             * \param policy What to do in case the buffer is full
+             * \param score Preliminary score of edit, only needed for HuggleFeedOverflowPolicy_DropLowestScore
+             * \return false if the edit wasn't inserted, in that case caller still owns it
+             */
+            bool Push(WikiEdit *edit, HuggleFeedOverflowPolicy policy, score_ht score = 0);
+            //! Take the oldest edit from buffer, returns nullptr if it's empty
+            WikiEdit *Pop();
+            int Count();
+            bool IsEmpty();
+            int GetCapacity();
+            //! Number of edits that were dropped because there was no space for them
+            unsigned long long Dropped = 0;
+        private:
+            WikiEdit *claim();
+            QAtomicPointer<WikiEdit> *slots;
+            //! Preliminary scores of edits in slots, these are only used by the producer
+            score_ht *scores;
+            int capacity;
+            //! Index of oldest edit, only increases
+            QAtomicInt head;
+            //! Index where next edit is inserted, only producer changes it
+            QAtomicInt tail;
     };
 
+    inline int HuggleFeedBuffer::Count()
+    {
+        return this->tail.loadAcquire() - this->head.loadAcquire();
+    }
+
+    inline bool HuggleFeedBuffer::IsEmpty()
+    {
+        return this->Count() <= 0;
+    }
+
+    inline int HuggleFeedBuffer::GetCapacity()
+    {
+        return this->capacity;
+    }
+
     //! Feed provider stub class every provider must be derived from this one
     class HUGGLE_EX_CORE HuggleFeed : public MediaWikiObject
     {
@@ -62,8 +130,12 @@ namespace Huggle
             virtual void Pause() {}
             //! Resume edit parsing
             virtual void Resume() {}
+            //! Pause requested by user, feed stays paused until user resumes it, even if it was paused by overflow policy too
+            void PauseByUser();
+            //! Resume the feed paused by user, unless it's also paused because buffer is full
+            void ResumeByUser();
             //! Check if feed is containing some edits in buffer
-            virtual bool ContainsEdit() { return false; }
+            virtual bool ContainsEdit();
             virtual bool IsPaused() { return false; }
             virtual QString GetError();
             virtual int GetID()=0;
@@ -77,8 +149,13 @@ namespace Huggle
             virtual bool IsStopped() { return true; }
             virtual double GetRevertsPerMinute();
             virtual double GetEditsPerMinute();
+            //! Number of edits that were lost because buffer of provider was full
+            unsigned long long GetDroppedEdits();
+            double GetDroppedPerMinute();
             //! Return a last edit from cache or NULL
-            virtual WikiEdit *RetrieveEdit() { return nullptr; }
+            virtual WikiEdit *RetrieveEdit();
+            //! Pre process the edit and insert it to buffer, in case it matches current filter
+            virtual void InsertEdit(WikiEdit *edit);
             virtual QString ToString() = 0;
             virtual void IncrementEdits();
             virtual void IncrementReverts();
@@ -99,6 +176,13 @@ namespace Huggle
             QMutex *statisticsMutex;
             QDateTime startupTime;
             QList<StatisticsBlock*> statisticsBlocks;
+            HuggleFeedBuffer *editBuffer;
+            //! Feed was paused by overflow policy and will be resumed once there is space in buffer
+            bool pausedByBuffer = false;
+            //! Feed was paused by user, it must not be resumed when there is space in buffer again
+            bool pausedByUser = false;
+            //! Overflow was already reported to user, so that we don't flood the log
+            bool overflowReported = false;
     };
 }
 
@@ -10,13 +10,11 @@
 
 #include "definitions.hpp"
 #include "hugglefeedproviderirc.hpp"
+#include "hugglefeedproviderreplay.hpp"
 #include "configuration.hpp"
 #include "exception.hpp"
 #include "generic.hpp"
 #include "localization.hpp"
-#include "hooks.hpp"
-#include "hugglequeuefilter.hpp"
-#include "querypool.hpp"
 #include "syslog.hpp"
 #include "wikiedit.hpp"
 #include "wikipage.hpp"
@@ -29,6 +27,263 @@
 
 using namespace Huggle;
 
+// Colour codes used by the feed, every field is introduced by one of them
+#define HUGGLE_IRC_COLOR                QChar(3)
+#define HUGGLE_IRC_BOLD                 QChar(2)
+#define HUGGLE_IRC_TITLE                QLatin1String("\003" "07")
+#define HUGGLE_IRC_TITLE_END            QLatin1String("\003" "14")
+#define HUGGLE_IRC_FLAGS                QLatin1String("\003" "4 ")
+#define HUGGLE_IRC_USER                 QLatin1String("\003" "03")
+#define HUGGLE_IRC_SIZE                 QLatin1String("\003" " (")
+#define HUGGLE_IRC_SUMMARY              QLatin1String("\003" "10")
+
+struct IRCLogAction
+{
+    const char *Name;
+    IRCRecentChange::LogType Type;
+};
+
+// This table must be sorted, it's searched using binary search
+static const IRCLogAction IRCLogActions[] =
+{
+    { "add",          IRCRecentChange::LogType_Rights },
+    { "approve",      IRCRecentChange::LogType_Patrol },
+    { "autocreate",   IRCRecentChange::LogType_Create },
+    { "autopromote",  IRCRecentChange::LogType_Rights },
+    { "block",        IRCRecentChange::LogType_Block },
+    { "byemail",      IRCRecentChange::LogType_Create },
+    { "create",       IRCRecentChange::LogType_Create },
+    { "create2",      IRCRecentChange::LogType_Create },
+    { "delete",       IRCRecentChange::LogType_Delete },
+    { "event",        IRCRecentChange::LogType_Delete },
+    { "feature",      IRCRecentChange::LogType_Feedback },
+    { "helpful",      IRCRecentChange::LogType_Feedback },
+    { "hit",          IRCRecentChange::LogType_AbuseFilter },
+    { "modify",       IRCRecentChange::LogType_Protect },
+    { "move",         IRCRecentChange::LogType_Move },
+    { "noaction",     IRCRecentChange::LogType_Feedback },
+    { "overwrite",    IRCRecentChange::LogType_Upload },
+    { "patrol",       IRCRecentChange::LogType_Patrol },
+    { "protect",      IRCRecentChange::LogType_Protect },
+    { "reblock",      IRCRecentChange::LogType_Block },
+    { "resolve",      IRCRecentChange::LogType_Feedback },
+    { "restore",      IRCRecentChange::LogType_Delete },
+    { "review",       IRCRecentChange::LogType_Patrol },
+    { "revision",     IRCRecentChange::LogType_Delete },
+    { "rights",       IRCRecentChange::LogType_Rights },
+    { "selfadd",      IRCRecentChange::LogType_Rights },
+    { "tag",          IRCRecentChange::LogType_Tag },
+    { "thank",        IRCRecentChange::LogType_Thank },
+    { "unblock",      IRCRecentChange::LogType_Block },
+    { "unhelpful",    IRCRecentChange::LogType_Feedback },
+    { "unprotect",    IRCRecentChange::LogType_Protect },
+    { "upload",       IRCRecentChange::LogType_Upload }
+};
+
+IRCRecentChange::LogType IRCRecentChange::ClassifyLogAction(const QStringRef &action)
+{
+    // actions like move_redir or delete_redir are variants of their base action
+    int length = action.indexOf(QChar('_'));
+    if (length < 0)
+        length = action.length();
+    QStringRef key(action.string(), action.position(), length);
+    int low = 0;
+    int high = static_cast<int>(sizeof(IRCLogActions) / sizeof(IRCLogAction)) - 1;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        int result = QStringRef::compare(key, QLatin1String(IRCLogActions[middle].Name));
+        if (result == 0)
+            return IRCLogActions[middle].Type;
+        if (result < 0)
+            high = middle - 1;
+        else
+            low = middle + 1;
+    }
+    return LogType_Unknown;
+}
+
+IRCRecentChange::IRCRecentChange()
+{
+    this->Error = nullptr;
+    this->Log = LogType_None;
+    this->Diff = 0;
+    this->OldID = 0;
+    this->Size = 0;
+    this->HasSize = false;
+    this->Bot = false;
+    this->NewPage = false;
+    this->Minor = false;
+}
+
+bool IRCRecentChange::Parse(const QString &line)
+{
+    // The line looks like this (where ^C is colour code):
+    // ^C14[[^C07Title^C14]]^C4 flags^C10 ^C02url?diff=X&oldid=Y^C ^C5*^C ^C03User^C ^C5*^C (+size) ^C10summary^C
+    // cursor is only ever moved forward, so the whole line is walked just once
+    int cursor = line.indexOf(HUGGLE_IRC_TITLE);
+    if (cursor < 0)
+    {
+        this->Error = "no07";
+        return false;
+    }
+    cursor += 3;
+    int end = line.indexOf(HUGGLE_IRC_TITLE_END, cursor);
+    if (end < 0)
+    {
+        this->Error = "no14";
+        return false;
+    }
+    this->Title = QStringRef(&line, cursor, end - cursor);
+    cursor = line.indexOf(HUGGLE_IRC_FLAGS, end);
+    if (cursor < 0)
+    {
+        this->Error = "no:x4";
+        return false;
+    }
+    cursor += 3;
+    end = line.indexOf(HUGGLE_IRC_COLOR, cursor);
+    if (end < 0)
+        end = line.length();
+    this->Flags = QStringRef(&line, cursor, end - cursor);
+    // flags of regular edits are only made of letters N, M, B and !, anything else is a log action
+    int word = -1;
+    for (int i = cursor; i <= end; i++)
+    {
+        QChar c = (i < end) ? line.at(i) : QChar(' ');
+        if (c == ' ')
+        {
+            if (word >= 0)
+            {
+                if (this->Log == LogType_None)
+                    this->Log = ClassifyLogAction(QStringRef(&line, word, i - word));
+                word = -1;
+            }
+            continue;
+        }
+        if (word < 0 && c != 'N' && c != 'M' && c != 'B' && c != '!')
+            word = i;
+        if (c == 'N')
+            this->NewPage = true;
+        else if (c == 'M')
+            this->Minor = true;
+        else if (c == 'B')
+            this->Bot = true;
+    }
+    cursor = end;
+    if (!this->IsLog())
+    {
+        if (!this->NewPage)
+        {
+            cursor = line.indexOf(QLatin1String("?diff="), cursor);
+            if (cursor < 0)
+            {
+                this->Error = "no diff";
+                return false;
+            }
+            cursor += 6;
+            end = line.indexOf(QChar('&'), cursor);
+            if (end < 0)
+            {
+                this->Error = "no &";
+                return false;
+            }
+            this->Diff = QStringRef(&line, cursor, end - cursor).toLongLong();
+            cursor = end;
+        }
+        cursor = line.indexOf(QLatin1String("oldid="), cursor);
+        if (cursor < 0)
+        {
+            this->Error = "no oldid";
+            return false;
+        }
+        cursor += 6;
+        end = line.indexOf(HUGGLE_IRC_COLOR, cursor);
+        if (end < 0)
+        {
+            this->Error = "no termin";
+            return false;
+        }
+        this->OldID = QStringRef(&line, cursor, end - cursor).toLongLong();
+        cursor = end;
+    }
+    cursor = line.indexOf(HUGGLE_IRC_USER, cursor);
+    if (cursor < 0)
+    {
+        this->Error = "no user";
+        return false;
+    }
+    cursor += 3;
+    end = line.indexOf(HUGGLE_IRC_COLOR, cursor);
+    if (end < 0)
+    {
+        this->Error = "no termin";
+        return false;
+    }
+    if (end == cursor)
+    {
+        this->Error = "empty user";
+        return false;
+    }
+    this->User = QStringRef(&line, cursor, end - cursor);
+    cursor = end;
+    // size is optional, it's formatted as (+123) or (-123) and sometimes it's bold
+    int size = line.indexOf(HUGGLE_IRC_SIZE, cursor);
+    if (size >= 0)
+    {
+        cursor = size + 3;
+        end = line.indexOf(QChar(')'), cursor);
+        if (end >= 0)
+        {
+            int from = cursor;
+            int to = end;
+            while (from < to && line.at(from) == HUGGLE_IRC_BOLD)
+                from++;
+            while (to > from && line.at(to - 1) == HUGGLE_IRC_BOLD)
+                to--;
+            if (from < to && (line.at(from) == '+' || line.at(from) == '-'))
+            {
+                this->Size = QStringRef(&line, from + 1, to - from - 1).toLong();
+                if (line.at(from) == '-')
+                    this->Size *= -1;
+                this->HasSize = true;
+            }
+        }
+    }
+    cursor = line.indexOf(HUGGLE_IRC_SUMMARY, cursor);
+    if (cursor >= 0)
+    {
+        cursor += 3;
+        end = line.indexOf(HUGGLE_IRC_COLOR, cursor);
+        if (end >= 0)
+            this->Summary = QStringRef(&line, cursor, end - cursor);
+    }
+    return true;
+}
+
+WikiEdit *IRCRecentChange::CreateEdit(WikiSite *site) const
+{
+    WikiEdit *edit = new WikiEdit();
+    edit->Page = new WikiPage(this->Title.toString(), site);
+    edit->IncRef();
+    edit->Bot = this->Bot;
+    edit->NewPage = this->NewPage;
+    edit->IsMinor = this->Minor;
+    if (!this->NewPage)
+    {
+        edit->Diff = this->Diff;
+        edit->RevID = this->Diff;
+    }
+    edit->OldID = this->OldID;
+    edit->User = new WikiUser(this->User.toString(), site);
+    if (this->HasSize)
+        edit->SetSize(this->Size);
+    else
+        HUGGLE_DEBUG("No size information for " + edit->Page->PageName, 1);
+    edit->Summary = this->Summary.toString();
+    return edit;
+}
+
 HuggleFeedProviderIRC::HuggleFeedProviderIRC(WikiSite *site) : HuggleFeed(site)
 {
     this->isPaused = false;
@@ -39,11 +294,6 @@ HuggleFeedProviderIRC::HuggleFeedProviderIRC(WikiSite *site) : HuggleFeed(site)
 HuggleFeedProviderIRC::~HuggleFeedProviderIRC()
 {
     this->Stop();
-    while (this->editBuffer.count() > 0)
-    {
-        this->editBuffer.at(0)->DecRef();
-        this->editBuffer.removeAt(0);
-    }
     delete this->network;
 }
 
@@ -97,183 +347,24 @@ void HuggleFeedProviderIRC::Stop()
     this->isConnected = false;
 }
 
-void HuggleFeedProviderIRC::InsertEdit(WikiEdit *edit)
-{
-    if (edit == nullptr)
-        throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
-
-    // Increase the number of edits that were made since provider is up, this is used for statistics
-    this->IncrementEdits();
-    // We need to pre process edit so that we have all its properties ready for queue filter
-    QueryPool::HugglePool->PreProcessEdit(edit);
-    // We only insert it to buffer in case that current filter matches the edit, this is probably not needed
-    // but it might be a performance improvement at some point
-    if (edit->GetSite()->CurrentFilter->Matches(edit) && Hooks::EditBeforePreProcess(edit))
-    {
-        if (this->editBuffer.size() > Configuration::HuggleConfiguration->SystemConfig_ProviderCache)
-        {
-            // If the buffer is full we need to remove 10 oldest edits
-            // we also show a warning to user
-            while (this->editBuffer.size() > (Configuration::HuggleConfiguration->SystemConfig_ProviderCache - 10))
-            {
-                this->editBuffer.at(0)->DecRef();
-                this->editBuffer.removeAt(0);
-            }
-            // This warning isn't useful if the provider is not running
-            if (!this->IsPaused())
-                Huggle::Syslog::HuggleLogs->WarningLog("insufficient space in irc cache, increase ProviderCache size, otherwise you will be losing edits");
-        }
-        this->editBuffer.append(edit);
-    } else
-    {
-        edit->DecRef();
-    }
-}
-
-void HuggleFeedProviderIRC::ParseEdit(QString line)
+void HuggleFeedProviderIRC::ParseEdit(const QString &line)
 {
     // skip edits if provider is disabled
     if (this->isPaused)
     {
         return;
     }
-    if (!line.contains(QString(QChar(003)) + "07"))
+    IRCRecentChange rc;
+    if (!rc.Parse(line))
     {
-        HUGGLE_DEBUG("Invalid line (no07):" + line, 1);
+        HUGGLE_DEBUG("Invalid line (" + QString(rc.Error) + "):" + line, 1);
         return;
     }
-    line = line.mid(line.indexOf(QString(QChar(003)) + "07") + 3);
-    if (!line.contains(QString(QChar(003)) + "14"))
-    {
-        HUGGLE_DEBUG("Invalid line (no14):" + line, 1);
+    // we only care about edits, log entries are classified by the parser so that
+    // they can be used for something later, but right now we just drop them
+    if (rc.IsLog())
         return;
-    }
-    WikiEdit *edit = new WikiEdit();
-    edit->Page = new WikiPage(line.mid(0, line.indexOf(QString(QChar(003)) + "14")), this->GetSite());
-    edit->IncRef();
-    if (!line.contains(QString(QChar(003)) + "4 "))
-    {
-        HUGGLE_DEBUG("Invalid line (no:x4:" + line, 1);
-        edit->DecRef();
-        return;
-    }
-    line = line.mid(line.indexOf(QString(QChar(003)) + "4 ") + 2);
-    QString flags = line.mid(0, line.indexOf(QChar(003)));
-    edit->Bot = flags.contains("B");
-    edit->NewPage = flags.contains("N");
-    edit->IsMinor = flags.contains("M");
-    // this below looks like a nasty hack to filter out just what we need
-    // but I will later use all of these actions for something too
-    if (flags.contains("thank")    || flags.contains("modify") ||
-        flags.contains("rights")   || flags.contains("review") ||
-        flags.contains("block")    || flags.contains("protect") ||
-        flags.contains("reblock")  || flags.contains("unhelpful") ||
-        flags.contains("helpful")  || flags.contains("approve") ||
-        flags.contains("resolve")  || flags.contains("upload") ||
-        flags.contains("feature")  || flags.contains("noaction") ||
-        flags.contains("byemail")  || flags.contains("overwrite") ||
-        flags.contains("create")   || flags.contains("delete") ||
-        flags.contains("restore")  || flags.contains("move") ||
-        flags.contains("tag")      || /* abuse filter */flags.contains("hit") ||
-        flags.contains("patrol")   || flags.contains("revision") ||
-        flags.contains("add")      || flags.contains("selfadd"))
-    {
-        edit->DecRef();
-        return;
-    }
-    if (!edit->NewPage)
-    {
-        if (!line.contains("?diff="))
-        {
-            HUGGLE_DEBUG("Invalid line (flags: " + flags + ") (no diff):" + line, 1);
-            edit->DecRef();
-            return;
-        }
-
-        line = line.mid(line.indexOf("?diff=") + 6);
-
-        if (!line.contains("&"))
-        {
-            HUGGLE_DEBUG("Invalid line (no &):" + line, 1);
-            edit->DecRef();
-            return;
-        }
-        edit->Diff = line.mid(0, line.indexOf("&")).toLongLong();
-        edit->RevID = line.mid(0, line.indexOf("&")).toLongLong();
-    }
-    if (!line.contains("oldid="))
-    {
-        HUGGLE_DEBUG("Invalid line (no oldid?):" + line, 1);
-        edit->DecRef();
-        return;
-    }
-    line = line.mid(line.indexOf("oldid=") + 6);
-    if (!line.contains(QString(QChar(003))))
-    {
-        HUGGLE_DEBUG("Invalid line (no termin):" + line, 1);
-        edit->DecRef();
-        return;
-    }
-    edit->OldID = line.midRef(0, line.indexOf(QString(QChar(003)))).toInt();
-    if (!line.contains(QString(QChar(003)) + "03"))
-    {
-        HUGGLE_DEBUG("Invalid line, no user: " + line, 1);
-        edit->DecRef();
-        return;
-    }
-    line = line.mid(line.indexOf(QString(QChar(003)) + "03") + 3);
-    if (!line.contains(QString(QChar(3))))
-    {
-        HUGGLE_DEBUG("Invalid line (no termin):" + line, 1);
-        edit->DecRef();
-        return;
-    }
-    QString name = line.mid(0, line.indexOf(QString(QChar(3))));
-    if (name.length() <= 0)
-    {
-        edit->DecRef();
-        return;
-    }
-    edit->User = new WikiUser(name, this->GetSite());
-    if (line.contains(QString(QChar(3)) + " ("))
-    {
-        line = line.mid(line.indexOf(QString(QChar(3)) + " (") + 3);
-        if (line.contains(")"))
-        {
-            QString xx = line.mid(0, line.indexOf(")"));
-            xx = xx.replace("\002", "");
-            long size = 0;
-            if (xx.startsWith("+"))
-            {
-                xx = xx.mid(1);
-                size = xx.toLong();
-                edit->SetSize(size);
-            } else if (xx.startsWith("-"))
-            {
-                xx = xx.mid(1);
-                size = xx.toLong() * -1;
-                edit->SetSize(size);
-            } else
-            {
-                HUGGLE_DEBUG("No size information for " + edit->Page->PageName, 1);
-            }
-        }else
-        {
-            HUGGLE_DEBUG("No size information for " + edit->Page->PageName, 1);
-        }
-    } else
-    {
-        HUGGLE_DEBUG("No size information for " + edit->Page->PageName, 1);
-    }
-    if (line.contains(QString(QChar(3)) + "10"))
-    {
-        line = line.mid(line.indexOf(QString(QChar(3)) + "10") + 3);
-        if (line.contains(QString(QChar(3))))
-        {
-            edit->Summary = line.mid(0, line.indexOf(QString(QChar(3))));
-        }
-    }
-    this->InsertEdit(edit);
+    this->InsertEdit(rc.CreateEdit(this->GetSite()));
 }
 
 bool HuggleFeedProviderIRC::IsStopped()
@@ -281,21 +372,6 @@ bool HuggleFeedProviderIRC::IsStopped()
     return !this->IsWorking();
 }
 
-bool HuggleFeedProviderIRC::ContainsEdit()
-{
-    return (!this->editBuffer.empty());
-}
-
-WikiEdit *HuggleFeedProviderIRC::RetrieveEdit()
-{
-    if (this->editBuffer.empty())
-        return nullptr;
-
-    WikiEdit *edit = this->editBuffer.at(0);
-    this->editBuffer.removeAt(0);
-    return edit;
-}
-
 unsigned long long HuggleFeedProviderIRC::GetBytesReceived()
 {
     if (!this->network)
@@ -322,6 +398,7 @@ QString HuggleFeedProviderIRC::ToString()
 
 void HuggleFeedProviderIRC::OnIRCChannelMessage(libircclient::Parser *px)
 {
+    HuggleFeedRecorder::RecordLine(HUGGLE_FEED_RECORD_IRC, this->GetSite(), px->GetText().toUtf8());
     this->ParseEdit(px->GetText());
 }
 
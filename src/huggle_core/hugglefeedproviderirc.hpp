@@ -14,6 +14,7 @@
 #include "definitions.hpp"
 
 #include <QString>
+#include <QStringRef>
 #include <QThread>
 #include <QList>
 #include <QTimer>
@@ -32,11 +33,66 @@ namespace libircclient
 namespace Huggle
 {
     class WikiEdit;
+    class WikiSite;
     namespace IRC
     {
         class NetworkIrc;
     }
 
+    //! One line of the wikimedia irc recent changes feed split into its fields
+
+    //! The line is tokenized in a single pass, string members are only references into the
+    //! line that was parsed, so nothing is copied until the edit is built from them. This
+    //! also means that the parsed line must stay alive for as long as this object is used.
+    class HUGGLE_EX_CORE IRCRecentChange
+    {
+        public:
+            //! Kind of log entry, as determined from the flags field of the line
+            enum LogType
+            {
+                //! This line is a regular edit
+                LogType_None,
+                //! Log entry with an action we don't know of
+                LogType_Unknown,
+                LogType_AbuseFilter,
+                LogType_Block,
+                LogType_Create,
+                LogType_Delete,
+                LogType_Feedback,
+                LogType_Move,
+                LogType_Patrol,
+                LogType_Protect,
+                LogType_Rights,
+                LogType_Tag,
+                LogType_Thank,
+                LogType_Upload
+            };
+
+            //! Look up the log action (for example "block" or "move_redir") in a precomputed table
+            static LogType ClassifyLogAction(const QStringRef &action);
+            IRCRecentChange();
+            //! Tokenize the line, returns false if it isn't a valid recent change, see Error
+            bool Parse(const QString &line);
+            bool IsLog() const { return this->Log != LogType_None; }
+            //! Create a new edit from parsed line, the edit already has one reference that belongs to caller
+            WikiEdit *CreateEdit(WikiSite *site) const;
+            QStringRef Title;
+            QStringRef Flags;
+            QStringRef User;
+            QStringRef Summary;
+            //! Short description of why the line couldn't be parsed
+            const char *Error;
+            LogType Log;
+            revid_ht Diff;
+            revid_ht OldID;
+            long Size;
+            //! Whether size of the change was present in the line
+            bool HasSize;
+            bool Bot;
+            bool NewPage;
+            bool Minor;
+    };
+
     //! Provider that uses a wikimedia irc recent changes feed to retrieve information about edits
     class HUGGLE_EX_CORE HuggleFeedProviderIRC : public QObject, public HuggleFeed
     {
@@ -48,13 +104,10 @@ namespace Huggle
             bool IsWorking() override;
             void Stop() override;
             bool Restart() override { this->Stop(); return this->Start(); }
-            void InsertEdit(WikiEdit *edit);
-            void ParseEdit(QString line);
+            void ParseEdit(const QString &line);
             bool IsStopped() override;
             int FeedPriority() override { return 10; }
             int GetID() override { return HUGGLE_FEED_PROVIDER_IRC; }
-            bool ContainsEdit() override;
-            WikiEdit *RetrieveEdit() override;
             bool IsPaused() override { return this->isPaused; }
             void Pause() override { this->isPaused = true; }
             void Resume() override { this->isPaused = false; }
@@ -69,7 +122,6 @@ namespace Huggle
             void OnDisconnected();
         protected:
             bool isConnected;
-            QList<WikiEdit*> editBuffer;
             bool isPaused;
             libircclient::Network *network;
     };
@@ -0,0 +1,246 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "hugglefeedproviderreplay.hpp"
+#include "configuration.hpp"
+#include "hugglefeedproviderirc.hpp"
+#include "syslog.hpp"
+#include "wikiedit.hpp"
+#include "wikisite.hpp"
+
+using namespace Huggle;
+
+HuggleFeedRecorder *HuggleFeedRecorder::Recorder = nullptr;
+
+void HuggleFeedRecorder::RecordLine(char source, WikiSite *site, const QByteArray &line)
+{
+    if (HuggleFeedRecorder::Recorder != nullptr)
+        HuggleFeedRecorder::Recorder->Record(source, site, line);
+}
+
+HuggleFeedRecorder::HuggleFeedRecorder(const QString &path) : file(path)
+{
+
+}
+
+HuggleFeedRecorder::~HuggleFeedRecorder()
+{
+    if (this->file.isOpen())
+        this->file.close();
+}
+
+bool HuggleFeedRecorder::Open()
+{
+    if (!this->file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    this->clock.start();
+    return true;
+}
+
+void HuggleFeedRecorder::Record(char source, WikiSite *site, const QByteArray &line)
+{
+    if (line.isEmpty())
+        return;
+    QByteArray record = QByteArray::number(this->clock.elapsed());
+    record.append('\t');
+    record.append(source);
+    record.append('\t');
+    record.append(site->Name.toUtf8());
+    record.append('\t');
+    record.append(line);
+    record.append('\n');
+    this->lock.lock();
+    this->file.write(record);
+    this->Lines++;
+    this->lock.unlock();
+}
+
+QString HuggleFeedRecorder::GetPath()
+{
+    return this->file.fileName();
+}
+
+HuggleFeedProviderReplay::HuggleFeedProviderReplay(WikiSite *site, const QString &path, double speed) : HuggleFeed(site)
+{
+    this->path = path;
+    this->speed = speed;
+    this->timer = new QTimer();
+    connect(this->timer, SIGNAL(timeout()), this, SLOT(OnTick()));
+}
+
+HuggleFeedProviderReplay::~HuggleFeedProviderReplay()
+{
+    this->Stop();
+    delete this->timer;
+}
+
+bool HuggleFeedProviderReplay::Start()
+{
+    if (this->isWorking)
+        return true;
+    delete this->file;
+    this->file = new QFile(this->path);
+    if (!this->file->open(QIODevice::ReadOnly))
+    {
+        this->lastError = "Unable to open " + this->path + ": " + this->file->errorString();
+        Syslog::HuggleLogs->ErrorLog(this->lastError);
+        delete this->file;
+        this->file = nullptr;
+        return false;
+    }
+    this->position = 0;
+    this->lastTick = 0;
+    this->replayed = 0;
+    this->hasRecord = false;
+    this->isWorking = true;
+    this->isPaused = false;
+    this->xmlParser.Clear();
+    this->startupTime = QDateTime::currentDateTime();
+    this->clock.start();
+    this->timer->start(HUGGLE_FEED_REPLAY_INTERVAL);
+    return true;
+}
+
+bool HuggleFeedProviderReplay::IsWorking()
+{
+    return this->isWorking;
+}
+
+void HuggleFeedProviderReplay::Stop()
+{
+    this->timer->stop();
+    this->isWorking = false;
+    this->isPaused = false;
+    delete this->file;
+    this->file = nullptr;
+}
+
+bool HuggleFeedProviderReplay::IsStopped()
+{
+    return !this->isWorking;
+}
+
+bool HuggleFeedProviderReplay::IsPaused()
+{
+    return this->isPaused;
+}
+
+void HuggleFeedProviderReplay::Pause()
+{
+    this->isPaused = true;
+}
+
+void HuggleFeedProviderReplay::Resume()
+{
+    this->isPaused = false;
+}
+
+QString HuggleFeedProviderReplay::GetError()
+{
+    return this->lastError;
+}
+
+unsigned long long HuggleFeedProviderReplay::GetBytesReceived()
+{
+    return this->bytesRcvd;
+}
+
+QString HuggleFeedProviderReplay::ToString()
+{
+    return "Replay";
+}
+
+void HuggleFeedProviderReplay::OnTick()
+{
+    if (!this->isWorking)
+        return;
+    qint64 now = this->clock.elapsed();
+    // time doesn't pass in recording when we are paused, so that pausing the feed
+    // because of full buffer doesn't make us skip a part of it
+    if (!this->isPaused)
+        this->position += static_cast<double>(now - this->lastTick) * this->speed;
+    this->lastTick = now;
+    if (this->isPaused)
+        return;
+    int records = 0;
+    while (records++ < HUGGLE_FEED_REPLAY_BATCH && !this->isPaused)
+    {
+        if (!this->hasRecord && !this->readRecord())
+        {
+            this->finish();
+            return;
+        }
+        if (this->speed > 0 && this->recordTime > this->position)
+            return;
+        this->hasRecord = false;
+        this->replayRecord();
+    }
+}
+
+bool HuggleFeedProviderReplay::readRecord()
+{
+    while (!this->file->atEnd())
+    {
+        QByteArray record = this->file->readLine();
+        this->bytesRcvd += static_cast<unsigned long long>(record.size());
+        if (record.endsWith('\n'))
+            record.chop(1);
+        // time, source which is always exactly one character, site and the line
+        int time_end = record.indexOf('\t');
+        if (time_end < 1 || record.size() < time_end + 3 || record.at(time_end + 2) != '\t')
+        {
+            HUGGLE_DEBUG("Invalid record in " + this->path + ": " + QString::fromUtf8(record), 1);
+            continue;
+        }
+        int site_end = record.indexOf('\t', time_end + 3);
+        if (site_end < 0)
+        {
+            HUGGLE_DEBUG("Invalid record in " + this->path + ": " + QString::fromUtf8(record), 1);
+            continue;
+        }
+        if (QString::fromUtf8(record.mid(time_end + 3, site_end - time_end - 3)) != this->GetSite()->Name)
+            continue;
+        this->recordTime = record.left(time_end).toLongLong();
+        this->recordSource = record.at(time_end + 1);
+        this->recordLine = record.mid(site_end + 1);
+        this->hasRecord = true;
+        return true;
+    }
+    return false;
+}
+
+void HuggleFeedProviderReplay::replayRecord()
+{
+    this->replayed++;
+    if (this->recordSource == HUGGLE_FEED_RECORD_IRC)
+    {
+        QString line = QString::fromUtf8(this->recordLine);
+        IRCRecentChange rc;
+        if (!rc.Parse(line) || rc.IsLog())
+            return;
+        this->InsertEdit(rc.CreateEdit(this->GetSite()));
+    } else if (this->recordSource == HUGGLE_FEED_RECORD_XMLRCS)
+    {
+        if (!this->xmlParser.Parse(this->recordLine) || this->xmlParser.Name != "edit")
+            return;
+        WikiEdit *edit = this->xmlParser.CreateEdit(this->GetSite(), this->recordLine);
+        if (edit)
+            this->InsertEdit(edit);
+    }
+}
+
+void HuggleFeedProviderReplay::finish()
+{
+    double seconds = static_cast<double>(this->clock.elapsed()) / 1000;
+    Syslog::HuggleLogs->Log("Replay of " + this->path + " finished, " + QString::number(this->replayed) + " records in " +
+                            QString::number(seconds) + " seconds (" + QString::number(this->replayed / qMax(seconds, 0.001)) +
+                            " per second), " + QString::number(this->GetDroppedEdits()) + " edits were dropped");
+    this->Stop();
+}
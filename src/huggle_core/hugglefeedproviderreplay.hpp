@@ -0,0 +1,117 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef HUGGLEFEEDPROVIDERREPLAY_H
+#define HUGGLEFEEDPROVIDERREPLAY_H
+
+#include "definitions.hpp"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QTimer>
+#include "hugglefeed.hpp"
+#include "hugglefeedproviderxml.hpp"
+
+//! Record contains a line received from irc feed
+#define HUGGLE_FEED_RECORD_IRC              'I'
+//! Record contains a line received from XmlRcs
+#define HUGGLE_FEED_RECORD_XMLRCS           'X'
+//! How often the replay provider inserts edits, in ms
+#define HUGGLE_FEED_REPLAY_INTERVAL         10
+//! Maximum number of records replayed in one tick, so that main thread isn't blocked when replaying at max speed
+#define HUGGLE_FEED_REPLAY_BATCH            500
+
+namespace Huggle
+{
+    //! Writes every raw line received by irc and XmlRcs providers into a file
+
+    //! Every record is one line in format: time in ms since recording started, source (HUGGLE_FEED_RECORD_IRC
+    //! or HUGGLE_FEED_RECORD_XMLRCS), name of site and the line itself, separated by tabs. Such a file
+    //! can be replayed by HuggleFeedProviderReplay.
+    class HUGGLE_EX_CORE HuggleFeedRecorder
+    {
+        public:
+            //! Recorder used by all providers, this is nullptr unless recording was enabled
+            static HuggleFeedRecorder *Recorder;
+            //! Record a line in case that recording is enabled
+            static void RecordLine(char source, WikiSite *site, const QByteArray &line);
+
+            HuggleFeedRecorder(const QString &path);
+            ~HuggleFeedRecorder();
+            bool Open();
+            void Record(char source, WikiSite *site, const QByteArray &line);
+            QString GetPath();
+            //! Number of lines that were recorded
+            unsigned long long Lines = 0;
+        private:
+            QMutex lock;
+            QFile file;
+            QElapsedTimer clock;
+    };
+
+    /*!
+     * \brief Provider that replays a file written by HuggleFeedRecorder
+     *
+     * Records are inserted in the same way the original provider would do it, either in real time, N times faster
+     * or as fast as possible, which is useful to find how many edits per second huggle can process.
+     */
+    class HUGGLE_EX_CORE HuggleFeedProviderReplay : public QObject, public HuggleFeed
+    {
+            Q_OBJECT
+        public:
+            HuggleFeedProviderReplay(WikiSite *site, const QString &path, double speed = 1);
+            ~HuggleFeedProviderReplay() override;
+            bool Start() override;
+            bool IsWorking() override;
+            void Stop() override;
+            bool Restart() override { this->Stop(); return this->Start(); }
+            bool IsStopped() override;
+            bool IsPaused() override;
+            void Pause() override;
+            void Resume() override;
+            int GetID() override { return HUGGLE_FEED_PROVIDER_REPLAY; }
+            int FeedPriority() override { return 0; }
+            QString GetError() override;
+            unsigned long long GetBytesReceived() override;
+            unsigned long long GetBytesSent() override { return 0; }
+            QString ToString() override;
+        private slots:
+            void OnTick();
+        private:
+            //! Reads next record from file, returns false at the end of it
+            bool readRecord();
+            void replayRecord();
+            void finish();
+            QString path;
+            //! 1 means real time, 0 as fast as possible
+            double speed;
+            QFile *file = nullptr;
+            QTimer *timer;
+            QElapsedTimer clock;
+            //! Position in recording that was already replayed, in ms
+            double position = 0;
+            qint64 lastTick = 0;
+            //! Record that was read but isn't due yet
+            bool hasRecord = false;
+            qint64 recordTime = 0;
+            char recordSource = 0;
+            QByteArray recordLine;
+            XmlRcsParser xmlParser;
+            QString lastError = "No error";
+            bool isWorking = false;
+            bool isPaused = false;
+            unsigned long long bytesRcvd = 0;
+            unsigned long long replayed = 0;
+    };
+}
+
+#endif // HUGGLEFEEDPROVIDERREPLAY_H
@@ -9,13 +9,12 @@
 //GNU General Public License for more details.
 
 #include "hugglefeedproviderwiki.hpp"
-#include <QtXml>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QUrl>
 #include "configuration.hpp"
 #include "exception.hpp"
-#include "hugglequeuefilter.hpp"
 #include "localization.hpp"
-#include "mediawiki.hpp"
-#include "hooks.hpp"
 #include "querypool.hpp"
 #include "syslog.hpp"
 #include "wikipage.hpp"
@@ -25,22 +24,13 @@
 using namespace Huggle;
 HuggleFeedProviderWiki::HuggleFeedProviderWiki(WikiSite *site) : HuggleFeed(site)
 {
-    this->editBuffer = new QList<WikiEdit*>();
     this->Site = site;
     this->isRefreshing = false;
-    // we set the latest time to yesterday so that we don't get in troubles with time offset
-    this->latestTime = QDateTime::currentDateTime().addDays(-1);
     this->lastRefresh = QDateTime::currentDateTime().addDays(-1);
 }
 
 HuggleFeedProviderWiki::~HuggleFeedProviderWiki()
 {
-    while (this->editBuffer->count() > 0)
-    {
-        this->editBuffer->at(0)->DecRef();
-        this->editBuffer->removeAt(0);
-    }
-    delete this->editBuffer;
 }
 
 bool HuggleFeedProviderWiki::Start()
@@ -64,13 +54,14 @@ void HuggleFeedProviderWiki::Stop()
 
 bool HuggleFeedProviderWiki::ContainsEdit()
 {
-    if (this->editBuffer->isEmpty())
+    // finish the request that is running, if there is any
+    if (this->isRefreshing)
+        this->Refresh();
+    if (!HuggleFeed::ContainsEdit())
     {
-        if (this->lastRefresh.addSecs(6) < QDateTime::currentDateTime())
-        {
+        // if last request hit the limit there are more changes waiting for us, so we don't wait
+        if (!this->isRefreshing && (this->hasMore || this->lastRefresh.addMSecs(this->pollInterval) < QDateTime::currentDateTime()))
             this->Refresh();
-            this->lastRefresh = QDateTime::currentDateTime();
-        }
         return false;
     }
     return true;
@@ -91,18 +82,38 @@ void HuggleFeedProviderWiki::Refresh()
             Huggle::Syslog::HuggleLogs->Log(_l("rc-error", this->qReload->GetFailureReason()));
             this->qReload = nullptr;
             this->isRefreshing = false;
+            this->hasMore = false;
             return;
         }
-        this->processData(qReload->Result->Data);
+        this->processData(qReload->GetApiQueryResult()->Json, qReload->Result->Data);
         this->qReload = nullptr;
         this->isRefreshing = false;
         return;
     }
     this->isRefreshing = true;
+    this->lastRefresh = QDateTime::currentDateTime();
     this->qReload = new ApiQuery(ActionQuery, this->GetSite());
-    this->qReload->Parameters = "list=recentchanges&rcprop=" + QUrl::toPercentEncoding("user|userid|comment|flags|timestamp|title|ids|sizes|loginfo") +
-                                "&rclimit=" + QString::number(Configuration::HuggleConfiguration->SystemConfig_WikiRC);
+    this->qReload->RequestFormat = ApiQuery::JSON;
+    QString parameters = "list=recentchanges&formatversion=2&rcprop=" + QUrl::toPercentEncoding("user|userid|comment|flags|timestamp|title|ids|sizes|loginfo") +
+                         "&rclimit=" + QString::number(Configuration::HuggleConfiguration->SystemConfig_WikiRC);
+    // first request just fetches the latest changes, every other request only asks for changes since
+    // the newest one we have seen, oldest first, changes from that same second are returned again and
+    // filtered out by their rcid, so that we neither lose nor duplicate changes made in one second
+    this->isIncremental = !this->latestTimestamp.isEmpty();
+    if (this->isIncremental)
+    {
+        // if there were more changes than rclimit in one second, rcstart alone would return same changes again,
+        // so the list is continued from where the previous request ended
+        this->requestStart = this->continuation.isEmpty() ? this->latestTimestamp : this->continuationStart;
+        parameters += "&rcdir=newer&rcstart=" + QUrl::toPercentEncoding(this->requestStart);
+        if (!this->continuation.isEmpty())
+            parameters += "&rccontinue=" + QUrl::toPercentEncoding(this->continuation);
+    }
+    this->qReload->Parameters = parameters;
+    // more changes than rclimit are reported by query-continue, processData relies on that
+    this->qReload->IsContinuous = true;
     this->qReload->Target = "Recent changes refresh";
+    this->qReload->RequestPriority = ApiQuery::PriorityBackground;
     QueryPool::HugglePool->AppendQuery(this->qReload);
     this->qReload->Process();
 }
@@ -117,68 +128,65 @@ unsigned long long HuggleFeedProviderWiki::GetBytesSent()
     return 0;
 }
 
-WikiEdit *HuggleFeedProviderWiki::RetrieveEdit()
-{
-    if (this->editBuffer->empty())
-    {
-        return nullptr;
-    }
-    WikiEdit *edit = this->editBuffer->at(0);
-    this->editBuffer->removeAt(0);
-    return edit;
-}
-
 QString HuggleFeedProviderWiki::ToString()
 {
     return "Wiki";
 }
 
-void HuggleFeedProviderWiki::processData(const QString& data)
+void HuggleFeedProviderWiki::processData(const QJsonDocument &document, const QString& data)
 {
-    //QStringList lines = data.split("\n");
-    QDomDocument d;
-    d.setContent(data);
-    QDomNodeList l = d.elementsByTagName("rc");
-    int CurrentNode = l.count();
-    if (l.count() == 0)
+    QJsonObject root = document.object();
+    QJsonObject query = root.value("query").toObject();
+    if (!query.contains("recentchanges"))
     {
         Huggle::Syslog::HuggleLogs->Log("Error, wiki provider returned: " + data);
+        this->hasMore = false;
         return;
     }
-    // recursively scan all RC changes
-    QDateTime t = this->latestTime;
-    bool Changed = false;
-    while (CurrentNode > 0)
+    // if there is continuation there are more new changes than we requested, the query asks for raw continuation
+    // (query-continue), new style is checked too in case wiki ignores it; continuation of first request leads to
+    // older changes, which we don't want
+    this->continuation.clear();
+    if (this->isIncremental)
+    {
+        QJsonValue value = root.value("query-continue").toObject().value("recentchanges").toObject().value("rccontinue");
+        if (value.isUndefined())
+            value = root.value("continue").toObject().value("rccontinue");
+        this->continuation = value.toString();
+        this->continuationStart = this->requestStart;
+    }
+    QJsonArray changes = query.value("recentchanges").toArray();
+    int count = changes.count();
+    int new_changes = 0;
+    for (int i = 0; i < count; i++)
     {
-        CurrentNode--;
-        // get a time of rc change
-        QDomElement item = l.at(CurrentNode).toElement();
-        if (!item.attributes().contains("timestamp"))
+        // changes need to be processed from oldest to newest, first request returns them in opposite order
+        QJsonObject item = changes.at(this->isIncremental ? i : count - i - 1).toObject();
+        revid_ht rcid = static_cast<revid_ht>(item.value("rcid").toDouble());
+        if (rcid <= this->highestRcID)
         {
-            Huggle::Syslog::HuggleLogs->Log(_l("rc-timestamp-missing", item.toElement().nodeName()));
+            // we already know this change from previous request
             continue;
         }
-        QDateTime time = MediaWiki::FromMWTimestamp(item.attribute("timestamp"));
-        if (time < t)
+        this->highestRcID = rcid;
+        new_changes++;
+        if (!item.contains("timestamp"))
         {
-            // this record is older than latest parsed record, so we don't want to parse it
+            Huggle::Syslog::HuggleLogs->Log(_l("rc-timestamp-missing", QString(QJsonDocument(item).toJson(QJsonDocument::Compact))));
             continue;
-        } else
-        {
-            Changed = true;
-            t = time;
         }
-        if (!item.attributes().contains("type"))
+        this->latestTimestamp = item.value("timestamp").toString();
+        if (!item.contains("type"))
         {
-            Huggle::Syslog::HuggleLogs->Log(_l("rc-type-missing", item.text()));
+            Huggle::Syslog::HuggleLogs->Log(_l("rc-type-missing", QString(QJsonDocument(item).toJson(QJsonDocument::Compact))));
             continue;
         }
-        if (!item.attributes().contains("title"))
+        if (!item.contains("title"))
         {
-            Huggle::Syslog::HuggleLogs->Log(_l("rc-title-missing", item.text()));
+            Huggle::Syslog::HuggleLogs->Log(_l("rc-title-missing", QString(QJsonDocument(item).toJson(QJsonDocument::Compact))));
             continue;
         }
-        QString type = item.attribute("type");
+        QString type = item.value("type").toString();
         if (type == "edit" || type == "new")
         {
             processEdit(item);
@@ -188,64 +196,60 @@ void HuggleFeedProviderWiki::processData(const QString& data)
             processLog(item);
         }
     }
-    if (Changed)
-    {
-        this->latestTime = t.addSecs(1);
-    }
+    // if nothing new was returned, there is no reason to ask again right away
+    this->hasMore = !this->continuation.isEmpty() && new_changes > 0;
+    this->adjustInterval(new_changes);
 }
 
-void HuggleFeedProviderWiki::processEdit(const QDomElement& item)
+void HuggleFeedProviderWiki::processEdit(const QJsonObject& item)
 {
+    // we request formatversion=2 so that all flags are real booleans
     WikiEdit *edit = new WikiEdit();
-    edit->Page = new WikiPage(item.attribute("title"), this->GetSite());
-    QString type = item.attribute("type");
-    if (type == "new")
+    edit->Page = new WikiPage(item.value("title").toString(), this->GetSite());
+    if (item.value("type").toString() == "new")
         edit->NewPage = true;
-    if (item.attributes().contains("newlen") && item.attributes().contains("oldlen"))
-        edit->SetSize(item.attribute("newlen").toLong() - item.attribute("oldlen").toLong());
-    if (item.attributes().contains("user"))
+    if (item.contains("newlen") && item.contains("oldlen"))
+        edit->SetSize(static_cast<long>(item.value("newlen").toDouble() - item.value("oldlen").toDouble()));
+    if (item.contains("user"))
     {
-        edit->User = new WikiUser(item.attribute("user"), this->GetSite());
-        if (item.attributes().contains("anon"))
+        edit->User = new WikiUser(item.value("user").toString(), this->GetSite());
+        if (item.value("anon").toBool())
             edit->User->ForceIP();
     }
-    if (item.attributes().contains("comment"))
-        edit->Summary = item.attribute("comment");
-    if (item.attributes().contains("bot"))
-        edit->Bot = true;
-    if (item.attributes().contains("revid"))
+    if (item.contains("comment"))
+        edit->Summary = item.value("comment").toString();
+    edit->Bot = item.value("bot").toBool();
+    if (item.contains("revid"))
     {
-        edit->RevID = QString(item.attribute("revid")).toInt();
+        edit->RevID = static_cast<revid_ht>(item.value("revid").toDouble());
         if (!edit->RevID)
             edit->RevID = WIKI_UNKNOWN_REVID;
-
     }
-    if (item.attributes().contains("minor"))
-        edit->IsMinor = true;
+    if (item.contains("old_revid"))
+        edit->OldID = static_cast<revid_ht>(item.value("old_revid").toDouble());
+    edit->IsMinor = item.value("minor").toBool();
     edit->IncRef();
-    this->insertEdit(edit);
+    this->InsertEdit(edit);
 }
 
-void HuggleFeedProviderWiki::processLog(const QDomElement& item)
+void HuggleFeedProviderWiki::processLog(const QJsonObject& item)
 {
     /*
      * this function doesn't check if every attribute is present (unlike ProcessEdit())
      *
      * needs loginfo in rcprop at apiquery
      */
-    QString logtype = item.attribute("logtype");
-    QString logaction = item.attribute("logaction");
+    QString logtype = item.value("logtype").toString();
+    QString logaction = item.value("logaction").toString();
 
     if (logtype == "block" && (logaction == "block" || logaction == "reblock"))
     {
-        QString admin = item.attribute("user");
-        QString blockeduser = item.attribute("title"); // including User-namespaceprefix
-        QString reason = item.attribute("comment");
+        QString admin = item.value("user").toString();
+        QString blockeduser = item.value("title").toString(); // including User-namespaceprefix
+        QString reason = item.value("comment").toString();
         if (logaction == "block" || logaction == "reblock")
         {
-            QDomElement blockinfo = item.elementsByTagName("block").at(0).toElement(); // nested element "block"
-            //QString flags = blockinfo.attribute("flags");
-            QString duration = blockinfo.attribute("duration");
+            QString duration = item.value("logparams").toObject().value("duration").toString();
             HUGGLE_DEBUG("RC Feed: ProcessLog: " + blockeduser + " was blocked by " + admin +
                           " for the duration \"" + duration + "\": " + reason, 1);
         }
@@ -257,32 +261,35 @@ void HuggleFeedProviderWiki::processLog(const QDomElement& item)
     }
     else if (logtype == "delete")
     {
-        QString page = item.attribute("title");
-        QString admin = item.attribute("user");
-        QString reason = item.attribute("comment");
+        QString page = item.value("title").toString();
+        QString admin = item.value("user").toString();
+        QString reason = item.value("comment").toString();
         HUGGLE_DEBUG("RC Feed: ProcessLog: page \"" + page + "\" was deleted by " + admin + ": " + reason, 1);
         // TODO: process page deletes further (e.g. remove page from queue)
     }
 }
 
-void HuggleFeedProviderWiki::insertEdit(WikiEdit *edit)
+void HuggleFeedProviderWiki::adjustInterval(int changes)
 {
-    this->IncrementEdits();
-    QueryPool::HugglePool->PreProcessEdit(edit);
-    if (edit->GetSite()->CurrentFilter->Matches(edit) && Hooks::EditBeforePreProcess(edit))
+    QDateTime now = QDateTime::currentDateTime();
+    qint64 elapsed = this->lastProcessed.isValid() ? this->lastProcessed.msecsTo(now) : 0;
+    this->lastProcessed = now;
+    // first request returns a backlog of changes, so it says nothing about the rate
+    if (!this->isIncremental || elapsed <= 0)
+        return;
+    // moving average of changes per second, so that a single burst doesn't change the interval too much
+    this->editRate = (this->editRate * 0.7) + ((changes * 1000.0 / elapsed) * 0.3);
+    if (this->editRate < 0.01)
     {
-        if (this->editBuffer->size() > Configuration::HuggleConfiguration->SystemConfig_ProviderCache)
-        {
-            while (this->editBuffer->size() > (Configuration::HuggleConfiguration->SystemConfig_ProviderCache - 10))
-            {
-                this->editBuffer->at(0)->DecRef();
-                this->editBuffer->removeAt(0);
-            }
-            Huggle::Syslog::HuggleLogs->WarningLog("insufficient space in wiki cache, increase ProviderCache size, otherwise you will be losing edits");
-        }
-        this->editBuffer->append(edit);
+        this->pollInterval = HUGGLE_WIKI_RC_MAX_INTERVAL;
     } else
     {
-        edit->DecRef();
+        // we want to receive roughly a quarter of rclimit in each request, so that even larger bursts
+        // fit in one request and we don't need to use continuation
+        double interval = (Configuration::HuggleConfiguration->SystemConfig_WikiRC / 4.0) / this->editRate * 1000;
+        this->pollInterval = qBound(static_cast<qint64>(HUGGLE_WIKI_RC_MIN_INTERVAL), static_cast<qint64>(interval),
+                                    static_cast<qint64>(HUGGLE_WIKI_RC_MAX_INTERVAL));
     }
+    HUGGLE_DEBUG("Wiki provider: " + QString::number(this->editRate) + " changes per second, next poll in " +
+                 QString::number(this->pollInterval) + "ms", 4);
 }
@@ -14,7 +14,7 @@
 #include "definitions.hpp"
 
 #include <QList>
-#include <QDomElement>
+#include <QJsonObject>
 #include <QStringList>
 #include <QString>
 #include <QDateTime>
@@ -23,12 +23,22 @@
 #include "wikiedit.hpp"
 #include "hugglefeed.hpp"
 
+// Bounds of the interval between two polls of recent changes in milliseconds, actual interval
+// is adapted to rate of edits on the wiki
+#define HUGGLE_WIKI_RC_MIN_INTERVAL         2000
+#define HUGGLE_WIKI_RC_MAX_INTERVAL         30000
+#define HUGGLE_WIKI_RC_DEFAULT_INTERVAL     6000
+
 namespace Huggle
 {
     class ApiQuery;
     class WikiEdit;
 
-    //! This is a very simple provider of changes that basically refresh recent changes every 6 seconds
+    //! This is a very simple provider of changes that periodically polls recent changes of a wiki
+
+    //! Only changes newer than the last one we have seen are requested (using rcstart and rcdir=newer),
+    //! changes from the same second are deduplicated using rcid, and the poll interval is adapted to
+    //! the rate of edits on the wiki, so that we don't download same data over and over again.
     class HUGGLE_EX_CORE HuggleFeedProviderWiki : public HuggleFeed
     {
         public:
@@ -47,19 +57,33 @@ namespace Huggle
             void Refresh();
             unsigned long long GetBytesReceived() override;
             unsigned long long GetBytesSent() override;
-            WikiEdit *RetrieveEdit() override;
             QString ToString() override;
         private:
-            void processData(const QString& data);
-            void processEdit(const QDomElement& item);
-            void processLog(const QDomElement& item);
-            void insertEdit(WikiEdit *edit);
+            void processData(const QJsonDocument &document, const QString& data);
+            void processEdit(const QJsonObject& item);
+            void processLog(const QJsonObject& item);
+            void adjustInterval(int changes);
             bool isPaused = false;
             bool isRefreshing;
-            QList<WikiEdit*> *editBuffer;
+            //! Whether current request is fetching changes newer than the last one we know
+            bool isIncremental = false;
+            //! Last request didn't return all changes, so that we need to fetch more right away
+            bool hasMore = false;
             Collectable_SmartPtr<ApiQuery> qReload;
             QDateTime lastRefresh;
-            QDateTime latestTime;
+            QDateTime lastProcessed;
+            //! Timestamp of newest change we know of, used as rcstart for next request
+            QString latestTimestamp;
+            //! rcstart of current request
+            QString requestStart;
+            //! Continuation returned by last request, next request continues from it with the same rcstart
+            QString continuation;
+            QString continuationStart;
+            //! Highest rcid we have processed, changes with lower or same rcid are already known
+            revid_ht highestRcID = 0;
+            qint64 pollInterval = HUGGLE_WIKI_RC_DEFAULT_INTERVAL;
+            //! Average number of changes per second
+            double editRate = 0;
     };
 
     inline bool HuggleFeedProviderWiki::IsPaused()
@@ -10,18 +10,16 @@
 
 #include "configuration.hpp"
 #include "hugglefeedproviderxml.hpp"
+#include "hugglefeedproviderreplay.hpp"
 #include "apiquery.hpp"
 #include "querypool.hpp"
 #include "exception.hpp"
-#include "hugglequeuefilter.hpp"
 #include "generic.hpp"
 #include "wikipage.hpp"
-#include "hooks.hpp"
 #include "syslog.hpp"
 #include "wikiedit.hpp"
 #include "wikiuser.hpp"
 #include "wikisite.hpp"
-#include <QtXml>
 
 using namespace Huggle;
 
@@ -36,11 +34,6 @@ HuggleFeedProviderXml::~HuggleFeedProviderXml()
 {
     this->Stop();
     delete this->pinger;
-    while (this->buffer.count() > 0)
-    {
-        this->buffer.at(0)->DecRef();
-        this->buffer.removeAt(0);
-    }
     if (this->networkSocket && this->networkSocket->isOpen())
         this->networkSocket->close();
     delete this->networkSocket;
@@ -62,6 +55,8 @@ bool HuggleFeedProviderXml::Start()
         return false;
     }
     delete this->networkSocket;
+    // drop unfinished line that might have remained from previous connection
+    this->parser.Clear();
     this->networkSocket = new QTcpSocket();
     connect(this->networkSocket, SIGNAL(readyRead()), this, SLOT(OnReceive()));
     connect(this->networkSocket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(OnError(QAbstractSocket::SocketError)));
@@ -120,11 +115,6 @@ void HuggleFeedProviderXml::Stop()
     this->isPaused = false;
 }
 
-bool HuggleFeedProviderXml::ContainsEdit()
-{
-    return this->buffer.count() > 0;
-}
-
 QString HuggleFeedProviderXml::GetError()
 {
     return this->lastError;
@@ -140,16 +130,6 @@ unsigned long long HuggleFeedProviderXml::GetBytesSent()
     return this->bytesSent;
 }
 
-WikiEdit *HuggleFeedProviderXml::RetrieveEdit()
-{
-    if (this->buffer.empty())
-        return nullptr;
-
-    WikiEdit *edit = this->buffer.at(0);
-    this->buffer.removeAt(0);
-    return edit;
-}
-
 QString HuggleFeedProviderXml::ToString()
 {
     return "XMLRCS";
@@ -168,36 +148,18 @@ void HuggleFeedProviderXml::OnReceive()
     if (!this->networkSocket)
         throw new Huggle::NullPointerException("this->NetworkSocket", BOOST_CURRENT_FUNCTION);
     QByteArray incoming_data = this->networkSocket->readAll();
-    QString data(incoming_data);
     // when there is no data we can quit this
-    if (data.isEmpty())
+    if (incoming_data.isEmpty())
         return;
 
     this->bytesRcvd += static_cast<unsigned long long>(incoming_data.length());
-
-    if (!this->bufferedPart.isEmpty())
-        data = this->bufferedPart + data;
-
-    if (data.contains("\n"))
+    this->parser.Append(incoming_data);
+    QByteArray line;
+    while (this->parser.NextLine(&line))
     {
-        this->bufferedPart.clear();
-        if (data.endsWith("\n"))
-        {
-            // we received whole block of lines
-            this->bufferedLines = data.split("\n");
-        } else
-        {
-            QStringList lines = data.split("\n");
-            // last line is has not yet finished
-            this->bufferedPart = lines.last();
-            lines.removeLast();
-            this->bufferedLines = lines;
-        }
-        this->processBufs();
-        return;
+        HuggleFeedRecorder::RecordLine(HUGGLE_FEED_RECORD_XMLRCS, this->GetSite(), line);
+        this->processLine(line);
     }
-
-    this->bufferedPart = data;
 }
 
 void HuggleFeedProviderXml::OnConnect()
@@ -220,141 +182,155 @@ void HuggleFeedProviderXml::write(const QString& text)
     this->networkSocket->write(outgoing_data);
 }
 
-void HuggleFeedProviderXml::insertEdit(WikiEdit *edit)
+void HuggleFeedProviderXml::processLine(const QByteArray &line)
 {
-    if (edit == nullptr)
-        throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
-
-    // Increase the number of edits that were made since provider is up, this is used for statistics
-    this->IncrementEdits();
-    // We need to pre process edit so that we have all its properties ready for queue filter
-    QueryPool::HugglePool->PreProcessEdit(edit);
-    // We only insert it to buffer in case that current filter matches the edit, this is probably not needed
-    // but it might be a performance improvement at some point
-    if (edit->GetSite()->CurrentFilter->Matches(edit) && Hooks::EditBeforePreProcess(edit))
+    if (line.isEmpty())
+        return;
+    // this should be an XML string, let's do some quick test
+    if (!line.startsWith('<'))
     {
-        if (this->buffer.size() > hcfg->SystemConfig_ProviderCache)
-        {
-            // If the buffer is full we need to remove 10 oldest edits
-            // we also show a warning to user
-            while (this->buffer.size() > (hcfg->SystemConfig_ProviderCache - 10))
-            {
-                this->buffer.at(0)->DecRef();
-                this->buffer.removeAt(0);
-            }
-            if (!this->IsPaused())
-                Huggle::Syslog::HuggleLogs->WarningLog("insufficient space in xml cache, increase ProviderCache size, otherwise you will be losing edits");
-        }
-        this->buffer.append(edit);
-    } else
+        Syslog::HuggleLogs->WarningLog("Invalid input from XmlRcs server: " + QString::fromUtf8(line));
+        return;
+    }
+
+    // every message will update last time
+    this->lastPong = QDateTime::currentDateTime();
+    if (!this->parser.Parse(line))
     {
-        edit->DecRef();
+        Syslog::HuggleLogs->WarningLog("Invalid Xml from RC feed: " + QString::fromUtf8(line));
+        return;
+    }
+    const QString &name = this->parser.Name;
+    if (name == "error")
+    {
+        Syslog::HuggleLogs->ErrorLog("XmlRcs returned error: " + this->parser.Text);
+        return;
+    }
+    if (name == "ping")
+    {
+        this->write("pong");
+        return;
     }
-}
 
-void HuggleFeedProviderXml::processBufs()
-{
-    while (!this->bufferedLines.isEmpty())
+    if (name == "fatal")
     {
-        QString data = this->bufferedLines.at(0);
-        this->bufferedLines.removeAt(0);
-        if (data.isEmpty())
-            continue;
-        // this should be an XML string, let's do some quick test
-        if (!data.startsWith("<"))
-        {
-            Syslog::HuggleLogs->WarningLog("Invalid input from XmlRcs server: " + data);
-            continue;
-        }
+        Syslog::HuggleLogs->ErrorLog("XmlRcs failed: " + this->parser.Text);
+        this->Stop();
+        return;
+    }
 
-        // every message will update last time
-        this->lastPong = QDateTime::currentDateTime();
-        QDomDocument input;
-        input.setContent(data);
-        QDomElement element = input.firstChild().toElement();
-        QDateTime ts;
-        QString name = element.nodeName();
-        if (name == "error")
-        {
-            Syslog::HuggleLogs->ErrorLog("XmlRcs returned error: " + element.text());
-            continue;
-        }
-        if (name == "ping")
-        {
-            this->write("pong");
-            continue;
-        }
+    if (name == "ok" || name == "pong")
+        return;
+    if (name != "edit")
+    {
+        HUGGLE_DEBUG1("Weird result from xml provider: " + QString::fromUtf8(line));
+        return;
+    }
 
-        if (name == "fatal")
-        {
-            Syslog::HuggleLogs->ErrorLog("XmlRcs failed: " + element.text());
-            this->Stop();
-            continue;
-        }
+    if (this->IsPaused())
+        return;
 
-        if (name == "ok" || name == "pong")
-            continue;
-        if (name != "edit")
-        {
-            HUGGLE_DEBUG1("Weird result from xml provider: " + data);
-            continue;
-        }
+    WikiEdit *edit = this->parser.CreateEdit(this->GetSite(), line);
+    if (edit)
+        this->InsertEdit(edit);
+}
 
-        if (this->IsPaused())
-            continue;
+WikiEdit *XmlRcsParser::CreateEdit(WikiSite *site, const QByteArray &line)
+{
+    if (!this->Attributes.hasAttribute("type"))
+    {
+        Syslog::HuggleLogs->WarningLog("Invalid Xml from RC feed: " + QString::fromUtf8(line));
+        return nullptr;
+    }
 
-        WikiEdit *edit;
-        QString type;
+    QStringRef type = this->Attributes.value("type");
+    if (type != "edit" && type != "new")
+    {
+        // we are not interested in this, log events don't have all attributes of an edit
+        return nullptr;
+    }
 
-        if (!element.attributes().contains("type"))
-            goto invalid;
+    // let's verify if all necessary elements are present
+    if (!this->Attributes.hasAttribute("server_name") ||
+        !this->Attributes.hasAttribute("revid") ||
+        !this->Attributes.hasAttribute("title") ||
+        !this->Attributes.hasAttribute("user"))
+    {
+        Syslog::HuggleLogs->WarningLog("Invalid Xml from RC feed: " + QString::fromUtf8(line));
+        return nullptr;
+    }
 
-        type = element.attribute("type");
-        if (type != "edit" && type != "new")
-        {
-            // we are not interested in this
-            continue;
-        }
+    // if server name doesn't match we drop edit
+    if (this->Attributes.value("server_name") != site->XmlRcsName)
+    {
+        HUGGLE_DEBUG1("Invalid server: " + site->XmlRcsName + " isn't " + this->Attributes.value("server_name").toString());
+        return nullptr;
+    }
 
-        // let's verify if all necessary elements are present
-        if (!element.attributes().contains("server_name") ||
-            !element.attributes().contains("revid") ||
-            !element.attributes().contains("type") ||
-            !element.attributes().contains("title") ||
-            !element.attributes().contains("user"))
-        {
-            goto invalid;
-        }
+    // now we can create an edit
+    WikiEdit *edit = new WikiEdit();
+    edit->Page = new WikiPage(this->Attributes.value("title").toString(), site);
+    edit->IncRef();
+    edit->Bot = Generic::SafeBool(this->Attributes.value("bot").toString());
+    edit->NewPage = (type == "new");
+    edit->IsMinor = Generic::SafeBool(this->Attributes.value("minor").toString());
+    edit->RevID = this->Attributes.value("revid").toLongLong();
+    edit->User = new WikiUser(this->Attributes.value("user").toString(), site);
+    edit->Summary = this->Attributes.value("summary").toString();
+    if (this->Attributes.hasAttribute("length_new") && this->Attributes.hasAttribute("length_old"))
+    {
+        long size = this->Attributes.value("length_new").toLong() - this->Attributes.value("length_old").toLong();
+        edit->SetSize(size);
+    }
+    edit->OldID = this->Attributes.value("oldid").toLongLong();
+    return edit;
+}
 
-        // if server name doesn't match we drop edit
-        if (this->GetSite()->XmlRcsName != element.attribute("server_name"))
-        {
-            HUGGLE_DEBUG1("Invalid server: " + this->GetSite()->XmlRcsName + " isn't " + element.attribute("server_name"));
-            continue;
-        }
+void XmlRcsParser::Append(const QByteArray &data)
+{
+    this->buffer.append(data);
+}
 
-        // now we can create an edit
-        edit = new WikiEdit();
-        edit->Page = new WikiPage(element.attribute("title"), this->GetSite());
-        edit->IncRef();
-        edit->Bot = Generic::SafeBool(element.attribute("bot"));
-        edit->NewPage = (element.attribute("type") == "new");
-        edit->IsMinor = Generic::SafeBool(element.attribute("minor"));
-        edit->RevID = element.attribute("revid").toLong();
-        edit->User = new WikiUser(element.attribute("user"), this->GetSite());
-        edit->Summary = element.attribute("summary");
-        if (element.attributes().contains("length_new")
-               && element.attributes().contains("length_old"))
+bool XmlRcsParser::NextLine(QByteArray *line)
+{
+    int end = this->buffer.indexOf('\n', this->position);
+    if (end < 0)
+    {
+        // drop everything we already processed, so that only unfinished line remains in buffer,
+        // this is done once per received block rather than once per line
+        if (this->position > 0)
         {
-            long size = element.attribute("length_new").toLong() - element.attribute("length_old").toLong();
-            edit->SetSize(size);
+            this->buffer.remove(0, this->position);
+            this->position = 0;
         }
-        edit->OldID = element.attribute("oldid").toInt();
-        ts.setTime_t(element.attribute("timestamp").toUInt());
-        this->insertEdit(edit);
-        continue;
+        return false;
+    }
+    *line = this->buffer.mid(this->position, end - this->position);
+    this->position = end + 1;
+    return true;
+}
 
-        invalid:
-            Syslog::HuggleLogs->WarningLog("Invalid Xml from RC feed: " + data);
+bool XmlRcsParser::Parse(const QByteArray &line)
+{
+    this->Name.clear();
+    this->Text.clear();
+    this->reader.clear();
+    this->reader.addData(line);
+    if (!this->reader.readNextStartElement())
+    {
+        this->Attributes.clear();
+        return false;
     }
+    this->Name = this->reader.name().toString();
+    this->Attributes = this->reader.attributes();
+    if (this->Name == "error" || this->Name == "fatal")
+        this->Text = this->reader.readElementText();
+    return true;
+}
+
+void XmlRcsParser::Clear()
+{
+    this->buffer.clear();
+    this->position = 0;
+    this->reader.clear();
 }
@@ -20,10 +20,43 @@
 #include <QThread>
 #include <QDateTime>
 #include <QTcpSocket>
+#include <QXmlStreamReader>
 #include "hugglefeed.hpp"
 
 namespace Huggle
 {
+    //! Parser of messages sent by XmlRcs, every message is exactly one line
+
+    //! Lines are framed directly on received bytes and each of them is read using the same
+    //! QXmlStreamReader, so that we don't need to build a DOM tree or convert whole
+    //! buffer to UTF-16 just to read a few attributes of one element.
+    class HUGGLE_EX_CORE XmlRcsParser
+    {
+        public:
+            //! Append data received from network to internal buffer
+            void Append(const QByteArray &data);
+            //! Take next complete line from buffer, returns false if there is none yet
+            bool NextLine(QByteArray *line);
+            //! Parse a line, on success Name contains name of the element and Attributes its attributes
+            bool Parse(const QByteArray &line);
+            /*!
+             * \brief Create a new edit from last parsed line, in case it was an edit of given site
+             * \param site Site the edit must belong to
+             * \param line Parsed line, used for error messages only
+             * \return New edit with one reference that belongs to caller, or nullptr
+             */
+            WikiEdit *CreateEdit(WikiSite *site, const QByteArray &line);
+            void Clear();
+            QString Name;
+            //! Text of element, only filled in for error and fatal messages
+            QString Text;
+            QXmlStreamAttributes Attributes;
+        private:
+            QByteArray buffer;
+            int position = 0;
+            QXmlStreamReader reader;
+    };
+
     class HUGGLE_EX_CORE HuggleFeedProviderXml : public QObject, public HuggleFeed
     {
             Q_OBJECT
@@ -38,12 +71,10 @@ namespace Huggle
             bool IsWorking() override;
             void Stop() override;
             bool Restart() override { this->Stop(); return this->Start(); }
-            bool ContainsEdit() override;
             int FeedPriority() override { return 100; }
             QString GetError() override;
             unsigned long long GetBytesReceived() override;
             unsigned long long GetBytesSent() override;
-            WikiEdit *RetrieveEdit() override;
             QString ToString() override;
         private slots:
             void OnError(QAbstractSocket::SocketError er);
@@ -52,10 +83,8 @@ namespace Huggle
             void OnPing();
         protected:
             void write(const QString& text);
-            void insertEdit(WikiEdit *edit);
-            void processBufs();
-            QStringList bufferedLines;
-            QString bufferedPart;
+            void processLine(const QByteArray &line);
+            XmlRcsParser parser;
             QDateTime lastPong;
             QString lastError = "No error";
             bool isConnected = false;
@@ -63,7 +92,6 @@ namespace Huggle
             bool isWorking = false;
             unsigned long long bytesSent = 0;
             unsigned long long bytesRcvd = 0;
-            QList<WikiEdit*> buffer;
             QTcpSocket *networkSocket;
         private:
             QTimer *pinger;
@@ -202,145 +202,109 @@ QString HuggleParser::GetKeyFromSSItem(QString item)
     return item;
 }
 
-static int DateMark(const QString& page, WikiSite *site)
+static int DateMark(const QStringRef& page, WikiSite *site)
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
-    int m = 0;
     int position = 0;
-    QString mark = "";
-    while (m < site->GetProjectConfig()->Parser_Date_Suffix.count())
+    foreach (const QString &suffix, site->GetProjectConfig()->Parser_Date_Suffix)
     {
-        QString m_ = site->GetProjectConfig()->Parser_Date_Suffix.at(m);
-        if (page.contains(m_))
-        {
-            int mp = page.lastIndexOf(m_);
-            if (mp > position)
-            {
-                mark = m_;
-                position = mp;
-            }
-        }
-        m++;
+        int mp = page.lastIndexOf(suffix);
+        if (mp > position)
+            position = mp;
     }
     return position;
 }
 
+//! Returns date of last signature in a section, or invalid date if there is none
+static QDate SectionDate(const QStringRef& section, WikiSite *site)
+{
+    int dp = DateMark(section, site);
+    // we need to find a date in this section
+    if (!dp)
+        return QDate();
+    QStringRef signature = section.left(dp).trimmed();
+    const QString &prefix = site->GetProjectConfig()->Parser_Date_Prefix;
+    int prefix_position = signature.lastIndexOf(prefix);
+    if (prefix_position < 0)
+    {
+        // this is some borked date
+        return QDate();
+    }
+    // now we need this uberhack so that we can get a month name from localized version
+    // let's hope that month is a word in a middle of string
+    QStringRef time = signature.mid(prefix_position + prefix.length()).trimmed();
+    QVector<QStringRef> parts_time = time.split(' ');
+    if (parts_time.count() < 3)
+    {
+        // this is invalid string
+        HUGGLE_DEBUG("Unable to split month: " + time.toString(), 12);
+        return QDate();
+    }
+    QStringRef day = parts_time.at(0);
+    // e.g. dewiki's days end with dot
+    if (day.endsWith('.'))
+        day = day.left(day.length() - 1);
+    // on some wikis months have spaces in name, so the month is everything between day and year
+    const QStringRef &month_first = parts_time.at(1);
+    const QStringRef &month_last = parts_time.at(parts_time.count() - 2);
+    QString month_name = time.string()->mid(month_first.position(), month_last.position() + month_last.length() - month_first.position()).trimmed();
+    byte_ht month = HuggleParser::GetIDOfMonth(month_name, site);
+    if (month < 1 || month > 12)
+    {
+        HUGGLE_DEBUG("Invalid date: " + time.toString(), 1);
+        return QDate();
+    }
+    // let's create a new time string from converted one, just to make sure it will be parsed properly
+    QString date_string = day.toString() + " " + QString::number(month) + " " + parts_time.last().toString();
+    QDate date = QDate::fromString(date_string, "d M yyyy");
+    if (!date.isValid())
+        HUGGLE_DEBUG("Invalid date: " + date_string, 1);
+    return date;
+}
+
 byte_ht HuggleParser::GetLevel(QString page, QDate bt, WikiSite *site)
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    ProjectConfiguration *conf = site->GetProjectConfig();
     if (Configuration::HuggleConfiguration->SystemConfig_TrimOldWarnings)
     {
-        // we need to get rid of old warnings now
-        QStringList sections;
+        // we need to get rid of old warnings now, page is split to sections by empty lines
+        // and only sections which were signed recently are kept
         // windows fix
         page.replace("\r", "");
-        while (page.length() > 1)
+        QString recent;
+        recent.reserve(page.length());
+        int position = 0;
+        int length = page.length();
+        while (length - position > 1)
         {
-            while (page[0] == '\n')
-            {
-                // remove all leading extra lines on page
-                page = page.mid(1);
-            }
-            if (!page.contains("\n\n"))
-            {
-                // no sections
-                sections.append(page);
-                break;
-            }
-            // get to bottom of it
-            int bottom = 0;
-            bottom = page.indexOf("\n\n");
-            QString section = page.mid(0, bottom);
-            page = page.mid(bottom + 2);
-            sections.append(section);
-        }
-
-        // now we browse all sections and remove these with no current date
-        int CurrentIndex = 0;
-        page = "";
-        while (CurrentIndex < sections.count())
-        {
-            int dp = DateMark(sections.at(CurrentIndex), site);
-            // we need to find a date in this section
-            if (!dp)
-            {
-                // there is none
-                CurrentIndex++;
-                continue;
-            }
-            QString section = sections.at(CurrentIndex);
-            section = section.mid(0, dp).trimmed();
-            if (!section.contains(site->GetProjectConfig()->Parser_Date_Prefix))
+            // skip all leading extra lines
+            while (position < length && page.at(position) == '\n')
+                position++;
+            int bottom = page.indexOf("\n\n", position);
+            if (bottom < 0)
             {
-                // this is some borked date let's remove it
-                CurrentIndex++;
-                continue;
+                // no more sections
+                bottom = length;
             }
-            QString time = section.mid(section.lastIndexOf(site->GetProjectConfig()->Parser_Date_Prefix) + site->GetProjectConfig()->Parser_Date_Prefix.length());
-            // now we need this uberhack so that we can get a month name from localized version
-            // let's hope that month is a word in a middle of string
-            time = time.trimmed();
-            QString month_name = "";
-            QStringList parts_time = time.split(' ');
-            if (parts_time.count() < 3)
-            {
-                // this is invalid string
-                HUGGLE_DEBUG("Unable to split month: " + time, 12);
-                CurrentIndex++;
+            QStringRef section = page.midRef(position, bottom - position);
+            position = bottom + 2;
+            QDate date = SectionDate(section, site);
+            // now check if it's at least 1 month old
+            if (!date.isValid() || bt.addDays(conf->TemplateAge) > date)
                 continue;
-            }
-            QString day = parts_time.at(0);
-            // e.g. dewiki's days end with dot
-            if(day.endsWith('.'))
-                day = day.mid(0, day.length() - 1);
-            // on some wikis months have spaces in name
-            int i = 1;
-            while (i < parts_time.count() - 1)
-            {
-                month_name += parts_time.at(i) + " ";
-                i++;
-            }
-            month_name = month_name.trimmed();
-            byte_ht month = HuggleParser::GetIDOfMonth(month_name, site);
-
-             // let's create a new time string from converted one, just to make sure it will be parsed properly
-            if (month > 0)
-            {
-                time = day + " " + QString::number(month) + " " + parts_time.last();
-            } else
-            {
-                time = day + " " + parts_time.at(1); + " " + parts_time.last();
-            }
-            QDate date = QDate::fromString(time, "d M yyyy");
-            if (!date.isValid())
-            {
-                HUGGLE_DEBUG("Invalid date: " + time, 1);
-                CurrentIndex++;
-                continue;
-            } else
-            {
-                // now check if it's at least 1 month old
-                if (bt.addDays(site->ProjectConfig->TemplateAge) > date)
-                {
-                    // we don't want to parse this thing
-                    CurrentIndex++;
-                    continue;
-                }
-            }
-            page += sections.at(CurrentIndex) + "\n";
-            CurrentIndex++;
+            recent += section;
+            recent += '\n';
         }
+        page = recent;
     }
+    // all warning templates are searched for at once
+    QVector<unsigned char> hits = conf->WarningMatcher.Match(page);
     byte_ht level = 4;
     while (level > 0)
     {
-        foreach (QString df, site->ProjectConfig->WarningDefs)
-        {
-            if (HuggleParser::GetKeyFromSSItem(df).toInt() == level && page.contains(HuggleParser::GetValueFromSSItem(df)))
-            {
-                return level;
-            }
-        }
+        if (level < conf->WarningDefsLists.count() && conf->WarningMatcher.IsMatched(conf->WarningDefsLists.at(level), hits))
+            return level;
         level--;
     }
     return 0;
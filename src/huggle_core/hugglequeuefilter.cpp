@@ -17,6 +17,7 @@
 #include "wikiuser.hpp"
 #include "wikisite.hpp"
 #include "wikipage.hpp"
+#include "projectconfiguration.hpp"
 
 using namespace Huggle;
 
@@ -60,21 +61,55 @@ void HuggleQueueFilter::SetFilters()
         site->CurrentFilter = HuggleQueueFilter::GetFilter(site->GetUserConfig()->QueueID, site);
 }
 
+HuggleQueueFilterEdit::HuggleQueueFilterEdit(WikiEdit *edit)
+{
+    if (edit == nullptr)
+        throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
+
+    this->Namespace = edit->Page->GetNS()->GetID();
+    this->IgnoredPage = edit->GetSite()->GetProjectConfig()->IsIgnoredPage(edit->Page->PageName);
+    if (edit->Page->GetNS()->GetCanonicalName() == "User")
+        this->Features |= HuggleQueueFilterFeatureUserSpace;
+    if (edit->Page->IsTalk())
+        this->Features |= HuggleQueueFilterFeatureTalk;
+    if (edit->User->IsWhitelisted())
+        this->Features |= HuggleQueueFilterFeatureWL;
+    if (edit->TrustworthEdit)
+        this->Features |= HuggleQueueFilterFeatureFriend;
+    if (edit->User->IsIP())
+        this->Features |= HuggleQueueFilterFeatureIP;
+    if (edit->IsMinor)
+        this->Features |= HuggleQueueFilterFeatureMinor;
+    if (edit->IsRevert)
+        this->Features |= HuggleQueueFilterFeatureRevert;
+    if (edit->NewPage)
+        this->Features |= HuggleQueueFilterFeatureNewPage;
+    if (edit->Bot)
+        this->Features |= HuggleQueueFilterFeatureBot;
+    if (edit->User->Username.compare(hcfg->SystemConfig_UserName, Qt::CaseInsensitive) == 0)
+        this->Features |= HuggleQueueFilterFeatureSelf;
+    this->Known = ~static_cast<unsigned int>(HuggleQueueFilterFeatureWatched);
+    this->PostProcessed = edit->IsPostProcessed();
+    if (this->PostProcessed)
+    {
+        if (hcfg->SystemConfig_CatScansAndWatched)
+        {
+            this->CategoriesKnown = true;
+            this->Known |= HuggleQueueFilterFeatureWatched;
+            if (edit->Page->IsWatched())
+                this->Features |= HuggleQueueFilterFeatureWatched;
+            this->Categories = edit->Page->GetCategories().toSet();
+        }
+        this->Tags = edit->Tags.toSet();
+    }
+}
+
 HuggleQueueFilter::HuggleQueueFilter()
 {
     this->QueueName = "default";
-    this->Bots = HuggleQueueFilterMatchExclude;
-    this->WL = HuggleQueueFilterMatchExclude;
     this->ProjectSpecific = false;
-    this->Friends = HuggleQueueFilterMatchExclude;
-    this->IP = HuggleQueueFilterMatchIgnore;
-    this->Minor = HuggleQueueFilterMatchIgnore;
-    this->NewPages = HuggleQueueFilterMatchIgnore;
-    this->Self = HuggleQueueFilterMatchExclude;
-    this->Reverts = HuggleQueueFilterMatchIgnore;
-    this->TalkPage = HuggleQueueFilterMatchExclude;
-    this->UserSpace = HuggleQueueFilterMatchIgnore;
-    this->Watched = HuggleQueueFilterMatchIgnore;
+    this->excludeMask = HuggleQueueFilterFeatureBot | HuggleQueueFilterFeatureWL | HuggleQueueFilterFeatureFriend |
+                        HuggleQueueFilterFeatureSelf | HuggleQueueFilterFeatureTalk;
 }
 
 bool HuggleQueueFilter::Matches(WikiEdit *edit)
@@ -82,133 +117,45 @@ bool HuggleQueueFilter::Matches(WikiEdit *edit)
     if (edit == nullptr)
         throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
 
-    if (this->IgnoresNS(edit->Page->GetNS()->GetID()))
+    return this->Matches(HuggleQueueFilterEdit(edit));
+}
+
+bool HuggleQueueFilter::Matches(const HuggleQueueFilterEdit &edit) const
+{
+    if (edit.IgnoredPage)
         return false;
 
-    if (this->UserSpace != HuggleQueueFilterMatchIgnore)
-    {
-        if (this->UserSpace == HuggleQueueFilterMatchExclude && edit->Page->GetNS()->GetCanonicalName() == "User")
-            return false;
-        if (this->UserSpace == HuggleQueueFilterMatchRequire && edit->Page->GetNS()->GetCanonicalName() != "User")
-            return false;
-    }
-    if (this->TalkPage != HuggleQueueFilterMatchIgnore)
-    {
-        if (this->TalkPage == HuggleQueueFilterMatchExclude && edit->Page->IsTalk())
-            return false;
-        if (this->TalkPage == HuggleQueueFilterMatchRequire && !edit->Page->IsTalk())
-            return false;
-    }
-    int i = 0;
-    while (i < Configuration::HuggleConfiguration->ProjectConfig->IgnorePatterns.count())
-    {
-        if (edit->Page->PageName.contains(Configuration::HuggleConfiguration->ProjectConfig->IgnorePatterns.at(i)))
-            return false;
-        i++;
-    }
-    if (Configuration::HuggleConfiguration->ProjectConfig->Ignores.contains(edit->Page->PageName))
+    if (this->Namespaces.value(edit.Namespace, false))
         return false;
-    if (this->WL != HuggleQueueFilterMatchIgnore)
-    {
-        if (this->WL == HuggleQueueFilterMatchRequire && !edit->User->IsWhitelisted())
-            return false;
-        if (this->WL == HuggleQueueFilterMatchExclude && edit->User->IsWhitelisted())
-            return false;
-    }
-    if (this->Friends != HuggleQueueFilterMatchIgnore)
-    {
-        if (this->Friends == HuggleQueueFilterMatchExclude && edit->TrustworthEdit)
-            return false;
-        if (this->Friends == HuggleQueueFilterMatchRequire && !edit->TrustworthEdit)
-            return false;
-    }
-    if (this->IP != HuggleQueueFilterMatchIgnore)
-    {
-        if (this->IP == HuggleQueueFilterMatchExclude && edit->User->IsIP())
-            return false;
-        if (this->IP == HuggleQueueFilterMatchRequire && !edit->User->IsIP())
-            return false;
-    }
-    if (this->Minor != HuggleQueueFilterMatchIgnore)
-    {
-        if (this->Minor == HuggleQueueFilterMatchExclude && edit->IsMinor)
-            return false;
-        if (this->Minor == HuggleQueueFilterMatchRequire && !edit->IsMinor)
-            return false;
-    }
-    if (this->Reverts != HuggleQueueFilterMatchIgnore)
-    {
-        if (this->Reverts == HuggleQueueFilterMatchExclude && edit->IsRevert)
-            return false;
-        if (this->Reverts == HuggleQueueFilterMatchRequire && !edit->IsRevert)
-            return false;
-    }
-    if (this->NewPages != HuggleQueueFilterMatchIgnore)
-    {
-        if (edit->NewPage && this->NewPages == HuggleQueueFilterMatchExclude)
-            return false;
-        if (this->NewPages == HuggleQueueFilterMatchRequire && !edit->NewPage)
-            return false;
-    }
-    if (this->Bots != HuggleQueueFilterMatchIgnore)
-    {
-        if (edit->Bot && this->Bots == HuggleQueueFilterMatchExclude)
-            return false;
-        if (this->Bots == HuggleQueueFilterMatchRequire && !edit->Bot)
-            return false;
-    }
-    if (this->Self != HuggleQueueFilterMatchIgnore)
-    {
-        if (this->Self == HuggleQueueFilterMatchExclude && edit->User->Username.toLower() == Configuration::HuggleConfiguration->SystemConfig_UserName.toLower())
-            return false;
-        if (this->Self == HuggleQueueFilterMatchRequire && edit->User->Username.toLower() == Configuration::HuggleConfiguration->SystemConfig_UserName.toLower())
-            return false;
-    }
-    if (edit->IsPostProcessed())
-    {
-        if (hcfg->SystemConfig_CatScansAndWatched)
-        {
-            if (this->Watched != HuggleQueueFilterMatchIgnore)
-            {
-                if (this->Watched == HuggleQueueFilterMatchExclude && edit->Page->IsWatched())
-                    return false;
-                if (this->Watched == HuggleQueueFilterMatchRequire && !edit->Page->IsWatched())
-                    return false;
-            }
 
-            if (!edit->Page->GetCategories().isEmpty() && this->IgnoreCategories.count())
-            {
-                foreach (QString cat, edit->Page->GetCategories())
-                {
-                    if (this->IgnoreCategories.contains(cat))
-                        return false;
-                }
-            }
+    // features that aren't known yet are neither required nor excluded
+    unsigned int require = this->requireMask & edit.Known;
+    if ((edit.Features & require) != require)
+        return false;
+    if (edit.Features & this->excludeMask & edit.Known)
+        return false;
 
-            foreach (QString rc, this->RequireCategories)
-            {
-                if (!edit->Page->GetCategories().contains(rc))
-                    return false;
-            }
-        }
+    if (!edit.PostProcessed)
+        return true;
 
-        if (!edit->Tags.isEmpty() && this->IgnoreTags.count())
-        {
-            foreach (QString tag, edit->Tags)
-            {
-                if (this->IgnoreTags.contains(tag))
-                    return false;
-            }
-        }
-        if (this->RequireTags.count())
+    if (edit.CategoriesKnown)
+    {
+        if (edit.Categories.intersects(this->ignoreCategoriesSet))
+            return false;
+        foreach (QString rc, this->RequireCategories)
         {
-            foreach (QString tx, this->RequireTags)
-            {
-                if (!edit->Tags.contains(tx))
-                    return false;
-            }
+            if (!edit.Categories.contains(rc))
+                return false;
         }
     }
+
+    if (edit.Tags.intersects(this->ignoreTagsSet))
+        return false;
+    foreach (QString tx, this->RequireTags)
+    {
+        if (!edit.Tags.contains(tx))
+            return false;
+    }
     return true;
 }
 
@@ -235,6 +182,7 @@ QString HuggleQueueFilter::GetRequiredTags_CommaSeparated() const
 void HuggleQueueFilter::SetIgnoredTags_CommaSeparated(const QString &list)
 {
     this->IgnoreTags = Generic::CSV2QStringList(list);
+    this->ignoreTagsSet = this->IgnoreTags.toSet();
 }
 
 void HuggleQueueFilter::SetRequiredTags_CommaSeparated(const QString &list)
@@ -265,6 +213,7 @@ QString HuggleQueueFilter::GetRequiredCategories_CommaSeparated() const
 void HuggleQueueFilter::SetIgnoredCategories_CommaSeparated(const QString &list)
 {
     this->IgnoreCategories = Generic::CSV2QStringList(list);
+    this->ignoreCategoriesSet = this->IgnoreCategories.toSet();
 }
 
 void HuggleQueueFilter::SetRequiredCategories_CommaSeparated(const QString &list)
@@ -17,6 +17,7 @@
 #include <QString>
 #include <QHash>
 #include <QList>
+#include <QSet>
 //#include "mediawikiobject.hpp"
 
 namespace Huggle
@@ -31,9 +32,46 @@ namespace Huggle
         HuggleQueueFilterMatchExclude
     };
 
+    //! Properties of edit that filter can require or exclude, every one of them is a bit in a mask
+    enum HuggleQueueFilterFeature
+    {
+        HuggleQueueFilterFeatureMinor = 1,
+        HuggleQueueFilterFeatureWL = 2,
+        HuggleQueueFilterFeatureIP = 4,
+        HuggleQueueFilterFeatureRevert = 8,
+        HuggleQueueFilterFeatureBot = 16,
+        HuggleQueueFilterFeatureNewPage = 32,
+        HuggleQueueFilterFeatureFriend = 64,
+        HuggleQueueFilterFeatureSelf = 128,
+        HuggleQueueFilterFeatureUserSpace = 256,
+        HuggleQueueFilterFeatureTalk = 512,
+        HuggleQueueFilterFeatureWatched = 1024
+    };
+
     class WikiEdit;
     class WikiSite;
 
+    /*!
+     * \brief Everything filters need to know about an edit, it's computed once and then evaluated by any number of filters
+     */
+    class HUGGLE_EX_CORE HuggleQueueFilterEdit
+    {
+        public:
+            HuggleQueueFilterEdit(WikiEdit *edit);
+            //! Mask of HuggleQueueFilterFeature that edit has
+            unsigned int Features = 0;
+            //! Mask of HuggleQueueFilterFeature that are known, for example watched status is known only after post processing
+            unsigned int Known = 0;
+            //! Page is on ignore list of project
+            bool IgnoredPage = false;
+            int Namespace = 0;
+            //! Categories and tags are only known for post processed edits
+            bool PostProcessed = false;
+            bool CategoriesKnown = false;
+            QSet<QString> Categories;
+            QSet<QString> Tags;
+    };
+
     //! Filter that can be applied to edit queue
     class HUGGLE_EX_CORE HuggleQueueFilter// : public MediaWikiObject
     {
@@ -50,6 +88,8 @@ namespace Huggle
             //! Returns true if edit is ok for this filter (that means it is not filtered out)
             //! if this is false the edit should not be processed later
             bool Matches(WikiEdit *edit);
+            //! Same as Matches(WikiEdit*) but with features of edit that were already computed
+            bool Matches(const HuggleQueueFilterEdit &edit) const;
             //! Information if this filter is matching minor edits or not
             HuggleQueueFilterMatch getIgnoreMinor() const;
             //! Changes if this filter is matching minor edits or not
@@ -102,131 +142,148 @@ namespace Huggle
             void SetIgnoredCategories_CommaSeparated(const QString &list);
             void SetRequiredCategories_CommaSeparated(const QString &list);
         private:
+            HuggleQueueFilterMatch getMatch(HuggleQueueFilterFeature feature) const;
+            void setMatch(HuggleQueueFilterFeature feature, HuggleQueueFilterMatch value);
             QStringList IgnoreTags;
             QStringList RequireTags;
             QStringList IgnoreCategories;
             QStringList RequireCategories;
-            HuggleQueueFilterMatch Minor;
-            HuggleQueueFilterMatch WL;
-            HuggleQueueFilterMatch IP;
-            HuggleQueueFilterMatch Reverts;
-            HuggleQueueFilterMatch Bots;
-            HuggleQueueFilterMatch NewPages;
-            HuggleQueueFilterMatch Friends;
-            HuggleQueueFilterMatch Self;
-            HuggleQueueFilterMatch UserSpace;
-            HuggleQueueFilterMatch TalkPage;
-            HuggleQueueFilterMatch Watched;
+            //! Same as lists above, these are used for lookups
+            QSet<QString> ignoreTagsSet;
+            QSet<QString> ignoreCategoriesSet;
+            //! HuggleQueueFilterFeature that edit needs to have
+            unsigned int requireMask = 0;
+            //! HuggleQueueFilterFeature that edit must not have
+            unsigned int excludeMask = 0;
     };
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreMinor() const
     {
-        return this->Minor;
+        return this->getMatch(HuggleQueueFilterFeatureMinor);
     }
 
     inline void HuggleQueueFilter::setIgnoreMinor(HuggleQueueFilterMatch value)
     {
-        this->Minor = value;
+        this->setMatch(HuggleQueueFilterFeatureMinor, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreWL() const
     {
-        return this->WL;
+        return this->getMatch(HuggleQueueFilterFeatureWL);
     }
 
     inline void HuggleQueueFilter::setIgnoreWL(HuggleQueueFilterMatch value)
     {
-        this->WL = value;
+        this->setMatch(HuggleQueueFilterFeatureWL, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreIP() const
     {
-        return this->IP;
+        return this->getMatch(HuggleQueueFilterFeatureIP);
     }
 
     inline void HuggleQueueFilter::setIgnoreIP(HuggleQueueFilterMatch value)
     {
-        this->IP = value;
+        this->setMatch(HuggleQueueFilterFeatureIP, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreBots() const
     {
-        return this->Bots;
+        return this->getMatch(HuggleQueueFilterFeatureBot);
     }
 
     inline void HuggleQueueFilter::setIgnoreBots(HuggleQueueFilterMatch value)
     {
-        this->Bots = value;
+        this->setMatch(HuggleQueueFilterFeatureBot, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreNP() const
     {
-        return this->NewPages;
+        return this->getMatch(HuggleQueueFilterFeatureNewPage);
     }
 
     inline void HuggleQueueFilter::setIgnoreNP(HuggleQueueFilterMatch value)
     {
-        this->NewPages = value;
+        this->setMatch(HuggleQueueFilterFeatureNewPage, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreFriends() const
     {
-        return this->Friends;
+        return this->getMatch(HuggleQueueFilterFeatureFriend);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreReverts() const
     {
-        return this->Reverts;
+        return this->getMatch(HuggleQueueFilterFeatureRevert);
     }
 
     inline void HuggleQueueFilter::setIgnoreReverts(HuggleQueueFilterMatch value)
     {
-        this->Reverts = value;
+        this->setMatch(HuggleQueueFilterFeatureRevert, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnore_UserSpace() const
     {
-        return this->UserSpace;
+        return this->getMatch(HuggleQueueFilterFeatureUserSpace);
     }
 
     inline void HuggleQueueFilter::setIgnore_UserSpace(HuggleQueueFilterMatch value)
     {
-        this->UserSpace = value;
+        this->setMatch(HuggleQueueFilterFeatureUserSpace, value);
     }
 
     inline void HuggleQueueFilter::setIgnoreFriends(HuggleQueueFilterMatch value)
     {
-        this->Friends = value;
+        this->setMatch(HuggleQueueFilterFeatureFriend, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreSelf() const
     {
-        return this->Self;
+        return this->getMatch(HuggleQueueFilterFeatureSelf);
     }
 
     inline void HuggleQueueFilter::setIgnoreTalk(HuggleQueueFilterMatch value)
     {
-        this->TalkPage = value;
+        this->setMatch(HuggleQueueFilterFeatureTalk, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreTalk() const
     {
-        return this->TalkPage;
+        return this->getMatch(HuggleQueueFilterFeatureTalk);
     }
 
     inline void HuggleQueueFilter::setIgnoreSelf(HuggleQueueFilterMatch value)
     {
-        this->Self = value;
+        this->setMatch(HuggleQueueFilterFeatureSelf, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreWatched() const
     {
-        return this->Watched;
+        return this->getMatch(HuggleQueueFilterFeatureWatched);
     }
 
     inline void HuggleQueueFilter::setIgnoreWatched(HuggleQueueFilterMatch value)
     {
-        this->Watched = value;
+        this->setMatch(HuggleQueueFilterFeatureWatched, value);
+    }
+
+    inline HuggleQueueFilterMatch HuggleQueueFilter::getMatch(HuggleQueueFilterFeature feature) const
+    {
+        if (this->requireMask & feature)
+            return HuggleQueueFilterMatchRequire;
+        if (this->excludeMask & feature)
+            return HuggleQueueFilterMatchExclude;
+        return HuggleQueueFilterMatchIgnore;
+    }
+
+    inline void HuggleQueueFilter::setMatch(HuggleQueueFilterFeature feature, HuggleQueueFilterMatch value)
+    {
+        this->requireMask &= ~static_cast<unsigned int>(feature);
+        this->excludeMask &= ~static_cast<unsigned int>(feature);
+        if (value == HuggleQueueFilterMatchRequire)
+            this->requireMask |= feature;
+        else if (value == HuggleQueueFilterMatchExclude)
+            this->excludeMask |= feature;
     }
 
     inline bool HuggleQueueFilter::IsDefault() const
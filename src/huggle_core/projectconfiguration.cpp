@@ -107,6 +107,8 @@ QHash<QString, int> ProjectConfiguration::Yaml_FetchScoreTags(YAML::Node &node)
 
 ProjectConfiguration::ProjectConfiguration(const QString &project_name)
 {
+    // every entry is a revision of talk page that was parsed recently
+    this->warningLevelCache.setMaxCost(2000);
     // these headers are parsed by project config so don't change them
     // no matter if there is a nice function to retrieve them
     this->Months << "January"
@@ -449,13 +451,6 @@ bool ProjectConfiguration::Parse(const QString& config, QString *reason, WikiSit
         this->AlternativeMonths.insert(month_, QStringList());
         month_++;
     }
-    this->_revertPatterns.clear();
-    int xx = 0;
-    while (xx < this->RevertPatterns.count())
-    {
-        this->_revertPatterns.append(QRegExp(this->RevertPatterns.at(xx)));
-        xx++;
-    }
     if (!HuggleQueueFilter::Filters.contains(site))
     {
         HuggleQueueFilter::Filters.insert(site, new QList<HuggleQueueFilter*>());
@@ -476,6 +471,10 @@ bool ProjectConfiguration::Parse(const QString& config, QString *reason, WikiSit
     HuggleParser::ParseNoTalkPatterns(config, site);
     HuggleParser::ParseNoTalkWords(config, site);
     HuggleParser::ParseWords(config, site);
+    this->CompileScoreWords();
+    this->CompileWarningDefs();
+    this->CompileIgnores();
+    this->Summaries.Compile(this->RevertPatterns, this->Assisted, this->EditSuffixOfHuggle);
     delete this->UAAP;
     this->UAAP = new WikiPage(this->UAAPath, site);
     // templates
@@ -817,13 +816,6 @@ bool ProjectConfiguration::ParseYAML(const QString& yaml_src, QString *reason, W
     }
 
     this->RevertPatterns = HuggleParser::YAML2QStringList("revert-patterns", yaml);
-    this->_revertPatterns.clear();
-    int xx = 0;
-    while (xx < this->RevertPatterns.count())
-    {
-        this->_revertPatterns.append(QRegExp(this->RevertPatterns.at(xx)));
-        xx++;
-    }
     if (!HuggleQueueFilter::Filters.contains(site))
     {
         HuggleQueueFilter::Filters.insert(site, new QList<HuggleQueueFilter*>());
@@ -845,6 +837,10 @@ bool ProjectConfiguration::ParseYAML(const QString& yaml_src, QString *reason, W
     HuggleParser::ParseNoTalkPatterns_yaml(yaml, site);
     HuggleParser::ParseNoTalkWords_yaml(yaml, site);
     HuggleParser::ParseWords_yaml(yaml, site);
+    this->CompileScoreWords();
+    this->CompileWarningDefs();
+    this->CompileIgnores();
+    this->Summaries.Compile(this->RevertPatterns, this->Assisted, this->EditSuffixOfHuggle);
     if (this->UAAP != nullptr)
         delete this->UAAP;
     this->UAAP = new WikiPage(this->UAAPath, site);
@@ -888,6 +884,70 @@ QString ProjectConfiguration::GetConfig(QString key, QString dv)
     return value;
 }
 
+void ProjectConfiguration::CompileScoreWords()
+{
+    this->ScoreMatcher.Clear();
+    this->ScorePartsList = this->ScoreMatcher.AddList(this->ScoreParts, false);
+    this->ScoreWordsList = this->ScoreMatcher.AddList(this->ScoreWords, true);
+    this->NoTalkScorePartsList = this->ScoreMatcher.AddList(this->NoTalkScoreParts, false);
+    this->NoTalkScoreWordsList = this->ScoreMatcher.AddList(this->NoTalkScoreWords, true);
+    this->ScoreMatcher.Compile(hcfg->SystemConfig_WordSeparators);
+}
+
+void ProjectConfiguration::CompileWarningDefs()
+{
+    // levels are stored as score of words, which isn't used for anything here
+    QVector<QList<ScoreWord>> levels(5);
+    foreach (QString definition, this->WarningDefs)
+    {
+        int level = HuggleParser::GetKeyFromSSItem(definition).toInt();
+        if (level > 0 && level < levels.count())
+            levels[level].append(ScoreWord(HuggleParser::GetValueFromSSItem(definition), level));
+    }
+    this->WarningMatcher.Clear();
+    this->WarningDefsLists.clear();
+    foreach (QList<ScoreWord> level, levels)
+        this->WarningDefsLists.append(this->WarningMatcher.AddList(level, false));
+    this->WarningMatcher.Compile(QStringList());
+    this->warningLevelCacheLock.lock();
+    this->warningLevelCache.clear();
+    this->warningLevelCacheLock.unlock();
+}
+
+void ProjectConfiguration::CompileIgnores()
+{
+    this->ignoresSet = this->Ignores.toSet();
+    QList<ScoreWord> patterns;
+    foreach (QString pattern, this->IgnorePatterns)
+        patterns.append(ScoreWord(pattern, 0));
+    this->ignorePatternsMatcher.Clear();
+    this->ignorePatternsList = this->ignorePatternsMatcher.AddList(patterns, false);
+    this->ignorePatternsMatcher.Compile(QStringList());
+}
+
+bool ProjectConfiguration::IsIgnoredPage(const QString &page_name) const
+{
+    if (this->ignoresSet.contains(page_name))
+        return true;
+    return this->ignorePatternsMatcher.IsMatched(this->ignorePatternsList, this->ignorePatternsMatcher.Match(page_name));
+}
+
+bool ProjectConfiguration::GetCachedWarningLevel(const QString &key, byte_ht *level)
+{
+    QMutexLocker locker(&this->warningLevelCacheLock);
+    byte_ht *cached = this->warningLevelCache.object(key);
+    if (cached == nullptr)
+        return false;
+    *level = *cached;
+    return true;
+}
+
+void ProjectConfiguration::CacheWarningLevel(const QString &key, byte_ht level)
+{
+    QMutexLocker locker(&this->warningLevelCacheLock);
+    this->warningLevelCache.insert(key, new byte_ht(level));
+}
+
 void ProjectConfiguration::Sanitize()
 {
     if (this->ReportAIV.size() == 0)
@@ -17,8 +17,13 @@
 #include <QList>
 #include <QDateTime>
 #include <QStringList>
+#include <QCache>
 #include <QHash>
+#include <QMutex>
+#include <QSet>
 #include <QString>
+#include "scorewordmatcher.hpp"
+#include "summaryclassifier.hpp"
 
 // Private key names
 // these need to be stored in separate variables so that we can
@@ -99,6 +104,18 @@ namespace Huggle
             //! Parse all information from local config, this function is used in login
             bool Parse(const QString& config, QString *reason, WikiSite *site);
             bool ParseYAML(const QString& yaml_src, QString *reason, WikiSite *site);
+            //! Compile all lists of score words into ScoreMatcher, this needs to be called every time they are changed
+            void CompileScoreWords();
+            //! Compile WarningDefs into WarningMatcher, this needs to be called every time they are changed
+            void CompileWarningDefs();
+            //! Compile Ignores and IgnorePatterns for lookups, this needs to be called every time they are changed
+            void CompileIgnores();
+            //! Returns true if page is in Ignores or contains any of IgnorePatterns
+            bool IsIgnoredPage(const QString &page_name) const;
+            //! Look up warning level of a talk page that was parsed before, key identifies revision of talk page,
+            //! date and parser settings
+            bool GetCachedWarningLevel(const QString &key, byte_ht *level);
+            void CacheWarningLevel(const QString &key, byte_ht level);
             void RequestLogin();
             QString GetConfig(QString key, QString dv = "");
             //! \todo This needs to be later used as a default value for user config, however it's not being ensured
@@ -221,6 +238,10 @@ namespace Huggle
             //! Instant level - last warning messages supported
             bool            InstantWarnings = false;
             QStringList     WarningDefs;
+            //! WarningDefs compiled by CompileWarningDefs(), every level has its own list
+            ScoreWordMatcher WarningMatcher;
+            //! IDs of lists in WarningMatcher, indexed by warning level
+            QVector<int>    WarningDefsLists;
             //! Data of wl (list of users)
             QStringList     WhiteList;
             QStringList     NewWhitelist;
@@ -254,6 +275,13 @@ namespace Huggle
             QHash<int, score_ht>    ScoreLevel;
             QList<ScoreWord>        NoTalkScoreWords;
             QList<ScoreWord>        NoTalkScoreParts;
+            //! All score words and parts compiled for fast matching, see CompileScoreWords()
+            ScoreWordMatcher        ScoreMatcher;
+            //! IDs of lists of score words in ScoreMatcher
+            int                     ScorePartsList = -1;
+            int                     ScoreWordsList = -1;
+            int                     NoTalkScorePartsList = -1;
+            int                     NoTalkScoreWordsList = -1;
             score_ht                ScoreFlag = -60;
             score_ht                ForeignUser = 800;
             score_ht                ScoreTalk = -200;
@@ -281,8 +309,8 @@ namespace Huggle
             QHash<QString,QString>  TagsArgs;
             //! Where the welcome message is stored
             QString                 WelcomeMP = "Project:Huggle/Message";
-            // This is internal only do not prefix it!!
-            QList<QRegExp>          _revertPatterns;
+            //! Revert patterns, summaries of assisted tools and suffix of huggle compiled for classification of summaries
+            SummaryClassifier       Summaries;
             score_ht                BotScore = -200;
             score_ht                WarningScore = 2000;
             QStringList             WarningTypes;
@@ -308,6 +336,11 @@ namespace Huggle
             QHash<QString, QString> cache;
             // We keep the config cached here just in case we needed to ever access it later
             QString                 configurationBuffer;
+            QSet<QString>           ignoresSet;
+            ScoreWordMatcher        ignorePatternsMatcher;
+            int                     ignorePatternsList = -1;
+            QCache<QString, byte_ht> warningLevelCache;
+            QMutex                  warningLevelCacheLock;
             YAML::Node              *yaml_node = nullptr;
     };
 
@@ -12,6 +12,7 @@
 #include <QNetworkAccessManager>
 #include "exception.hpp"
 #include "gc.hpp"
+#include "querypool.hpp"
 #include "syslog.hpp"
 
 using namespace Huggle;
@@ -74,7 +75,7 @@ bool Query::IsProcessed()
 
         this->Kill();
         this->Result->SetError("Timed out");
-        this->status = StatusInError;
+        this->SetStatus(StatusInError);
         this->processFailure();
         return true;
     }
@@ -187,7 +188,7 @@ void Query::ThrowOnValidResult()
     if (!this->Result)
         return;
 
-    this->status = StatusInError;
+    this->SetStatus(StatusInError);
     throw new Huggle::Exception("Result was not NULL memory would leak: 0x" + QString::number(reinterpret_cast<uintptr_t>(this->Result), 16), BOOST_CURRENT_FUNCTION);
 }
 
@@ -198,7 +199,7 @@ void Query::Restart()
 
     delete this->Result;
     this->Result = nullptr;
-    this->status = StatusNull;
+    this->SetStatus(StatusNull);
     this->isRepeated = false;
     this->failureReason = "";
     this->Process();
@@ -206,7 +207,7 @@ void Query::Restart()
 
 void Query::Suspend(bool enqueue)
 {
-    this->status = StatusIsSuspended;
+    this->SetStatus(StatusIsSuspended);
     Collectable_SmartPtr<Query> query = this;
     if (enqueue)
         Query::PendingRestart.append(query);
@@ -223,4 +224,7 @@ qint64 Query::ExecutionTime()
 void Query::SetStatus(Query::Status state)
 {
     this->status = state;
+    // pool only looks at queries that told it something happened, so it must know about every change
+    if (QueryPool::HugglePool)
+        QueryPool::HugglePool->QueryChanged(this);
 }
@@ -85,6 +85,9 @@ namespace Huggle
             //! Returns true in case that query is processed which means that it's finished and it's not going to
             //! do anything on its own unless you restart it
             virtual bool IsProcessed();
+            //! Returns true if query only makes progress when IsProcessed() is called, QueryPool calls it on every tick
+            //! for such queries, other queries are only checked when they change their status or time out
+            virtual bool IsPolled() { return true; }
             //! Execute query
 
             //! This is a main() of every query, your implementation goes here
@@ -122,6 +125,7 @@ namespace Huggle
             //! Returns how long did it take to process this query
             qint64 ExecutionTime();
             Status GetStatus();
+            //! Change the status and let the QueryPool know about it, status must not be changed in any other way
             void SetStatus(Status state);
             //! Result of query, see documentation of QueryResult for more
             QueryResult *Result = nullptr;
@@ -12,11 +12,13 @@
 #include <QtXml>
 #include "configuration.hpp"
 #include "editquery.hpp"
+#include "editregistry.hpp"
 #include "editqueue.hpp"
 #include "exception.hpp"
 #include "apiqueryresult.hpp"
 #include "hugglefeed.hpp"
 #include "query.hpp"
+#include "queryscheduler.hpp"
 #include "hooks.hpp"
 #include "message.hpp"
 #include "syslog.hpp"
@@ -31,7 +33,7 @@ QueryPool *QueryPool::HugglePool = nullptr;
 
 QueryPool::QueryPool()
 {
-
+    this->Scheduler = new QueryScheduler();
 }
 
 QueryPool::~QueryPool()
@@ -51,27 +53,40 @@ QueryPool::~QueryPool()
         this->ProcessingEdits.at(0)->UnregisterConsumer(HUGGLECONSUMER_CORE_POSTPROCESS);
         this->ProcessingEdits.removeAt(0);
     }
-    while (this->PendingWatches.count())
-    {
-        this->PendingWatches.at(0)->UnregisterConsumer(HUGGLECONSUMER_QP_WATCHLIST);
-        this->PendingWatches.removeAt(0);
-    }
-    while(this->runningQueries.count() != 0)
-    {
-        this->runningQueries.at(0)->UnregisterConsumer(HUGGLECONSUMER_QP);
-        this->runningQueries.removeAt(0);
-    }
+    foreach (Query *query, this->PendingWatches)
+        query->UnregisterConsumer(HUGGLECONSUMER_QP_WATCHLIST);
+    this->PendingWatches.clear();
+    foreach (Query *query, this->runningQueries)
+        query->UnregisterConsumer(HUGGLECONSUMER_QP);
+    this->runningQueries.clear();
+    this->polledQueries.clear();
+    this->changedQueries.clear();
+    this->timeouts.clear();
+    this->timeoutOf.clear();
     while (this->UncheckedReverts.count() != 0)
     {
         this->UncheckedReverts.at(0)->UnregisterConsumer(HUGGLECONSUMER_QP_UNCHECKED);
         this->UncheckedReverts.removeAt(0);
     }
+    delete this->Scheduler;
 }
 
 void QueryPool::AppendQuery(Query *item)
 {
+    if (this->runningQueries.contains(item))
+        return;
     item->RegisterConsumer(HUGGLECONSUMER_QP);
-    this->runningQueries.append(item);
+    this->runningQueries.insert(item);
+    if (item->IsPolled())
+        this->polledQueries.insert(item);
+    // query might have changed its status before it was inserted, so we need to look at it at least once
+    this->changedQueries.insert(item);
+}
+
+void QueryPool::QueryChanged(Query *query)
+{
+    if (this->isTracked(query))
+        this->changedQueries.insert(query);
 }
 
 void QueryPool::PreProcessEdit(WikiEdit *edit)
@@ -87,20 +102,13 @@ void QueryPool::PreProcessEdit(WikiEdit *edit)
     if (edit->Bot)
         edit->User->SetBot(true);
 
-    edit->EditMadeByHuggle = edit->Summary.contains(hcfg->ProjectConfig->EditSuffixOfHuggle);
-
-    int x = 0;
-    while (x < Configuration::HuggleConfiguration->ProjectConfig->Assisted.count())
-    {
-        if (edit->Summary.contains(hcfg->ProjectConfig->Assisted.at(x)))
-        {
-            edit->TrustworthEdit = true;
-            break;
-        }
-        x++;
-    }
+    // summary is classified using rules of the site this edit belongs to
+    int summary_flags = edit->GetSite()->GetProjectConfig()->Summaries.Classify(edit->Summary);
+    edit->EditMadeByHuggle = (summary_flags & HUGGLE_SUMMARY_HUGGLE) != 0;
+    if (summary_flags & HUGGLE_SUMMARY_ASSISTED)
+        edit->TrustworthEdit = true;
 
-    if (WikiUtil::IsRevert(edit->Summary))
+    if (summary_flags & HUGGLE_SUMMARY_REVERT)
     {
         edit->IsRevert = true;
         if (edit->GetSite()->Provider != nullptr)
@@ -117,7 +125,9 @@ void QueryPool::PreProcessEdit(WikiEdit *edit)
         EditQueue::Primary->DeleteOlder(edit);
 
     edit->Status = StatusProcessed;
+    EditRegistry::Update(edit);
     Hooks::EditAfterPreProcess(edit);
+    edit->Latency.Mark(EditLatencyStage_PreProcessed);
 }
 
 void QueryPool::PostProcessEdit(WikiEdit *edit)
@@ -133,76 +143,141 @@ void QueryPool::PostProcessEdit(WikiEdit *edit)
 
 void QueryPool::CheckQueries()
 {
-    foreach (ApiQuery *query, this->PendingWatches)
+    // queries that didn't finish in time are killed or restarted by IsProcessed(), so that their status changes
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    while (!this->timeouts.isEmpty() && this->timeouts.firstKey() <= now)
     {
-        if (!query->IsProcessed())
+        Query *query = this->timeouts.first();
+        this->timeouts.erase(this->timeouts.begin());
+        this->timeoutOf.remove(query);
+        if (!this->isTracked(query))
             continue;
-        if (query->IsFailed())
+        if (query->IsProcessed())
+            this->changedQueries.insert(query);
+        else if (query->GetStatus() != Query::StatusIsSuspended)
+            this->watchTimeout(query);
+    }
+    QSet<Query*> changed;
+    changed.swap(this->changedQueries);
+    foreach (Query *query, changed)
+    {
+        // queries that were finished and forgotten while we were processing others might not exist anymore
+        if (this->PendingWatches.contains(query))
         {
-            // Get the error code and check what the reason for this error was
-            ApiQueryResultNode *error = query->GetApiQueryResult()->GetNode("error");
-            if (error != nullptr)
-            {
-                QString code = error->GetAttribute("code");
-                if (code == "badtoken")
-                {
-                    // We got logged out of mediawiki
-                    hcfg->Logout(query->GetSite());
-                    query->Suspend();
-                    continue;
-                }
-            }
-            Syslog::HuggleLogs->ErrorLog("Unable to (un)watchlist " + query->Target + " on " + query->GetSite()->Name + " because of: " + query->GetFailureReason());
-        } else
+            ApiQuery *watch = dynamic_cast<ApiQuery*>(query);
+            if (watch->IsProcessed())
+                this->finishWatch(watch);
+            else if (!watch->IsPolled())
+                this->watchTimeout(watch);
+        }
+        if (!this->runningQueries.contains(query))
+            continue;
+        if (query->IsProcessed())
         {
-            //! \todo The error checks should be implemented to make sure it really did this
-            if (query->GetAction() == ActionUnwatch)
-                Syslog::HuggleLogs->Log("Successfuly unwatchlisted " + query->Target);
+            this->finishQuery(query);
+            continue;
+        }
+        Hooks::QueryPool_Update(query);
+        if (!query->IsPolled())
+            this->watchTimeout(query);
+    }
+    // foreach works on a copy, so it's fine that finished queries are removed from the set
+    foreach (Query *query, this->polledQueries)
+    {
+        if (!this->polledQueries.contains(query))
+            continue;
+        if (query->IsProcessed())
+            this->finishQuery(query);
+        else
+            Hooks::QueryPool_Update(query);
+    }
+    if (!this->PendingMods.isEmpty())
+    {
+        // edit queries only make progress when they are polled, new ones may be appended while we do that
+        QList<EditQuery*> mods;
+        mods.swap(this->PendingMods);
+        foreach (EditQuery *query, mods)
+        {
+            if (query->IsProcessed())
+                query->UnregisterConsumer(HUGGLECONSUMER_QP_MODS);
             else
-                Syslog::HuggleLogs->Log("Successfuly watchlisted " + query->Target);
+                this->PendingMods.append(query);
         }
-        query->UnregisterConsumer(HUGGLECONSUMER_QP_WATCHLIST);
-        this->PendingWatches.removeAll(query);
     }
-    int curr = 0;
-    if (this->PendingMods.count() > 0)
+}
+
+void QueryPool::finishWatch(ApiQuery *query)
+{
+    if (query->IsFailed())
     {
-        while (curr < this->PendingMods.count())
+        // Get the error code and check what the reason for this error was
+        ApiQueryResultNode *error = query->GetApiQueryResult()->GetNode("error");
+        if (error != nullptr)
         {
-            if (this->PendingMods.at(curr)->IsProcessed())
-            {
-                EditQuery *e = this->PendingMods.at(curr);
-                this->PendingMods.removeAt(curr);
-                e->UnregisterConsumer(HUGGLECONSUMER_QP_MODS);
-            } else
+            QString code = error->GetAttribute("code");
+            if (code == "badtoken")
             {
-                curr++;
+                // We got logged out of mediawiki, query stays here until it's restarted after login
+                hcfg->Logout(query->GetSite());
+                query->Suspend();
+                return;
             }
         }
-    }
-    curr = 0;
-    if (this->runningQueries.count() < 1)
-        return;
-    while (curr < this->runningQueries.count())
+        Syslog::HuggleLogs->ErrorLog("Unable to (un)watchlist " + query->Target + " on " + query->GetSite()->Name + " because of: " + query->GetFailureReason());
+    } else
     {
-        Query *q = this->runningQueries.at(curr);
-        Hooks::QueryPool_Update(q);
-        if (q->IsProcessed())
-        {
+        //! \todo The error checks should be implemented to make sure it really did this
+        if (query->GetAction() == ActionUnwatch)
+            Syslog::HuggleLogs->Log("Successfuly unwatchlisted " + query->Target);
+        else
+            Syslog::HuggleLogs->Log("Successfuly watchlisted " + query->Target);
+    }
+    this->PendingWatches.remove(query);
+    this->forget(query);
+    query->UnregisterConsumer(HUGGLECONSUMER_QP_WATCHLIST);
+}
+
+void QueryPool::finishQuery(Query *query)
+{
 #ifdef HUGGLE_METRICS
-            this->registerQueryPerfTime(q);
+    this->registerQueryPerfTime(query);
 #endif
-            this->runningQueries.removeAt(curr);
-            // this is pretty spamy :o
-            HUGGLE_DEBUG("Query finished with: " + q->Result->Data, 8);
-            Hooks::QueryPool_Update(q);
-            Hooks::QueryPool_Remove(q);
-            q->UnregisterConsumer(HUGGLECONSUMER_QP);
-        } else
-        {
-            curr++;
-        }
-    }
+    this->runningQueries.remove(query);
+    this->polledQueries.remove(query);
+    this->forget(query);
+    // this is pretty spamy :o
+    HUGGLE_DEBUG("Query finished with: " + query->Result->Data, 8);
+    Hooks::QueryPool_Update(query);
+    Hooks::QueryPool_Remove(query);
+    query->UnregisterConsumer(HUGGLECONSUMER_QP);
+}
+
+void QueryPool::watchTimeout(Query *query)
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 time = query->StartTime.addSecs(query->Timeout).toMSecsSinceEpoch();
+    // query that is already late, but wasn't killed (for example because it didn't start yet), is checked again later
+    if (time <= now)
+        time = now + 1000;
+    // every query has only one entry, the latest deadline is the one that matters
+    if (this->timeoutOf.contains(query))
+        this->timeouts.remove(this->timeoutOf[query], query);
+    this->timeouts.insert(time, query);
+    this->timeoutOf.insert(query, time);
+}
+
+bool QueryPool::isTracked(Query *query)
+{
+    return this->runningQueries.contains(query) || this->PendingWatches.contains(query);
+}
+
+void QueryPool::forget(Query *query)
+{
+    if (this->isTracked(query))
+        return;
+    this->changedQueries.remove(query);
+    if (this->timeoutOf.contains(query))
+        this->timeouts.remove(this->timeoutOf.take(query), query);
 }
 
 int QueryPool::RunningQueriesGetCount()
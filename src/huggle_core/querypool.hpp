@@ -13,7 +13,10 @@
 
 #include "definitions.hpp"
 
+#include <QHash>
 #include <QList>
+#include <QMultiMap>
+#include <QSet>
 
 #define HUGGLE_QP_APPEND(id) if (Huggle::QueryPool::HugglePool)\
            { Huggle::QueryPool::HugglePool->AppendQuery(id); }
@@ -24,6 +27,7 @@ namespace Huggle
     class EditQuery;
     class Message;
     class ProcessList;
+    class QueryScheduler;
     class WikiEdit;
     class Query;
 
@@ -31,6 +35,9 @@ namespace Huggle
 
     //! Not every query is contained here, only these that are managed by something
     //! it's generally a good idea to insert every query to this pool
+    //!
+    //! Queries let the pool know when their status changes, so that on every tick only queries that changed, timed out
+    //! or need to be polled (see Query::IsPolled) are looked at, no matter how many of them are running
     class HUGGLE_EX_CORE QueryPool
     {
         public:
@@ -44,6 +51,8 @@ namespace Huggle
              * \param item Query that is about to be inserted to list of running queries
              */
             void AppendQuery(Query* item);
+            //! Called by query when its status changes, it's checked on next tick if it's watched by the pool
+            void QueryChanged(Query *query);
             void CheckQueries();
             //! Check the edit summary and similar in order to
             //! determine several edit attributes etc
@@ -68,14 +77,33 @@ namespace Huggle
             //! whole list needs to be checked and probed everytime once a while
             QList<WikiEdit*> ProcessingEdits;
             QList<WikiEdit*> UncheckedReverts;
-            QList<ApiQuery*> PendingWatches;
+            //! Watchlist queries, these are always api queries
+            QSet<Query*> PendingWatches;
+            //! Decides when api queries are sent, so that interactive queries don't wait behind prefetching
+            QueryScheduler *Scheduler;
         private:
 #ifdef HUGGLE_METRICS
             void registerQueryPerfTime(Query *item);
             QList<qint64> performanceInfo;
 #endif
-            //! List of all running queries
-            QList<Query*> runningQueries;
+            void finishWatch(ApiQuery *query);
+            void finishQuery(Query *query);
+            //! Remember when the query times out, so that it's checked even if it never changes its status
+            void watchTimeout(Query *query);
+            //! Query is either running or a pending watch, only such queries are guaranteed to exist
+            bool isTracked(Query *query);
+            //! Remove all references to query that is no longer tracked, it may be deleted by GC anytime after that
+            void forget(Query *query);
+            //! All running queries
+            QSet<Query*> runningQueries;
+            //! Running queries that need to be checked on every tick
+            QSet<Query*> polledQueries;
+            //! Queries that changed their status since last tick
+            QSet<Query*> changedQueries;
+            //! Queries by time (msecs since epoch) at which they time out
+            QMultiMap<qint64, Query*> timeouts;
+            //! Time at which each query in timeouts times out, so that its entry can be removed
+            QHash<Query*, qint64> timeoutOf;
     };
 }
 
@@ -0,0 +1,192 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "queryscheduler.hpp"
+#include <QDateTime>
+#include "configuration.hpp"
+#include "querypool.hpp"
+#include "wikisite.hpp"
+
+using namespace Huggle;
+
+QString QueryScheduler::PriorityToString(int priority)
+{
+    switch (priority)
+    {
+        case ApiQuery::PriorityInteractiveWrite:
+            return "write";
+        case ApiQuery::PriorityInteractiveRead:
+            return "read";
+        case ApiQuery::PriorityPrefetch:
+            return "prefetch";
+        case ApiQuery::PriorityBackground:
+            return "background";
+    }
+    return "unknown";
+}
+
+QueryScheduler::QueryScheduler()
+{
+    int priority = 0;
+    while (priority < HUGGLE_QUERY_PRIORITIES)
+    {
+        this->queued[priority] = 0;
+        this->sent[priority] = 0;
+        this->waitTotal[priority] = 0;
+        this->waitMax[priority] = 0;
+        priority++;
+    }
+}
+
+void QueryScheduler::Schedule(ApiQuery *query)
+{
+    int priority = query->GetPriority();
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    // queue of wiki is only nonempty when all its slots are taken, so query that gets a slot isn't overtaking anyone
+    if (priority == ApiQuery::PriorityInteractiveWrite || this->hasFreeSlot(query->GetSite()))
+    {
+        this->send(query, priority, now);
+        return;
+    }
+    Waiting waiting;
+    waiting.Query = query;
+    waiting.Since = now;
+    if (!this->queues[priority].contains(query->GetSite()))
+        this->turns[priority].append(query->GetSite());
+    this->queues[priority][query->GetSite()].enqueue(waiting);
+    this->queued[priority]++;
+    query->isQueued = true;
+}
+
+void QueryScheduler::Finished(ApiQuery *query)
+{
+    if (!query->isScheduled)
+        return;
+    query->isScheduled = false;
+    this->runningTotal--;
+    if (--this->running[query->GetSite()] <= 0)
+        this->running.remove(query->GetSite());
+    this->dispatch();
+}
+
+int QueryScheduler::GetQueued()
+{
+    int result = 0;
+    int priority = 0;
+    while (priority < HUGGLE_QUERY_PRIORITIES)
+        result += this->queued[priority++];
+    return result;
+}
+
+int QueryScheduler::GetQueued(int priority)
+{
+    if (priority < 0 || priority >= HUGGLE_QUERY_PRIORITIES)
+        return 0;
+    return this->queued[priority];
+}
+
+int QueryScheduler::GetRunning()
+{
+    return this->runningTotal;
+}
+
+unsigned long QueryScheduler::GetSent(int priority)
+{
+    if (priority < 0 || priority >= HUGGLE_QUERY_PRIORITIES)
+        return 0;
+    return this->sent[priority];
+}
+
+double QueryScheduler::GetAverageWaitTime(int priority)
+{
+    if (priority < 0 || priority >= HUGGLE_QUERY_PRIORITIES || this->sent[priority] == 0)
+        return 0;
+    return static_cast<double>(this->waitTotal[priority]) / this->sent[priority];
+}
+
+double QueryScheduler::GetMaxWaitTime(int priority)
+{
+    if (priority < 0 || priority >= HUGGLE_QUERY_PRIORITIES)
+        return 0;
+    return static_cast<double>(this->waitMax[priority]);
+}
+
+QString QueryScheduler::ToString()
+{
+    QStringList parts;
+    int priority = 0;
+    while (priority < HUGGLE_QUERY_PRIORITIES)
+    {
+        parts << QueryScheduler::PriorityToString(priority) + ": " + QString::number(this->GetQueued(priority)) + " queued, wait " +
+                 QString::number(this->GetAverageWaitTime(priority), 'f', 0) + "ms (max " + QString::number(this->GetMaxWaitTime(priority), 'f', 0) + "ms)";
+        priority++;
+    }
+    return "Running: " + QString::number(this->runningTotal) + " " + parts.join(", ");
+}
+
+bool QueryScheduler::hasFreeSlot(WikiSite *site)
+{
+    if (hcfg->SystemConfig_QueriesPerSite <= 0)
+        return true;
+    return this->running.value(site, 0) < hcfg->SystemConfig_QueriesPerSite;
+}
+
+void QueryScheduler::dispatch()
+{
+    int priority = 0;
+    while (priority < HUGGLE_QUERY_PRIORITIES)
+    {
+        QList<WikiSite*> &turns = this->turns[priority];
+        int full = 0;
+        // every wiki with free slot gets one query in its turn, until they are all full or have nothing left
+        while (full < turns.count())
+        {
+            WikiSite *site = turns.takeFirst();
+            if (!this->hasFreeSlot(site))
+            {
+                turns.append(site);
+                full++;
+                continue;
+            }
+            full = 0;
+            QQueue<Waiting> &queue = this->queues[priority][site];
+            Waiting waiting = queue.dequeue();
+            this->queued[priority]--;
+            if (queue.isEmpty())
+                this->queues[priority].remove(site);
+            else
+                turns.append(site);
+            // queries that were killed while they were waiting are just dropped
+            if (waiting.Query.isNull() || waiting.Query->GetStatus() != Query::StatusProcessing)
+                continue;
+            this->send(waiting.Query, priority, waiting.Since);
+        }
+        priority++;
+    }
+}
+
+void QueryScheduler::send(ApiQuery *query, int priority, qint64 since)
+{
+    qint64 wait = QDateTime::currentMSecsSinceEpoch() - since;
+    this->sent[priority]++;
+    this->waitTotal[priority] += wait;
+    if (wait > this->waitMax[priority])
+        this->waitMax[priority] = wait;
+    this->running[query->GetSite()]++;
+    this->runningTotal++;
+    query->isQueued = false;
+    query->isScheduled = true;
+    // time spent in queue doesn't count to time out of query
+    query->StartTime = QDateTime::currentDateTime();
+    query->sendRequest();
+    // status stays same, but process list needs to show that it's no longer queued
+    if (QueryPool::HugglePool)
+        QueryPool::HugglePool->QueryChanged(query);
+}
@@ -0,0 +1,78 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef QUERYSCHEDULER_HPP
+#define QUERYSCHEDULER_HPP
+
+#include "definitions.hpp"
+
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QQueue>
+#include <QString>
+#include "apiquery.hpp"
+
+#define HUGGLE_QUERY_PRIORITIES 4
+
+namespace Huggle
+{
+    class WikiSite;
+
+    /*!
+     * \brief Decides when api queries are sent
+     *
+     * Only limited number of requests to each wiki may run at once, queries that don't fit are queued by their
+     * priority and sent once some other request to same wiki finishes. Wikis take turns within each priority,
+     * so that a flood of queries to one wiki doesn't hold queries to other wikis. Interactive writes are never
+     * queued, because the time it takes to revert is what user notices the most.
+     */
+    class HUGGLE_EX_CORE QueryScheduler
+    {
+        public:
+            static QString PriorityToString(int priority);
+            QueryScheduler();
+            //! Send the query now if its wiki has a free slot, otherwise put it to queue
+            void Schedule(ApiQuery *query);
+            //! Free the slot of query that was sent by scheduler, this needs to be called when its request is finished or aborted
+            void Finished(ApiQuery *query);
+            int GetQueued();
+            int GetQueued(int priority);
+            int GetRunning();
+            //! Number of queries of this priority that were sent since startup
+            unsigned long GetSent(int priority);
+            //! Average time in ms that queries of this priority waited in queue
+            double GetAverageWaitTime(int priority);
+            double GetMaxWaitTime(int priority);
+            //! Summary of queue depths and wait times
+            QString ToString();
+        private:
+            struct Waiting
+            {
+                QPointer<ApiQuery> Query;
+                qint64 Since;
+            };
+            bool hasFreeSlot(WikiSite *site);
+            void dispatch();
+            void send(ApiQuery *query, int priority, qint64 since);
+            QHash<WikiSite*, QQueue<Waiting>> queues[HUGGLE_QUERY_PRIORITIES];
+            //! Wikis that have queries waiting in each priority, in order in which they get their turn
+            QList<WikiSite*> turns[HUGGLE_QUERY_PRIORITIES];
+            //! Number of running requests that were sent by scheduler to each wiki
+            QHash<WikiSite*, int> running;
+            int runningTotal = 0;
+            int queued[HUGGLE_QUERY_PRIORITIES];
+            unsigned long sent[HUGGLE_QUERY_PRIORITIES];
+            qint64 waitTotal[HUGGLE_QUERY_PRIORITIES];
+            qint64 waitMax[HUGGLE_QUERY_PRIORITIES];
+    };
+}
+
+#endif // QUERYSCHEDULER_HPP
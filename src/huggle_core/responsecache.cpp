@@ -0,0 +1,150 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "responsecache.hpp"
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QNetworkDiskCache>
+#include <QUrl>
+#include <QUrlQuery>
+#include "apiqueryresult.hpp"
+#include "syslog.hpp"
+
+using namespace Huggle;
+
+#define HUGGLE_RESPONSECACHE_REVISION "X-Huggle-Revision"
+
+unsigned long ResponseCache::Hits = 0;
+unsigned long ResponseCache::Misses = 0;
+unsigned long ResponseCache::Validated = 0;
+QNetworkDiskCache *ResponseCache::cache = nullptr;
+
+bool ResponseCache::Open(const QString &path, qint64 max_size)
+{
+    ResponseCache::Close();
+    if (max_size <= 0)
+        return false;
+    cache = new QNetworkDiskCache();
+    cache->setCacheDirectory(path);
+    cache->setMaximumCacheSize(max_size);
+    HUGGLE_DEBUG1("Response cache " + path + " contains " + QString::number(cache->cacheSize() / 1024) + "kb");
+    return true;
+}
+
+void ResponseCache::Close()
+{
+    delete cache;
+    cache = nullptr;
+}
+
+bool ResponseCache::IsOpen()
+{
+    return cache != nullptr;
+}
+
+bool ResponseCache::Lookup(const QString &url, QByteArray *data, QString *revision)
+{
+    if (!cache)
+        return false;
+    QUrl key = QUrl::fromEncoded(url.toUtf8());
+    QIODevice *device = cache->data(key);
+    if (!device)
+        return false;
+    *data = device->readAll();
+    delete device;
+    if (revision)
+    {
+        revision->clear();
+        foreach (QNetworkCacheMetaData::RawHeader header, cache->metaData(key).rawHeaders())
+        {
+            if (header.first == HUGGLE_RESPONSECACHE_REVISION)
+                *revision = QString(header.second);
+        }
+    }
+    return true;
+}
+
+void ResponseCache::Store(const QString &url, const QByteArray &data, const QString &revision)
+{
+    if (!cache)
+        return;
+    QNetworkCacheMetaData meta;
+    meta.setUrl(QUrl::fromEncoded(url.toUtf8()));
+    meta.setSaveToDisk(true);
+    if (!revision.isEmpty())
+    {
+        QNetworkCacheMetaData::RawHeaderList headers;
+        headers.append(QNetworkCacheMetaData::RawHeader(HUGGLE_RESPONSECACHE_REVISION, revision.toUtf8()));
+        meta.setRawHeaders(headers);
+    }
+    QIODevice *device = cache->prepare(meta);
+    if (!device)
+        return;
+    device->write(data);
+    // this also removes old files if cache is over its limit
+    cache->insert(device);
+}
+
+void ResponseCache::Clear()
+{
+    if (cache)
+        cache->clear();
+}
+
+qint64 ResponseCache::GetSize()
+{
+    if (!cache)
+        return 0;
+    return cache->cacheSize();
+}
+
+double ResponseCache::GetHitRate()
+{
+    if (Hits + Misses == 0)
+        return 0;
+    return static_cast<double>(Hits) * 100 / (Hits + Misses);
+}
+
+QString ResponseCache::ToString()
+{
+    return QString::number(Hits) + "/" + QString::number(Misses) + " (" + QString::number(GetHitRate(), 'f', 0) + "%, validated " +
+           QString::number(Validated) + ", " + QString::number(GetSize() / 1024) + "kb)";
+}
+
+QString ResponseCache::GetValidationUrl(const QString &url)
+{
+    QUrl result = QUrl::fromEncoded(url.toUtf8());
+    QUrlQuery query(result);
+    query.removeAllQueryItems("rvprop");
+    query.addQueryItem("rvprop", "ids");
+    result.setQuery(query);
+    return QString(result.toEncoded());
+}
+
+QString ResponseCache::GetRevision(ApiQueryResult *result)
+{
+    if (result->IsFailed())
+        return "";
+    if (!result->Json.isNull())
+    {
+        QJsonObject pages = result->Json.object().value("query").toObject().value("pages").toObject();
+        foreach (QJsonValue page, pages)
+        {
+            QJsonArray revisions = page.toObject().value("revisions").toArray();
+            if (!revisions.isEmpty() && revisions.at(0).toObject().contains("revid"))
+                return QString::number(revisions.at(0).toObject().value("revid").toVariant().toLongLong());
+        }
+        return "";
+    }
+    ApiQueryResultNode *revision = result->GetNode("rev");
+    if (revision == nullptr)
+        return "";
+    return revision->GetAttribute("revid");
+}
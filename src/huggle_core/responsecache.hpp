@@ -0,0 +1,74 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef RESPONSECACHE_HPP
+#define RESPONSECACHE_HPP
+
+#include "definitions.hpp"
+
+#include <QByteArray>
+#include <QString>
+
+class QNetworkDiskCache;
+
+namespace Huggle
+{
+    class ApiQueryResult;
+
+    /*!
+     * \brief On-disk cache of api responses, so that data which don't change are not downloaded again after restart
+     *
+     * Mediawiki marks api responses as private and not cacheable, so the cache is not installed into network manager,
+     * which would follow these headers and would also store responses with tokens. Instead ApiQuery decides which
+     * responses may be cached (see Policy) and asks this cache explicitly. Files are stored by QNetworkDiskCache, which
+     * removes the oldest ones once the cache is bigger than its limit.
+     */
+    class HUGGLE_EX_CORE ResponseCache
+    {
+        public:
+            enum Policy
+            {
+                //! Only responses that can never change are cached, diffs between fixed revisions and text of revisions
+                PolicyAuto,
+                PolicyNever,
+                PolicyPermanent,
+                //! Content of page is cached together with its revision, which is checked before cached content is used
+                PolicyValidated
+            };
+
+            //! Open the cache in given folder, max_size is in bytes and cache is disabled if it's 0
+            static bool Open(const QString &path, qint64 max_size);
+            static void Close();
+            static bool IsOpen();
+            //! Returns true and fills data and revision (if it was stored with one) if url is in cache
+            static bool Lookup(const QString &url, QByteArray *data, QString *revision = nullptr);
+            static void Store(const QString &url, const QByteArray &data, const QString &revision = "");
+            static void Clear();
+            //! Size of all files in cache in bytes
+            static qint64 GetSize();
+            //! Percentage of cacheable requests that were served from the cache
+            static double GetHitRate();
+            static QString ToString();
+            //! Returns url that only retrieves id of current revision of page that url retrieves with content
+            static QString GetValidationUrl(const QString &url);
+            //! Returns id of first revision in processed result of query for page revisions, or empty string if it has none
+            static QString GetRevision(ApiQueryResult *result);
+            //! Requests that were served from the cache
+            static unsigned long Hits;
+            //! Cacheable requests that weren't in the cache or which were outdated
+            static unsigned long Misses;
+            //! Hits which needed a request that checked the revision
+            static unsigned long Validated;
+        private:
+            static QNetworkDiskCache *cache;
+    };
+}
+
+#endif // RESPONSECACHE_HPP
@@ -12,6 +12,7 @@
 #include "apiquery.hpp"
 #include "apiqueryresult.hpp"
 #include "configuration.hpp"
+#include "editregistry.hpp"
 #include "exception.hpp"
 #include "generic.hpp"
 #include "querypool.hpp"
@@ -55,7 +56,7 @@ void RevertQuery::displayError(QString error, QString reason)
         reason = error;
     Huggle::Syslog::HuggleLogs->ErrorLog(error);
     this->Kill();
-    this->status = StatusDone;
+    this->SetStatus(StatusDone);
     this->Result = new QueryResult();
     this->Result->SetError();
     this->processFailure();
@@ -101,7 +102,7 @@ void RevertQuery::Process()
         Huggle::Syslog::HuggleLogs->DebugLog("Cowardly refusing to double process the query");
         return;
     }
-    this->status = StatusProcessing;
+    this->SetStatus(StatusProcessing);
     if (this->timer != nullptr)
         delete this->timer;
     this->StartTime = QDateTime::currentDateTime();
@@ -144,7 +145,7 @@ void RevertQuery::Kill()
         this->qHistoryInfo.Delete();
     }
     // set the status
-    this->status = StatusKilled;
+    this->SetStatus(StatusKilled);
 
     if (this->qRetrieve != nullptr)
     {
@@ -248,32 +249,11 @@ QString RevertQuery::GetCustomRevertStatus(QueryResult *result_data, WikiSite *s
 void RevertQuery::preflightCheck()
 {
     // check if there is more edits in queue
-    int index=0;
     bool failed = false;
     bool made_by_same_user = true;
     // we only need to check this in case we aren't to revert last edit only
     if (!this->oneEditOnly)
-    {
-        WikiEdit::Lock_EditList->lock();
-        while (index < WikiEdit::EditList.count())
-        {
-            WikiEdit *w = WikiEdit::EditList.at(index++);
-            if (!w->IsPostProcessed())
-                continue;
-            if (w != this->editToBeReverted)
-            {
-                if (!w->Page->EqualTo(this->editToBeReverted->Page))
-                    continue;
-                if (w->Time > this->editToBeReverted->Time)
-                {
-                    if (!w->User->EqualTo(this->editToBeReverted->User))
-                        made_by_same_user = false;
-                    failed = true;
-                }
-            }
-        }
-        WikiEdit::Lock_EditList->unlock();
-    }
+        failed = EditRegistry::HasNewerEdits(this->editToBeReverted, &made_by_same_user);
     if (failed)
     {
         if (Configuration::HuggleConfiguration->UserConfig->AutomaticallyResolveConflicts)
@@ -334,7 +314,7 @@ void RevertQuery::evaluatePreflightCheck()
         Huggle::Syslog::HuggleLogs->Log(_l("revert-fail-pre-flight", this->qPreflight->GetFailureReason()));
         this->Kill();
         this->Result = new QueryResult();
-        this->status = StatusDone;
+        this->SetStatus(StatusDone);
         this->Result->SetError();
         this->processFailure();
         return;
@@ -426,7 +406,7 @@ void RevertQuery::evaluatePreflightCheck()
             this->CustomStatus = "Stopped";
             this->Result = new QueryResult();
             this->Result->SetError("User requested to abort this");
-            this->status = StatusDone;
+            this->SetStatus(StatusDone);
             this->preflightFinished = true;
             this->processFailure();
             return;
@@ -455,7 +435,7 @@ bool RevertQuery::evaluateRevertQueryResults()
     }
     if (failed)
     {
-        this->status = StatusInError;
+        this->SetStatus(StatusInError);
         Huggle::Syslog::HuggleLogs->Log(_l("revert-fail", this->qRevert->Target, this->CustomStatus));
         this->qRevert->Result->SetError(CustomStatus);
         this->Result = new QueryResult(true);
@@ -463,7 +443,7 @@ bool RevertQuery::evaluateRevertQueryResults()
         this->processFailure();
     } else
     {
-        this->status = StatusDone;
+        this->SetStatus(StatusDone);
         HistoryItem *item = new HistoryItem(this->GetSite());
         this->HI = item;
         this->Result = new QueryResult();
@@ -484,7 +464,7 @@ void RevertQuery::cancelRevert()
     this->CustomStatus = "Stopped";
     this->Result = new QueryResult(true);
     this->Result->SetError("User requested to abort this");
-    this->status = StatusDone;
+    this->SetStatus(StatusDone);
     this->preflightFinished = true;
     this->processFailure();
 }
@@ -507,7 +487,7 @@ bool RevertQuery::evaluateRevert()
             this->Result->SetError(this->eqSoftwareRollback->GetFailureReason());
             this->Kill();
             this->processFailure();
-            this->status = StatusInError;
+            this->SetStatus(StatusInError);
             return true;
         }
         Syslog::HuggleLogs->DebugLog("Sucessful SR of page " + this->editToBeReverted->Page->PageName);
@@ -705,7 +685,7 @@ void RevertQuery::executeRollback()
         Huggle::Syslog::HuggleLogs->ErrorLog(_l("revert-fail", this->editToBeReverted->Page->PageName, "rollback token was empty"));
         this->Result = new QueryResult();
         this->Result->SetError(_l("revert-fail", this->editToBeReverted->Page->PageName, "rollback token was empty"));
-        this->status = StatusDone;
+        this->SetStatus(StatusDone);
         this->freeResources();
         this->processFailure();
         return;
@@ -0,0 +1,222 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "scorewordmatcher.hpp"
+#include <QQueue>
+#include "projectconfiguration.hpp"
+
+using namespace Huggle;
+
+const unsigned char ScoreWordMatcher::HitPart;
+const unsigned char ScoreWordMatcher::HitWord;
+
+ScoreWordMatcher::ScoreWordMatcher()
+{
+    this->Clear();
+}
+
+void ScoreWordMatcher::Clear()
+{
+    this->nodes.clear();
+    // root
+    this->nodes.append(Node());
+    this->patterns.clear();
+    this->patternIDs.clear();
+    this->lists.clear();
+    this->separatorChars.clear();
+    this->longSeparators.clear();
+    this->emptySeparator = false;
+    this->compiled = false;
+}
+
+int ScoreWordMatcher::AddList(const QList<ScoreWord> &list, bool whole_words)
+{
+    List l;
+    l.WholeWords = whole_words;
+    foreach (const ScoreWord &word, list)
+    {
+        l.Words.append(word.word);
+        l.Scores.append(word.score);
+        l.Patterns.append(this->addPattern(word.word));
+    }
+    this->lists.append(l);
+    this->compiled = false;
+    return this->lists.count() - 1;
+}
+
+int ScoreWordMatcher::addPattern(const QString &pattern)
+{
+    if (pattern.isEmpty())
+        return -1;
+    if (this->patternIDs.contains(pattern))
+        return this->patternIDs[pattern];
+    int node = 0;
+    foreach (QChar c, pattern)
+    {
+        int next = this->nodes[node].Next.value(c.unicode(), -1);
+        if (next < 0)
+        {
+            next = this->nodes.count();
+            this->nodes.append(Node());
+            this->nodes[node].Next.insert(c.unicode(), next);
+        }
+        node = next;
+    }
+    int id = this->patterns.count();
+    this->patterns.append(pattern);
+    this->patternIDs.insert(pattern, id);
+    this->nodes[node].Pattern = id;
+    return id;
+}
+
+void ScoreWordMatcher::Compile(const QStringList &separators)
+{
+    this->separatorChars.clear();
+    this->longSeparators.clear();
+    this->emptySeparator = false;
+    foreach (QString separator, separators)
+    {
+        if (separator.isEmpty())
+            this->emptySeparator = true;
+        else if (separator.length() == 1)
+            this->separatorChars.insert(separator.at(0));
+        else
+            this->longSeparators.append(separator);
+    }
+
+    // breadth first walk of the trie, so that fail links of all shorter nodes are known
+    QQueue<int> queue;
+    foreach (int child, this->nodes[0].Next)
+    {
+        this->nodes[child].Fail = 0;
+        this->nodes[child].Output = -1;
+        queue.enqueue(child);
+    }
+    while (!queue.isEmpty())
+    {
+        int node = queue.dequeue();
+        QHash<ushort, int>::const_iterator it = this->nodes[node].Next.constBegin();
+        while (it != this->nodes[node].Next.constEnd())
+        {
+            ushort c = it.key();
+            int child = it.value();
+            int fail = this->nodes[node].Fail;
+            while (fail != 0 && !this->nodes[fail].Next.contains(c))
+                fail = this->nodes[fail].Fail;
+            fail = this->nodes[fail].Next.value(c, 0);
+            this->nodes[child].Fail = fail;
+            this->nodes[child].Output = this->nodes[fail].Pattern >= 0 ? fail : this->nodes[fail].Output;
+            queue.enqueue(child);
+            ++it;
+        }
+    }
+    this->compiled = true;
+}
+
+bool ScoreWordMatcher::isSeparatorBefore(const QString &text, int position) const
+{
+    if (position == 0 || this->emptySeparator || this->separatorChars.contains(text.at(position - 1)))
+        return true;
+    foreach (QString separator, this->longSeparators)
+    {
+        if (position >= separator.length() && text.midRef(position - separator.length(), separator.length()) == separator)
+            return true;
+    }
+    return false;
+}
+
+bool ScoreWordMatcher::isSeparatorAt(const QString &text, int position) const
+{
+    if (position == text.length() || this->emptySeparator || this->separatorChars.contains(text.at(position)))
+        return true;
+    foreach (QString separator, this->longSeparators)
+    {
+        if (text.midRef(position, separator.length()) == separator)
+            return true;
+    }
+    return false;
+}
+
+QVector<unsigned char> ScoreWordMatcher::Match(const QString &text) const
+{
+    QVector<unsigned char> hits(this->patterns.count(), 0);
+    if (!this->compiled)
+        return hits;
+    int state = 0;
+    const QChar *data = text.constData();
+    int length = text.length();
+    for (int i = 0; i < length; i++)
+    {
+        ushort c = data[i].unicode();
+        // follow the fail links until we find a node that continues with this character
+        while (true)
+        {
+            QHash<ushort, int>::const_iterator next = this->nodes[state].Next.constFind(c);
+            if (next != this->nodes[state].Next.constEnd())
+            {
+                state = next.value();
+                break;
+            }
+            if (state == 0)
+                break;
+            state = this->nodes[state].Fail;
+        }
+        int output = this->nodes[state].Pattern >= 0 ? state : this->nodes[state].Output;
+        while (output >= 0)
+        {
+            int pattern = this->nodes[output].Pattern;
+            unsigned char &hit = hits[pattern];
+            hit |= HitPart;
+            if (!(hit & HitWord))
+            {
+                int start = i + 1 - this->patterns.at(pattern).length();
+                if (this->isSeparatorBefore(text, start) && this->isSeparatorAt(text, i + 1))
+                    hit |= HitWord;
+            }
+            output = this->nodes[output].Output;
+        }
+    }
+    return hits;
+}
+
+long ScoreWordMatcher::Evaluate(int list, const QVector<unsigned char> &hits, QStringList *found) const
+{
+    if (list < 0 || list >= this->lists.count())
+        return 0;
+    const List &l = this->lists.at(list);
+    unsigned char flag = l.WholeWords ? HitWord : HitPart;
+    long score = 0;
+    int i = 0;
+    while (i < l.Patterns.count())
+    {
+        int pattern = l.Patterns.at(i);
+        if (pattern >= 0 && pattern < hits.count() && (hits.at(pattern) & flag))
+        {
+            score += l.Scores.at(i);
+            found->append(l.Words.at(i));
+        }
+        ++i;
+    }
+    return score;
+}
+
+bool ScoreWordMatcher::IsMatched(int list, const QVector<unsigned char> &hits) const
+{
+    if (list < 0 || list >= this->lists.count())
+        return false;
+    const List &l = this->lists.at(list);
+    unsigned char flag = l.WholeWords ? HitWord : HitPart;
+    foreach (int pattern, l.Patterns)
+    {
+        if (pattern >= 0 && pattern < hits.count() && (hits.at(pattern) & flag))
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,102 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef SCOREWORDMATCHER_HPP
+#define SCOREWORDMATCHER_HPP
+
+#include "definitions.hpp"
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace Huggle
+{
+    class ScoreWord;
+
+    /*!
+     * \brief Finds all score words and score parts of a project in a text in one pass
+     *
+     * Patterns of all lists are compiled into one Aho-Corasick automaton, so that matching a text takes time
+     * proportional to its length and number of hits, instead of number of words times length of text.
+     * Every occurrence of a pattern is a hit for score parts, score words need to be delimited by one
+     * of word separators or by beginning or end of the text.
+     */
+    class HUGGLE_EX_CORE ScoreWordMatcher
+    {
+        public:
+            //! Pattern was found somewhere in the text
+            static const unsigned char HitPart = 1;
+            //! Pattern was found as a separate word
+            static const unsigned char HitWord = 2;
+
+            ScoreWordMatcher();
+            //! Remove all lists and patterns
+            void Clear();
+            /*!
+             * \brief Add a list of score words, it will be searched for after Compile() is called
+             * \param list List of words, empty words are never matched
+             * \param whole_words If true words are only matched when they are delimited by separators
+             * \return ID of list that needs to be passed to Evaluate()
+             */
+            int AddList(const QList<ScoreWord> &list, bool whole_words);
+            //! Build the automaton from all lists that were added so far
+            void Compile(const QStringList &separators);
+            bool IsCompiled() const { return this->compiled; }
+            //! Find all patterns in text, result contains HitPart and HitWord flags for every pattern
+            QVector<unsigned char> Match(const QString &text) const;
+            /*!
+             * \brief Sum scores of all words from a list that were found in a text
+             * \param list ID of list returned by AddList()
+             * \param hits Result of Match()
+             * \param found Every matched word is appended to this list, in same order as in the list of words
+             * \return Sum of scores
+             */
+            long Evaluate(int list, const QVector<unsigned char> &hits, QStringList *found) const;
+            //! Returns true if any word from given list was found in a text
+            bool IsMatched(int list, const QVector<unsigned char> &hits) const;
+        private:
+            struct Node
+            {
+                QHash<ushort, int> Next;
+                //! Node that represents longest proper suffix of this node
+                int Fail = 0;
+                //! Pattern that ends in this node or -1
+                int Pattern = -1;
+                //! Nearest node on the fail chain that has a pattern or -1
+                int Output = -1;
+            };
+            struct List
+            {
+                bool WholeWords;
+                QStringList Words;
+                QVector<int> Scores;
+                QVector<int> Patterns;
+            };
+            int addPattern(const QString &pattern);
+            bool isSeparatorBefore(const QString &text, int position) const;
+            bool isSeparatorAt(const QString &text, int position) const;
+            QVector<Node> nodes;
+            QStringList patterns;
+            QHash<QString, int> patternIDs;
+            QList<List> lists;
+            //! Separators that are one character long, which are usually all of them
+            QSet<QChar> separatorChars;
+            QStringList longSeparators;
+            //! Empty separator matches everywhere
+            bool emptySeparator = false;
+            bool compiled = false;
+    };
+}
+
+#endif // SCOREWORDMATCHER_HPP
@@ -87,6 +87,7 @@ QJSValue JSMarshallingHelper::FromEdit(WikiEdit *edit, QJSEngine *engine, int po
     o.setProperty("DiffText_IsSplit", QJSValue(edit->DiffText_IsSplit));
     o.setProperty("DiffText_New", QJSValue(edit->DiffText_New));
     o.setProperty("DiffText_Old", QJSValue(edit->DiffText_Old));
+    o.setProperty("DiffText_Added", QJSValue(edit->GetAddedText()));
     o.setProperty("DiffTo", QJSValue(edit->DiffTo));
     o.setProperty("EditMadeByHuggle", QJSValue(edit->EditMadeByHuggle));
     o.setProperty("FullUrl", QJSValue(edit->GetFullUrl()));
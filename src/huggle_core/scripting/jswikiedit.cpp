@@ -0,0 +1,212 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU Lesser General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU Lesser General Public License for more details.
+
+#include "jswikiedit.hpp"
+#include "jsmarshallinghelper.hpp"
+#include "script.hpp"
+#include "../wikiedit.hpp"
+#include "../wikipage.hpp"
+#include "../wikisite.hpp"
+#include "../wikiuser.hpp"
+
+using namespace Huggle;
+
+// properties of detached object are undefined, same as properties that don't exist
+#define HUGGLE_JS_EDIT_PROPERTY(value) if (!this->edit) \
+                                           return QJSValue(); \
+                                       return QJSValue(value)
+
+JSWikiEdit::JSWikiEdit(WikiEdit *wiki_edit, QJSEngine *js_engine, ScriptMemPool *mem_pool)
+{
+    this->edit = wiki_edit;
+    this->engine = js_engine;
+    this->memPool = mem_pool;
+}
+
+void JSWikiEdit::Detach()
+{
+    this->edit = nullptr;
+}
+
+int JSWikiEdit::GetPoolID()
+{
+    if (!this->edit)
+        return -1;
+    // pool ID is valid only while a hook is running, so we always need to look up the current one
+    return this->memPool->GetID(this->edit);
+}
+
+QJSValue JSWikiEdit::GetContentModel()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->ContentModel);
+}
+
+QJSValue JSWikiEdit::GetBot()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->Bot);
+}
+
+QJSValue JSWikiEdit::GetCurrentUserWarningLevel()
+{
+    HUGGLE_JS_EDIT_PROPERTY(static_cast<int>(this->edit->CurrentUserWarningLevel));
+}
+
+QJSValue JSWikiEdit::GetDiff()
+{
+    HUGGLE_JS_EDIT_PROPERTY(static_cast<int>(this->edit->Diff));
+}
+
+QJSValue JSWikiEdit::GetDiffText()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->DiffText);
+}
+
+QJSValue JSWikiEdit::GetDiffTextIsSplit()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->DiffText_IsSplit);
+}
+
+QJSValue JSWikiEdit::GetDiffTextNew()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->DiffText_New);
+}
+
+QJSValue JSWikiEdit::GetDiffTextOld()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->DiffText_Old);
+}
+
+QJSValue JSWikiEdit::GetDiffTextAdded()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->GetAddedText());
+}
+
+QJSValue JSWikiEdit::GetDiffTo()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->DiffTo);
+}
+
+QJSValue JSWikiEdit::GetEditMadeByHuggle()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->EditMadeByHuggle);
+}
+
+QJSValue JSWikiEdit::GetFullUrl()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->GetFullUrl());
+}
+
+QJSValue JSWikiEdit::GetScore()
+{
+    HUGGLE_JS_EDIT_PROPERTY(static_cast<int>(this->edit->Score));
+}
+
+QJSValue JSWikiEdit::GetScoreWords()
+{
+    if (!this->edit)
+        return QJSValue();
+    return JSMarshallingHelper::FromQStringList(this->edit->ScoreWords, this->engine);
+}
+
+QJSValue JSWikiEdit::GetSiteName()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->GetSite()->Name);
+}
+
+QJSValue JSWikiEdit::GetSizeIsKnown()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->SizeIsKnown);
+}
+
+QJSValue JSWikiEdit::GetSize()
+{
+    HUGGLE_JS_EDIT_PROPERTY(static_cast<int>(this->edit->GetSize()));
+}
+
+QJSValue JSWikiEdit::GetSummary()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->Summary);
+}
+
+QJSValue JSWikiEdit::GetGoodfaithScore()
+{
+    HUGGLE_JS_EDIT_PROPERTY(static_cast<int>(this->edit->GoodfaithScore));
+}
+
+QJSValue JSWikiEdit::GetIsRangeOfEdits()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->IsRangeOfEdits());
+}
+
+QJSValue JSWikiEdit::GetIsRevert()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->IsRevert);
+}
+
+QJSValue JSWikiEdit::GetIsValid()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->IsValid);
+}
+
+QJSValue JSWikiEdit::GetIsMinor()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->IsMinor);
+}
+
+QJSValue JSWikiEdit::GetNewPage()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->NewPage);
+}
+
+QJSValue JSWikiEdit::GetOwnEdit()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->OwnEdit);
+}
+
+QJSValue JSWikiEdit::GetPage()
+{
+    if (!this->edit)
+        return QJSValue();
+    return JSMarshallingHelper::FromPage(this->edit->Page, this->engine);
+}
+
+QJSValue JSWikiEdit::GetUser()
+{
+    if (!this->edit)
+        return QJSValue();
+    return JSMarshallingHelper::FromUser(this->edit->User, this->engine);
+}
+
+QJSValue JSWikiEdit::GetRevID()
+{
+    HUGGLE_JS_EDIT_PROPERTY(static_cast<int>(this->edit->RevID));
+}
+
+QJSValue JSWikiEdit::GetTags()
+{
+    if (!this->edit)
+        return QJSValue();
+    return JSMarshallingHelper::FromQStringList(this->edit->Tags, this->engine);
+}
+
+QJSValue JSWikiEdit::GetTime()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->Time.toString());
+}
+
+QJSValue JSWikiEdit::GetTPRevBaseTime()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->TPRevBaseTime);
+}
+
+QJSValue JSWikiEdit::GetTrustworthEdit()
+{
+    HUGGLE_JS_EDIT_PROPERTY(this->edit->TrustworthEdit);
+}
@@ -0,0 +1,114 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU Lesser General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU Lesser General Public License for more details.
+
+#ifndef JSWIKIEDIT_HPP
+#define JSWIKIEDIT_HPP
+
+#include "../definitions.hpp"
+#include <QJSEngine>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+namespace Huggle
+{
+    class ScriptMemPool;
+    class WikiEdit;
+
+    /*!
+     * \brief Edit as seen by JS code of one script
+     *
+     * Unlike JSMarshallingHelper::FromEdit() this object doesn't copy anything when it's created, every property is read
+     * from the edit only when script accesses it, so that large texts like DiffText are converted to JS strings only for
+     * scripts that actually use them. Objects are cached by ScriptMemPool, so the same edit is marshalled only once per engine.
+     * When the object is dropped from cache it's detached from the edit and all its properties become undefined.
+     */
+    class HUGGLE_EX_CORE JSWikiEdit : public QObject
+    {
+            Q_OBJECT
+            Q_PROPERTY(int _ptr READ GetPoolID)
+            Q_PROPERTY(QJSValue ContentModel READ GetContentModel)
+            Q_PROPERTY(QJSValue Bot READ GetBot)
+            Q_PROPERTY(QJSValue CurrentUserWarningLevel READ GetCurrentUserWarningLevel)
+            Q_PROPERTY(QJSValue Diff READ GetDiff)
+            Q_PROPERTY(QJSValue DiffText READ GetDiffText)
+            Q_PROPERTY(QJSValue DiffText_IsSplit READ GetDiffTextIsSplit)
+            Q_PROPERTY(QJSValue DiffText_New READ GetDiffTextNew)
+            Q_PROPERTY(QJSValue DiffText_Old READ GetDiffTextOld)
+            Q_PROPERTY(QJSValue DiffText_Added READ GetDiffTextAdded)
+            Q_PROPERTY(QJSValue DiffTo READ GetDiffTo)
+            Q_PROPERTY(QJSValue EditMadeByHuggle READ GetEditMadeByHuggle)
+            Q_PROPERTY(QJSValue FullUrl READ GetFullUrl)
+            Q_PROPERTY(QJSValue Score READ GetScore)
+            Q_PROPERTY(QJSValue ScoreWords READ GetScoreWords)
+            Q_PROPERTY(QJSValue SiteName READ GetSiteName)
+            Q_PROPERTY(QJSValue SizeIsKnown READ GetSizeIsKnown)
+            Q_PROPERTY(QJSValue Size READ GetSize)
+            Q_PROPERTY(QJSValue Summary READ GetSummary)
+            Q_PROPERTY(QJSValue GoodfaithScore READ GetGoodfaithScore)
+            Q_PROPERTY(QJSValue IsRangeOfEdits READ GetIsRangeOfEdits)
+            Q_PROPERTY(QJSValue IsRevert READ GetIsRevert)
+            Q_PROPERTY(QJSValue IsValid READ GetIsValid)
+            Q_PROPERTY(QJSValue IsMinor READ GetIsMinor)
+            Q_PROPERTY(QJSValue NewPage READ GetNewPage)
+            Q_PROPERTY(QJSValue OwnEdit READ GetOwnEdit)
+            Q_PROPERTY(QJSValue Page READ GetPage)
+            Q_PROPERTY(QJSValue User READ GetUser)
+            Q_PROPERTY(QJSValue RevID READ GetRevID)
+            Q_PROPERTY(QJSValue Tags READ GetTags)
+            Q_PROPERTY(QJSValue Time READ GetTime)
+            Q_PROPERTY(QJSValue TPRevBaseTime READ GetTPRevBaseTime)
+            Q_PROPERTY(QJSValue TrustworthEdit READ GetTrustworthEdit)
+        public:
+            JSWikiEdit(WikiEdit *wiki_edit, QJSEngine *js_engine, ScriptMemPool *mem_pool);
+            //! Forget the edit, this needs to be called before the edit is released
+            void Detach();
+            WikiEdit *GetEdit() { return this->edit; }
+            int GetPoolID();
+            QJSValue GetContentModel();
+            QJSValue GetBot();
+            QJSValue GetCurrentUserWarningLevel();
+            QJSValue GetDiff();
+            QJSValue GetDiffText();
+            QJSValue GetDiffTextIsSplit();
+            QJSValue GetDiffTextNew();
+            QJSValue GetDiffTextOld();
+            QJSValue GetDiffTextAdded();
+            QJSValue GetDiffTo();
+            QJSValue GetEditMadeByHuggle();
+            QJSValue GetFullUrl();
+            QJSValue GetScore();
+            QJSValue GetScoreWords();
+            QJSValue GetSiteName();
+            QJSValue GetSizeIsKnown();
+            QJSValue GetSize();
+            QJSValue GetSummary();
+            QJSValue GetGoodfaithScore();
+            QJSValue GetIsRangeOfEdits();
+            QJSValue GetIsRevert();
+            QJSValue GetIsValid();
+            QJSValue GetIsMinor();
+            QJSValue GetNewPage();
+            QJSValue GetOwnEdit();
+            QJSValue GetPage();
+            QJSValue GetUser();
+            QJSValue GetRevID();
+            QJSValue GetTags();
+            QJSValue GetTime();
+            QJSValue GetTPRevBaseTime();
+            QJSValue GetTrustworthEdit();
+        private:
+            WikiEdit *edit;
+            QJSEngine *engine;
+            ScriptMemPool *memPool;
+    };
+}
+
+#endif // JSWIKIEDIT_HPP
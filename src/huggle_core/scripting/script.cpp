@@ -13,6 +13,7 @@
 #include "script.hpp"
 #include "scriptfunctionhelp.hpp"
 #include "jsmarshallinghelper.hpp"
+#include "jswikiedit.hpp"
 #include "huggleunsafejs.hpp"
 #include "hugglequeryjs.hpp"
 #include "huggleeditjs.hpp"
@@ -27,6 +28,7 @@
 #include "../syslog.hpp"
 #include "../version.hpp"
 #include <climits>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QTimer>
 
@@ -164,6 +166,7 @@ void Script::Unload()
     if (this->IsWorking())
         this->executeFunction("ext_unload");
     this->isWorking = false;
+    this->memPool->ClearEditCache();
 }
 
 QString Script::GetDescription()
@@ -290,9 +293,9 @@ bool Script::Hook_EditBeforePreProcess(WikiEdit *edit)
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_EDIT_BEFORE_PRE_PROCESS))
         return true;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList parameters;
-    parameters.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    parameters.append(this->memPool->MarshallEdit(edit, this->engine));
     bool rv = this->executeFunctionAsBool(this->attachedHooks[HUGGLE_SCRIPT_HOOK_EDIT_BEFORE_PRE_PROCESS], parameters);
     this->memPool->UnregisterEdit(edit);
     return rv;
@@ -303,9 +306,9 @@ void Script::Hook_EditPreProcess(WikiEdit *edit)
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_EDIT_PRE_PROCESS))
         return;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList parameters;
-    parameters.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    parameters.append(this->memPool->MarshallEdit(edit, this->engine));
     this->executeFunction(this->attachedHooks[HUGGLE_SCRIPT_HOOK_EDIT_PRE_PROCESS], parameters);
     this->memPool->UnregisterEdit(edit);
 }
@@ -315,9 +318,9 @@ void Script::Hook_EditBeforePostProcess(WikiEdit *edit)
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_EDIT_BEFORE_POST_PROCESS))
         return;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList parameters;
-    parameters.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    parameters.append(this->memPool->MarshallEdit(edit, this->engine));
     this->executeFunction(this->attachedHooks[HUGGLE_SCRIPT_HOOK_EDIT_BEFORE_POST_PROCESS], parameters);
     this->memPool->UnregisterEdit(edit);
 }
@@ -327,9 +330,9 @@ void Script::Hook_EditPostProcess(WikiEdit *edit)
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_EDIT_POST_PROCESS))
         return;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList parameters;
-    parameters.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    parameters.append(this->memPool->MarshallEdit(edit, this->engine));
     this->executeFunction(this->attachedHooks[HUGGLE_SCRIPT_HOOK_EDIT_POST_PROCESS], parameters);
     this->memPool->UnregisterEdit(edit);
 }
@@ -339,9 +342,9 @@ bool Script::Hook_EditLoadToQueue(WikiEdit *edit)
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_EDIT_LOAD_TO_QUEUE))
         return true;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList parameters;
-    parameters.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    parameters.append(this->memPool->MarshallEdit(edit, this->engine));
     bool r = this->executeFunctionAsBool(this->attachedHooks[HUGGLE_SCRIPT_HOOK_EDIT_LOAD_TO_QUEUE], parameters);
     this->memPool->UnregisterEdit(edit);
     return r;
@@ -361,9 +364,9 @@ void Script::Hook_OnRevert(WikiEdit *edit)
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_EDIT_ON_REVERT))
         return;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList parameters;
-    parameters.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    parameters.append(this->memPool->MarshallEdit(edit, this->engine));
     this->executeFunction(this->attachedHooks[HUGGLE_SCRIPT_HOOK_EDIT_ON_REVERT], parameters);
     this->memPool->UnregisterEdit(edit);
 }
@@ -373,9 +376,9 @@ void Script::Hook_OnGood(WikiEdit *edit)
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_EDIT_ON_GOOD))
         return;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList parameters;
-    parameters.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    parameters.append(this->memPool->MarshallEdit(edit, this->engine));
     this->executeFunction(this->attachedHooks[HUGGLE_SCRIPT_HOOK_EDIT_ON_GOOD], parameters);
     this->memPool->UnregisterEdit(edit);
 }
@@ -385,9 +388,9 @@ void Script::Hook_OnSuspicious(WikiEdit *edit)
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_EDIT_ON_SUSPICIOUS))
         return;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList parameters;
-    parameters.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    parameters.append(this->memPool->MarshallEdit(edit, this->engine));
     this->executeFunction(this->attachedHooks[HUGGLE_SCRIPT_HOOK_EDIT_ON_SUSPICIOUS], parameters);
     this->memPool->UnregisterEdit(edit);
 }
@@ -397,9 +400,9 @@ bool Script::Hook_OnRevertPreflight(WikiEdit *edit)
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_REVERT_PREFLIGHT))
         return true;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList parameters;
-    parameters.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    parameters.append(this->memPool->MarshallEdit(edit, this->engine));
     bool rv = this->executeFunctionAsBool(this->attachedHooks[HUGGLE_SCRIPT_HOOK_REVERT_PREFLIGHT], parameters);
     this->memPool->UnregisterEdit(edit);
     return rv;
@@ -410,9 +413,9 @@ int Script::Hook_EditRescore(WikiEdit *edit)
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_EDIT_RESCORE))
         return 0;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList parameters;
-    parameters.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    parameters.append(this->memPool->MarshallEdit(edit, this->engine));
     QJSValue result = this->executeFunction(this->attachedHooks[HUGGLE_SCRIPT_HOOK_EDIT_RESCORE], parameters);
     this->memPool->UnregisterEdit(edit);
     if (!result.isNumber())
@@ -423,14 +426,60 @@ int Script::Hook_EditRescore(WikiEdit *edit)
     return result.toInt();
 }
 
+QList<int> Script::Hook_EditRescoreBatch(const QList<WikiEdit*> &edits)
+{
+    QList<int> scores;
+    if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_EDIT_RESCORE_BATCH))
+    {
+        if (this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_EDIT_RESCORE))
+        {
+            foreach (WikiEdit *edit, edits)
+                scores.append(this->Hook_EditRescore(edit));
+        } else
+        {
+            while (scores.count() < edits.count())
+                scores.append(0);
+        }
+        return scores;
+    }
+
+    QJSValue array = this->engine->newArray(static_cast<uint>(edits.count()));
+    quint32 i = 0;
+    foreach (WikiEdit *edit, edits)
+    {
+        this->memPool->RegisterEdit(edit);
+        array.setProperty(i++, this->memPool->MarshallEdit(edit, this->engine));
+    }
+    QJSValueList parameters;
+    parameters.append(array);
+    QJSValue result = this->executeFunction(this->attachedHooks[HUGGLE_SCRIPT_HOOK_EDIT_RESCORE_BATCH], parameters);
+    foreach (WikiEdit *edit, edits)
+        this->memPool->UnregisterEdit(edit);
+    bool valid = result.isArray() && result.property("length").toInt() == edits.count();
+    if (!valid)
+        HUGGLE_ERROR("JS error (" + this->GetName() + "): edit_rescore_batch must return an array of numbers with one number for each edit");
+    i = 0;
+    while (scores.count() < edits.count())
+    {
+        QJSValue score = valid ? result.property(i++) : QJSValue();
+        if (valid && !score.isNumber())
+        {
+            HUGGLE_ERROR("JS error (" + this->GetName() + "): edit_rescore_batch must return an array of numbers");
+            valid = false;
+        }
+        scores.append(valid ? score.toInt() : 0);
+    }
+    return scores;
+}
+
 void Script::Hook_WarningFinished(WikiEdit *edit)
 {
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_WARNING_FINISHED))
         return;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList parameters;
-    parameters.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    parameters.append(this->memPool->MarshallEdit(edit, this->engine));
     this->executeFunction(this->attachedHooks[HUGGLE_SCRIPT_HOOK_WARNING_FINISHED], parameters);
     this->memPool->UnregisterEdit(edit);
 }
@@ -456,9 +505,9 @@ bool Script::Hook_HAN_Good(WikiEdit *edit, const QString& nick, const QString& i
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_HAN_GOOD))
         return true;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList params;
-    params.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    params.append(this->memPool->MarshallEdit(edit, this->engine));
     params.append(QJSValue(nick));
     params.append(QJSValue(ident));
     params.append(QJSValue(host));
@@ -472,9 +521,9 @@ bool Script::Hook_HAN_Suspicious(WikiEdit *edit, const QString& nick, const QStr
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_HAN_SUSPICIOUS))
         return true;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList params;
-    params.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    params.append(this->memPool->MarshallEdit(edit, this->engine));
     params.append(QJSValue(nick));
     params.append(QJSValue(ident));
     params.append(QJSValue(host));
@@ -488,9 +537,9 @@ bool Script::Hook_HAN_Rescore(WikiEdit *edit, long score, const QString& nick, c
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_HAN_RESCORE))
         return true;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList params;
-    params.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    params.append(this->memPool->MarshallEdit(edit, this->engine));
     params.append(QJSValue(static_cast<double>(score)));
     params.append(QJSValue(nick));
     params.append(QJSValue(ident));
@@ -505,9 +554,9 @@ bool Script::Hook_HAN_Revert(WikiEdit *edit, const QString& nick, const QString&
     if (!this->attachedHooks.contains(HUGGLE_SCRIPT_HOOK_HAN_REVERT))
         return true;
 
-    int pool_id = this->memPool->RegisterEdit(edit);
+    this->memPool->RegisterEdit(edit);
     QJSValueList params;
-    params.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    params.append(this->memPool->MarshallEdit(edit, this->engine));
     params.append(QJSValue(nick));
     params.append(QJSValue(ident));
     params.append(QJSValue(host));
@@ -532,6 +581,7 @@ bool Script::Hook_HAN_Message(WikiSite *w, const QString& message, const QString
 
 void Script::SubscribeHook(int hook, const QString& function_name)
 {
+    this->disabledHooks.remove(hook);
     if (this->attachedHooks.contains(hook))
         this->attachedHooks[hook] = function_name;
     else
@@ -540,6 +590,7 @@ void Script::SubscribeHook(int hook, const QString& function_name)
 
 void Script::UnsubscribeHook(int hook)
 {
+    this->disabledHooks.remove(hook);
     if (this->attachedHooks.contains(hook))
         this->attachedHooks.remove(hook);
 }
@@ -565,6 +616,8 @@ int Script::GetHookID(const QString &hook)
         return HUGGLE_SCRIPT_HOOK_EDIT_LOAD_TO_QUEUE;
     if (hook == "edit_rescore")
         return HUGGLE_SCRIPT_HOOK_EDIT_RESCORE;
+    if (hook == "edit_rescore_batch")
+        return HUGGLE_SCRIPT_HOOK_EDIT_RESCORE_BATCH;
     if (hook == "edit_post_process")
         return HUGGLE_SCRIPT_HOOK_EDIT_POST_PROCESS;
     if (hook == "edit_on_revert")
@@ -595,6 +648,45 @@ int Script::GetHookID(const QString &hook)
     return -1;
 }
 
+QString Script::GetHookOfFunction(const QString &function)
+{
+    foreach (QString hook, this->hooksExported)
+    {
+        int id = this->GetHookID(hook);
+        if (id < 0)
+            continue;
+        if (this->attachedHooks.value(id) == function || this->disabledHooks.value(id) == function)
+            return hook;
+    }
+    return "";
+}
+
+QHash<QString, ScriptFunctionStatistics> Script::GetStatistics()
+{
+    return this->statistics;
+}
+
+void Script::ResetStatistics()
+{
+    this->statistics.clear();
+}
+
+QHash<int, QString> Script::GetDisabledHooks()
+{
+    return this->disabledHooks;
+}
+
+void Script::EnableDisabledHooks()
+{
+    QHash<int, QString> hooks = this->disabledHooks;
+    foreach (int hook, hooks.keys())
+    {
+        this->SubscribeHook(hook, hooks[hook]);
+        if (this->statistics.contains(hooks[hook]))
+            this->statistics[hooks[hook]].ConsecutiveOverruns = 0;
+    }
+}
+
 bool Script::loadSource(QString source, QString *error)
 {
     // Prepend the built-in libs
@@ -752,7 +844,10 @@ QJSValue Script::executeFunction(const QString &function, const QJSValueList &pa
         HUGGLE_ERROR("JS error (" + this->GetName() + "): " + function + " is not a function");
         return fc;
     }
+    QElapsedTimer timer;
+    timer.start();
     QJSValue result = fc.call(parameters);
+    this->recordCall(function, timer.nsecsElapsed());
     if (result.isError())
     {
         // There was some error during execution
@@ -768,6 +863,42 @@ QJSValue Script::executeFunction(const QString& function)
     return this->executeFunction(function, QJSValueList());
 }
 
+void Script::recordCall(const QString &function, qint64 time)
+{
+    ScriptFunctionStatistics &stats = this->statistics[function];
+    stats.Calls++;
+    stats.TotalTime += time;
+    if (time > stats.MaxTime)
+        stats.MaxTime = time;
+    qint64 budget = static_cast<qint64>(hcfg->SystemConfig_ScriptBudget) * 1000000;
+    if (budget <= 0 || time <= budget)
+    {
+        stats.ConsecutiveOverruns = 0;
+        return;
+    }
+    stats.Overruns++;
+    stats.ConsecutiveOverruns++;
+    // Slow hook is usually slow on every call, so only first overrun in a row is logged to not flood the log
+    if (stats.ConsecutiveOverruns == 1)
+    {
+        HUGGLE_WARNING("Script " + this->GetName() + ": " + function + " took " + QString::number(time / 1000000) + " ms, budget is "
+                       + QString::number(hcfg->SystemConfig_ScriptBudget) + " ms");
+    }
+    if (!hcfg->SystemConfig_ScriptBudgetDisable || stats.ConsecutiveOverruns < hcfg->SystemConfig_ScriptBudgetOverruns)
+        return;
+    // Only hooks are disabled, functions like ext_is_working are needed for script to work at all
+    QList<int> hooks = this->attachedHooks.keys(function);
+    if (hooks.isEmpty())
+        return;
+    foreach (int hook, hooks)
+    {
+        this->attachedHooks.remove(hook);
+        this->disabledHooks.insert(hook, function);
+    }
+    HUGGLE_WARNING("Script " + this->GetName() + ": " + function + " exceeded the budget " + QString::number(stats.ConsecutiveOverruns)
+                   + " times in a row, hooks that use it were disabled");
+}
+
 void Script::registerClass(const QString &name, GenericJSClass *c)
 {
     QHash<QString, QString> functions = c->GetFunctions();
@@ -837,6 +968,7 @@ void Script::registerFunctions()
     this->registerHook("edit_on_good", 1, "(WikiEdit edit): on good edit");
     this->registerHook("edit_on_revert", 1, "(WikiEdit edit): edit reverted");
     this->registerHook("edit_rescore", 1, "(WikiEdit edit) - returns int: called after post processing the edit, number returned will be added to final score (3.4.2)");
+    this->registerHook("edit_rescore_batch", 1, "(WikiEdit[] edits) - returns int[]: same as edit_rescore, but called once for all edits that finished post processing at same time, must return one number for each edit in same order. If script has this hook, edit_rescore is not used for rescoring");
     this->registerHook("warning_finished", 1, "(WikiEdit edit): called when warning to user is sent");
     this->registerHook("revert_preflight", 1, "(WikiEdit edit) - returns bool: run before edit is reverted, if false is returned, revert is stopped");
     this->registerHook("han_good", 4, "(WikiEdit edit, string nick, string ident, string host) - returns bool: called when someone sends HAN command, has to return true, otherwise message is ignored");
@@ -851,6 +983,11 @@ ScriptException::ScriptException(const QString &text, const QString &source, Scr
     this->s = scr;
 }
 
+ScriptMemPool::~ScriptMemPool()
+{
+    this->ClearEditCache();
+}
+
 WikiEdit *ScriptMemPool::GetEdit(int edit)
 {
     if (!this->intToEditMap.contains(edit))
@@ -872,6 +1009,46 @@ int ScriptMemPool::RegisterEdit(WikiEdit *edit)
     return edit_id;
 }
 
+int ScriptMemPool::GetID(WikiEdit *edit)
+{
+    return this->editToIntMap.value(edit, -1);
+}
+
+QJSValue ScriptMemPool::MarshallEdit(WikiEdit *edit, QJSEngine *engine)
+{
+    if (!edit)
+        return QJSValue(false);
+    if (this->editCacheValues.contains(edit))
+        return this->editCacheValues[edit];
+
+    while (this->editCacheOrder.count() >= HUGGLE_SCRIPT_EDIT_CACHE_SIZE)
+        this->releaseCachedEdit(this->editCacheOrder.dequeue());
+
+    // cached object keeps the edit alive, so that pointer in it is always valid
+    edit->RegisterConsumer(HUGGLECONSUMER_JS_CACHE);
+    JSWikiEdit *object = new JSWikiEdit(edit, engine, this);
+    QJSValue value = engine->newQObject(object);
+    this->editCache.insert(edit, object);
+    this->editCacheValues.insert(edit, value);
+    this->editCacheOrder.enqueue(edit);
+    return value;
+}
+
+void ScriptMemPool::ClearEditCache()
+{
+    while (!this->editCacheOrder.isEmpty())
+        this->releaseCachedEdit(this->editCacheOrder.dequeue());
+}
+
+void ScriptMemPool::releaseCachedEdit(WikiEdit *edit)
+{
+    // script may still hold a reference to the object, which is owned by engine, so we only detach it
+    this->editCache[edit]->Detach();
+    this->editCache.remove(edit);
+    this->editCacheValues.remove(edit);
+    edit->UnregisterConsumer(HUGGLECONSUMER_JS_CACHE);
+}
+
 bool ScriptMemPool::UnregisterEdit(WikiEdit *edit)
 {
     if (!this->editToIntMap.contains(edit))
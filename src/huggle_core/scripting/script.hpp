@@ -18,6 +18,7 @@
 #include "../definitions.hpp"
 #include "../exception.hpp"
 #include <QJSEngine>
+#include <QQueue>
 #include <QUrl>
 
 // This is here for performance reasons only, we could have a list of attached hooks as list of strings
@@ -46,11 +47,16 @@
 #define HUGGLE_SCRIPT_HOOK_HAN_MESSAGE                          16
 #define HUGGLE_SCRIPT_HOOK_HAN_RESCORE                          17
 #define HUGGLE_SCRIPT_HOOK_HAN_SUSPICIOUS                       18
-                                                                // 20 (19 already in use)
+#define HUGGLE_SCRIPT_HOOK_EDIT_RESCORE_BATCH                   20
+                                                                // 21
+
+//! Number of edits whose JS objects are kept by each script, see ScriptMemPool::MarshallEdit
+#define HUGGLE_SCRIPT_EDIT_CACHE_SIZE                           200
 
 namespace Huggle
 {
     class GenericJSClass;
+    class JSWikiEdit;
     class Script;
     class ScriptFunctionHelp;
     class WikiEdit;
@@ -79,17 +85,52 @@ namespace Huggle
      * to JS code. This class allows safe registering of C++ pointers and conversion of pool_id's back to pointers.
      *
      * The lifespan of pool_id is typically very short, just for a period of hook execution.
+     *
+     * The pool also keeps JS objects of recently used edits, so that an edit that is passed to several hooks of same
+     * script is marshalled only once, see MarshallEdit().
      */
     class HUGGLE_EX_CORE ScriptMemPool
     {
         public:
+            ~ScriptMemPool();
             WikiEdit *GetEdit(int edit);
+            //! Returns pool_id of edit or -1 if it isn't registered
+            int GetID(WikiEdit *edit);
             int RegisterEdit(WikiEdit *edit);
             bool UnregisterEdit(WikiEdit *edit);
+            /*!
+             * \brief Returns JS object that represents the edit in engine
+             *
+             * Object is created only once for every edit and its properties are read from the edit lazily, see JSWikiEdit.
+             * Edits are kept alive while their object is cached, least recently created objects are dropped when there is
+             * more than HUGGLE_SCRIPT_EDIT_CACHE_SIZE of them.
+             */
+            QJSValue MarshallEdit(WikiEdit *edit, QJSEngine *engine);
+            //! Detach all cached objects from their edits and release them
+            void ClearEditCache();
         private:
+            void releaseCachedEdit(WikiEdit *edit);
             int lastEdit = 0;
             QHash<WikiEdit*, int> editToIntMap;
             QHash<int, WikiEdit*> intToEditMap;
+            QHash<WikiEdit*, JSWikiEdit*> editCache;
+            QHash<WikiEdit*, QJSValue> editCacheValues;
+            QQueue<WikiEdit*> editCacheOrder;
+    };
+
+    //! Time spent in one function of a script, see Script::GetStatistics()
+    class HUGGLE_EX_CORE ScriptFunctionStatistics
+    {
+        public:
+            unsigned long long Calls = 0;
+            //! Cumulative time of all calls in ns
+            qint64 TotalTime = 0;
+            //! Longest call in ns
+            qint64 MaxTime = 0;
+            //! Number of calls that took longer than SystemConfig_ScriptBudget
+            unsigned long long Overruns = 0;
+            //! Overruns in a row, every call that fits in budget resets this
+            int ConsecutiveOverruns = 0;
     };
 
     class HUGGLE_EX_CORE Script : public QObject
@@ -144,6 +185,11 @@ namespace Huggle
             void Hook_OnSuspicious(WikiEdit *edit);
             bool Hook_OnRevertPreflight(WikiEdit *edit);
             int Hook_EditRescore(WikiEdit *edit);
+            /*!
+             * \brief Rescore all edits in one call of edit_rescore_batch, if script doesn't have it edit_rescore is called for every edit
+             * \return Scores in same order as edits, 0 for edits that script didn't score
+             */
+            QList<int> Hook_EditRescoreBatch(const QList<WikiEdit*> &edits);
             void Hook_WarningFinished(WikiEdit *edit);
             void Hook_OnLocalConfigRead();
             void Hook_OnLocalConfigWrite();
@@ -156,6 +202,15 @@ namespace Huggle
             void UnsubscribeHook(int hook);
             bool HookSubscribed(int hook);
             virtual int GetHookID(const QString &hook);
+            //! Returns name of hook that is handled by function, or empty string if function isn't a hook
+            QString GetHookOfFunction(const QString &function);
+            //! Call counts and times of all functions that were executed, indexed by name of function
+            QHash<QString, ScriptFunctionStatistics> GetStatistics();
+            void ResetStatistics();
+            //! Hooks that were disabled because they were repeatedly exceeding the budget, with names of their functions
+            QHash<int, QString> GetDisabledHooks();
+            //! Subscribe all disabled hooks again
+            void EnableDisabledHooks();
         protected:
             static QList<QString> loadedPaths;
             static QHash<QString, Script*> scripts;
@@ -166,6 +221,8 @@ namespace Huggle
             QString executeFunctionAsString(const QString &function, const QJSValueList &parameters);
             QJSValue executeFunction(const QString &function, const QJSValueList &parameters);
             QJSValue executeFunction(const QString& function);
+            //! Update statistics of function and disable hooks that use it if they are too slow
+            void recordCall(const QString &function, qint64 time);
             virtual void registerFunction(const QString &name, const QString &help = "", bool is_unsafe = false);
             virtual void registerClass(const QString &name, GenericJSClass *c);
             virtual void registerClasses();
@@ -191,6 +248,8 @@ namespace Huggle
             bool isLoaded;
             bool isUnsafe;
             QHash<int, QString> attachedHooks;
+            QHash<int, QString> disabledHooks;
+            QHash<QString, ScriptFunctionStatistics> statistics;
     };
 }
 
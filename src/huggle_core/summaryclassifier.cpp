@@ -0,0 +1,80 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "summaryclassifier.hpp"
+#include "projectconfiguration.hpp"
+#include "syslog.hpp"
+
+using namespace Huggle;
+
+SummaryClassifier::SummaryClassifier()
+{
+
+}
+
+void SummaryClassifier::Compile(const QStringList &revert_patterns, const QStringList &assisted, const QString &huggle_suffix)
+{
+    QStringList valid_patterns;
+    foreach (QString pattern, revert_patterns)
+    {
+        // one broken pattern would break the whole expression, so we need to check them one by one
+        QRegularExpression expression(pattern);
+        if (!expression.isValid())
+        {
+            Syslog::HuggleLogs->WarningLog("Invalid revert pattern " + pattern + ": " + expression.errorString());
+            continue;
+        }
+        valid_patterns.append("(?:" + pattern + ")");
+    }
+    this->hasRevertPatterns = !valid_patterns.isEmpty();
+    this->revertPatterns.setPattern(valid_patterns.join("|"));
+    if (this->hasRevertPatterns)
+        this->revertPatterns.optimize();
+
+    QList<ScoreWord> assisted_words;
+    this->assistedAlways = false;
+    foreach (QString summary, assisted)
+    {
+        if (summary.isEmpty())
+            this->assistedAlways = true;
+        else
+            assisted_words.append(ScoreWord(summary, HUGGLE_SUMMARY_ASSISTED));
+    }
+    QList<ScoreWord> huggle_words;
+    huggle_words.append(ScoreWord(huggle_suffix, HUGGLE_SUMMARY_HUGGLE));
+    this->literals.Clear();
+    this->assistedList = this->literals.AddList(assisted_words, false);
+    this->huggleList = this->literals.AddList(huggle_words, false);
+    this->literals.Compile(QStringList());
+}
+
+int SummaryClassifier::Classify(const QString &summary) const
+{
+    int flags = 0;
+    if (this->IsRevert(summary))
+        flags |= HUGGLE_SUMMARY_REVERT;
+    if (this->assistedAlways)
+        flags |= HUGGLE_SUMMARY_ASSISTED;
+    if (summary.isEmpty())
+        return flags;
+    QVector<unsigned char> hits = this->literals.Match(summary);
+    if (this->literals.IsMatched(this->assistedList, hits))
+        flags |= HUGGLE_SUMMARY_ASSISTED;
+    if (this->literals.IsMatched(this->huggleList, hits))
+        flags |= HUGGLE_SUMMARY_HUGGLE;
+    return flags;
+}
+
+bool SummaryClassifier::IsRevert(const QString &summary) const
+{
+    if (!this->hasRevertPatterns || summary.isEmpty())
+        return false;
+    return this->revertPatterns.match(summary).hasMatch();
+}
@@ -0,0 +1,56 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef SUMMARYCLASSIFIER_HPP
+#define SUMMARYCLASSIFIER_HPP
+
+#include "definitions.hpp"
+
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include "scorewordmatcher.hpp"
+
+//! Summary matches one of revert patterns
+#define HUGGLE_SUMMARY_REVERT           1
+//! Summary contains one of summaries of assisted tools
+#define HUGGLE_SUMMARY_ASSISTED         2
+//! Summary contains suffix of huggle
+#define HUGGLE_SUMMARY_HUGGLE           4
+
+namespace Huggle
+{
+    /*!
+     * \brief Classifies edit summaries using rules of one project
+     *
+     * Revert patterns are joined into a single regular expression and summaries of assisted tools together with
+     * the suffix of huggle are compiled into one ScoreWordMatcher, so that every summary is checked in one pass
+     * of each of them, instead of matching every pattern separately.
+     */
+    class HUGGLE_EX_CORE SummaryClassifier
+    {
+        public:
+            SummaryClassifier();
+            void Compile(const QStringList &revert_patterns, const QStringList &assisted, const QString &huggle_suffix);
+            //! Returns combination of HUGGLE_SUMMARY_ flags that apply to summary
+            int Classify(const QString &summary) const;
+            bool IsRevert(const QString &summary) const;
+        private:
+            QRegularExpression revertPatterns;
+            bool hasRevertPatterns = false;
+            ScoreWordMatcher literals;
+            int assistedList = -1;
+            int huggleList = -1;
+            //! Empty summary of assisted tool is contained in every summary
+            bool assistedAlways = false;
+    };
+}
+
+#endif // SUMMARYCLASSIFIER_HPP
@@ -146,6 +146,49 @@ bool TerminalParser::Parse()
             }
             valid = true;
         }
+        if (text == "--feed-record")
+        {
+            if (this->args.count() > x + 1 && !this->args.at(x + 1).startsWith("-"))
+            {
+                hcfg->FeedRecordPath = this->args.at(x + 1);
+                valid = true;
+                ++x;
+            } else
+            {
+                cerr << "Parameter --feed-record requires an argument for it to work!" << endl;
+                return true;
+            }
+        }
+        if (text == "--feed-replay")
+        {
+            if (this->args.count() > x + 1 && !this->args.at(x + 1).startsWith("-"))
+            {
+                hcfg->FeedReplayPath = this->args.at(x + 1);
+                valid = true;
+                ++x;
+                if (this->args.count() > x + 1 && !this->args.at(x + 1).startsWith("-"))
+                {
+                    ++x;
+                    if (this->args.at(x) == "max")
+                    {
+                        hcfg->FeedReplaySpeed = 0;
+                    } else
+                    {
+                        bool ok;
+                        hcfg->FeedReplaySpeed = this->args.at(x).toDouble(&ok);
+                        if (!ok || hcfg->FeedReplaySpeed <= 0)
+                        {
+                            cerr << "Invalid speed for --feed-replay: " << this->args.at(x).toStdString() << endl;
+                            return true;
+                        }
+                    }
+                }
+            } else
+            {
+                cerr << "Parameter --feed-replay requires an argument for it to work!" << endl;
+                return true;
+            }
+        }
         if (text == "--chroot")
         {
             if (this->args.count() > x + 1 && !this->args.at(x + 1).startsWith("-"))
@@ -281,6 +324,11 @@ void TerminalParser::DisplayHelp()
             "                   developers and people who create localization files\n"\
             "  --dot:           Debug on terminal only mode\n"\
             "  --qd [file]:     Write all transferred data to a file\n"\
+            "  --feed-record <file>:\n"\
+            "                   Record every line received from irc and XmlRcs feeds to a file\n"\
+            "  --feed-replay <file> [speed]:\n"\
+            "                   Replay a file recorded using --feed-record instead of live feed, speed\n"\
+            "                   is a multiplier of real time (default 1) or max for fastest replay\n"\
             "  --override-conf [page]:\n"\
             "                   Will override the wiki configuration path, useful for testing of new config\n"\
             "\nJS related:\n"\
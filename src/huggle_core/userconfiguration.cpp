@@ -406,6 +406,7 @@ bool UserConfiguration::Parse(const QString& config, ProjectConfiguration *Proje
     this->RevertOnMultipleEdits = SafeBool(ConfigurationParse("RevertOnMultipleEdits", config));
     ProjectConfig->EnableAll = SafeBool(ConfigurationParse("enable", config));
     ProjectConfig->Ignores = HuggleParser::ConfigurationParse_QL("ignore", config, ProjectConfig->Ignores);
+    ProjectConfig->CompileIgnores();
     // this is a hack so that we can access this value more directly, it can't be changed in huggle
     // so there is no point in using a hash for it
     ProjectConfig->IPScore = this->SetOption(ProjectConfig_IPScore_Key, config, ProjectConfig->IPScore).toLongLong();
@@ -431,6 +432,7 @@ bool UserConfiguration::Parse(const QString& config, ProjectConfiguration *Proje
     this->HighlightSummaryIfExists = SafeBool(ConfigurationParse("SummaryMode", config), this->HighlightSummaryIfExists);
     ProjectConfig->ScoreTalk = this->SetOption("score-talk", config, ProjectConfig->ScoreTalk).toLongLong();
     ProjectConfig->WarningDefs = this->SetUserOptionList("warning-template-tags", config, ProjectConfig->WarningDefs);
+    ProjectConfig->CompileWarningDefs();
     ProjectConfig->BotScore = this->SetOption("score-bot", config, ProjectConfig->BotScore).toLongLong();
     if (!HuggleQueueFilter::Filters.contains(ProjectConfig->Site))
         throw new Huggle::Exception("There is no such a wiki", BOOST_CURRENT_FUNCTION);
@@ -551,6 +553,7 @@ bool UserConfiguration::ParseYAML(const QString &config, ProjectConfiguration *P
     if (!YAML2Bool("enable", yaml, true))
         ProjectConfig->EnableAll = false;
     ProjectConfig->Ignores = YAML2QStringList("ignore", yaml, ProjectConfig->Ignores);
+    ProjectConfig->CompileIgnores();
     // SetOption functions allow us to preserve information whether the value was changed or is default, this is there because some options
     // which are in project config can be overloaded by user config, but we only want to store them in user config if they were modified
     // by user, so that by default we are always using the project config version (unless user wanted to modify them)
@@ -577,6 +580,7 @@ bool UserConfiguration::ParseYAML(const QString &config, ProjectConfiguration *P
     this->HighlightSummaryIfExists = YAML2Bool("summary-mode", yaml, this->HighlightSummaryIfExists);
     ProjectConfig->ScoreTalk = this->SetOptionYAML("score-talk", yaml, ProjectConfig->ScoreTalk).toLongLong();
     ProjectConfig->WarningDefs = this->SetUserOptionListYAML("warning-template-tags", yaml, ProjectConfig->WarningDefs);
+    ProjectConfig->CompileWarningDefs();
     ProjectConfig->BotScore = this->SetOptionYAML("score-bot", yaml, ProjectConfig->BotScore).toLongLong();
     if (!HuggleQueueFilter::Filters.contains(ProjectConfig->Site))
         throw new Huggle::Exception("There is no such a wiki in queue filters hash table", BOOST_CURRENT_FUNCTION);
@@ -0,0 +1,341 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "userreputation.hpp"
+#include <QDateTime>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cstring>
+#include "configuration.hpp"
+#include "syslog.hpp"
+
+using namespace Huggle;
+
+#define HUGGLE_REPUTATION_MAGIC         "HGRS"
+#define HUGGLE_REPUTATION_VERSION       1
+#define HUGGLE_REPUTATION_HEADER        8
+// expiry, score, warning level, flags and lengths of site and user name, these follow the length of record
+#define HUGGLE_REPUTATION_FIXED         18
+#define HUGGLE_REPUTATION_REPORTED      1
+#define HUGGLE_REPUTATION_REMOVED       2
+// file is compacted when it has more dead records than live ones, but not when there are only few of them
+#define HUGGLE_REPUTATION_COMPACT_MIN   256
+
+QString UserReputation::path;
+QFile *UserReputation::file = nullptr;
+uchar *UserReputation::map = nullptr;
+qint64 UserReputation::mapSize = 0;
+QHash<UserReputation::Key, qint64> UserReputation::index;
+QHash<UserReputation::Key, UserReputationRecord> UserReputation::appended;
+int UserReputation::records = 0;
+QMutex UserReputation::lock;
+
+static qint64 currentTime()
+{
+    return QDateTime::currentDateTimeUtc().toMSecsSinceEpoch() / 1000;
+}
+
+static QByteArray encodeHeader()
+{
+    QByteArray header(HUGGLE_REPUTATION_MAGIC);
+    header.resize(HUGGLE_REPUTATION_HEADER);
+    qToLittleEndian<quint32>(HUGGLE_REPUTATION_VERSION, reinterpret_cast<uchar*>(header.data() + 4));
+    return header;
+}
+
+static QByteArray encodeRecord(const QString &site, const QString &user, const UserReputationRecord &record, bool removal)
+{
+    QByteArray site_ = site.toUtf8();
+    QByteArray user_ = user.toUtf8();
+    quint32 length = HUGGLE_REPUTATION_FIXED + site_.size() + user_.size();
+    QByteArray data(4 + length, 0);
+    uchar *p = reinterpret_cast<uchar*>(data.data());
+    uchar flags = 0;
+    if (record.IsReported)
+        flags |= HUGGLE_REPUTATION_REPORTED;
+    if (removal)
+        flags |= HUGGLE_REPUTATION_REMOVED;
+    qToLittleEndian<quint32>(length, p);
+    qToLittleEndian<qint64>(record.Expires, p + 4);
+    qToLittleEndian<qint32>(static_cast<qint32>(record.BadnessScore), p + 12);
+    p[16] = static_cast<uchar>(record.WarningLevel);
+    p[17] = flags;
+    qToLittleEndian<quint16>(static_cast<quint16>(site_.size()), p + 18);
+    qToLittleEndian<quint16>(static_cast<quint16>(user_.size()), p + 20);
+    memcpy(p + 22, site_.constData(), site_.size());
+    memcpy(p + 22 + site_.size(), user_.constData(), user_.size());
+    return data;
+}
+
+// returns size of record at offset or 0 if it's incomplete, which happens when huggle crashed while writing it
+static qint64 decodeRecord(const uchar *data, qint64 size, qint64 offset, QString *site, QString *user, UserReputationRecord *record,
+                           bool *removal)
+{
+    if (size - offset < 4 + HUGGLE_REPUTATION_FIXED)
+        return 0;
+    const uchar *p = data + offset;
+    quint32 length = qFromLittleEndian<quint32>(p);
+    if (length < HUGGLE_REPUTATION_FIXED || size - offset - 4 < length)
+        return 0;
+    quint16 site_length = qFromLittleEndian<quint16>(p + 18);
+    quint16 user_length = qFromLittleEndian<quint16>(p + 20);
+    if (HUGGLE_REPUTATION_FIXED + site_length + user_length != length)
+        return 0;
+    record->Expires = qFromLittleEndian<qint64>(p + 4);
+    record->BadnessScore = qFromLittleEndian<qint32>(p + 12);
+    record->WarningLevel = static_cast<byte_ht>(p[16]);
+    record->IsReported = (p[17] & HUGGLE_REPUTATION_REPORTED) != 0;
+    if (removal)
+        *removal = (p[17] & HUGGLE_REPUTATION_REMOVED) != 0;
+    if (site)
+        *site = QString::fromUtf8(reinterpret_cast<const char*>(p + 22), site_length);
+    if (user)
+        *user = QString::fromUtf8(reinterpret_cast<const char*>(p + 22 + site_length), user_length);
+    return 4 + length;
+}
+
+bool UserReputationRecord::operator==(const UserReputationRecord &record) const
+{
+    // expiry is not part of reputation, it only says how long we trust it
+    return this->BadnessScore == record.BadnessScore && this->WarningLevel == record.WarningLevel && this->IsReported == record.IsReported;
+}
+
+bool UserReputation::Open(const QString &path)
+{
+    QMutexLocker locker(&lock);
+    unload();
+    UserReputation::path = path;
+    if (!load())
+        return false;
+    if (needsCompaction())
+        compact();
+    return file != nullptr;
+}
+
+void UserReputation::Close()
+{
+    QMutexLocker locker(&lock);
+    if (!file)
+        return;
+    if (needsCompaction())
+        compact();
+    unload();
+}
+
+bool UserReputation::IsOpen()
+{
+    QMutexLocker locker(&lock);
+    return file != nullptr;
+}
+
+bool UserReputation::Lookup(const QString &site, const QString &user, UserReputationRecord *record)
+{
+    QMutexLocker locker(&lock);
+    if (!file)
+        return false;
+    return lookup(key(site, user), record);
+}
+
+void UserReputation::Store(const QString &site, const QString &user, const UserReputationRecord &record)
+{
+    QMutexLocker locker(&lock);
+    if (!file)
+        return;
+    Key k = key(site, user);
+    UserReputationRecord current;
+    // we don't need to write same record again, unless it would expire at least one day sooner
+    if (lookup(k, &current) && current == record && current.Expires + 86400 > record.Expires)
+        return;
+    append(k, record, false);
+    if (needsCompaction())
+        compact();
+}
+
+void UserReputation::Remove(const QString &site, const QString &user)
+{
+    QMutexLocker locker(&lock);
+    if (!file)
+        return;
+    Key k = key(site, user);
+    if (index.contains(k) || appended.contains(k))
+        append(k, UserReputationRecord(), true);
+}
+
+bool UserReputation::Compact()
+{
+    QMutexLocker locker(&lock);
+    if (!file)
+        return false;
+    return compact();
+}
+
+int UserReputation::Count()
+{
+    QMutexLocker locker(&lock);
+    return index.count() + appended.count();
+}
+
+UserReputation::Key UserReputation::key(const QString &site, const QString &user)
+{
+    QString name = user;
+    return Key(site, name.replace(" ", "_"));
+}
+
+bool UserReputation::load()
+{
+    file = new QFile(path);
+    if (!file->open(QIODevice::ReadWrite))
+    {
+        HUGGLE_WARNING("Unable to open user reputation store " + path + ": " + file->errorString());
+        delete file;
+        file = nullptr;
+        return false;
+    }
+    qint64 size = file->size();
+    if (size > 0)
+    {
+        QByteArray header = file->read(HUGGLE_REPUTATION_HEADER);
+        if (header != encodeHeader())
+        {
+            HUGGLE_WARNING(path + " is not a user reputation store of this version, starting with empty one");
+            file->resize(0);
+            size = 0;
+        }
+    }
+    if (size == 0)
+    {
+        file->seek(0);
+        file->write(encodeHeader());
+        file->flush();
+        size = HUGGLE_REPUTATION_HEADER;
+    }
+    map = file->map(0, size);
+    if (!map)
+    {
+        HUGGLE_WARNING("Unable to map user reputation store " + path + ": " + file->errorString());
+        unload();
+        return false;
+    }
+    qint64 now = currentTime();
+    qint64 offset = HUGGLE_REPUTATION_HEADER;
+    while (offset < size)
+    {
+        Key k;
+        UserReputationRecord record;
+        bool removal;
+        qint64 length = decodeRecord(map, size, offset, &k.first, &k.second, &record, &removal);
+        if (length == 0)
+            break;
+        records++;
+        // newer record always replaces older one
+        if (removal || record.Expires < now)
+            index.remove(k);
+        else
+            index.insert(k, offset);
+        offset += length;
+    }
+    if (offset < size)
+    {
+        HUGGLE_WARNING("User reputation store " + path + " ends with incomplete record, which was removed");
+        file->unmap(map);
+        file->resize(offset);
+        size = offset;
+        map = file->map(0, size);
+        if (!map)
+        {
+            unload();
+            return false;
+        }
+    }
+    mapSize = size;
+    file->seek(size);
+    HUGGLE_DEBUG1("Loaded " + QString::number(index.count()) + " user reputation records from " + path);
+    return true;
+}
+
+void UserReputation::unload()
+{
+    if (file)
+    {
+        if (map)
+            file->unmap(map);
+        file->close();
+        delete file;
+    }
+    file = nullptr;
+    map = nullptr;
+    mapSize = 0;
+    index.clear();
+    appended.clear();
+    records = 0;
+}
+
+bool UserReputation::needsCompaction()
+{
+    int dead = records - index.count() - appended.count();
+    return dead > HUGGLE_REPUTATION_COMPACT_MIN && dead > index.count() + appended.count();
+}
+
+bool UserReputation::compact()
+{
+    qint64 now = currentTime();
+    QByteArray data = encodeHeader();
+    QHash<Key, qint64>::const_iterator i = index.constBegin();
+    while (i != index.constEnd())
+    {
+        UserReputationRecord record;
+        decodeRecord(map, mapSize, i.value(), nullptr, nullptr, &record, nullptr);
+        if (record.Expires >= now)
+            data += encodeRecord(i.key().first, i.key().second, record, false);
+        ++i;
+    }
+    QHash<Key, UserReputationRecord>::const_iterator a = appended.constBegin();
+    while (a != appended.constEnd())
+    {
+        if (a.value().Expires >= now)
+            data += encodeRecord(a.key().first, a.key().second, a.value(), false);
+        ++a;
+    }
+    // the file must not be open while it's replaced, otherwise it wouldn't work on windows
+    unload();
+    QSaveFile out(path);
+    bool result = out.open(QIODevice::WriteOnly) && out.write(data) == data.size() && out.commit();
+    if (!result)
+        HUGGLE_WARNING("Unable to compact user reputation store " + path + ": " + out.errorString());
+    if (!load())
+        return false;
+    return result;
+}
+
+bool UserReputation::lookup(const Key &key, UserReputationRecord *record)
+{
+    if (appended.contains(key))
+    {
+        *record = appended[key];
+    } else if (index.contains(key))
+    {
+        decodeRecord(map, mapSize, index[key], nullptr, nullptr, record, nullptr);
+    } else
+    {
+        return false;
+    }
+    return record->Expires >= currentTime();
+}
+
+void UserReputation::append(const Key &key, const UserReputationRecord &record, bool removal)
+{
+    file->write(encodeRecord(key.first, key.second, record, removal));
+    records++;
+    index.remove(key);
+    if (removal)
+        appended.remove(key);
+    else
+        appended.insert(key, record);
+}
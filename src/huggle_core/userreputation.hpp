@@ -0,0 +1,84 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef USERREPUTATION_HPP
+#define USERREPUTATION_HPP
+
+#include "definitions.hpp"
+
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+namespace Huggle
+{
+    //! Reputation of one user as it's remembered between sessions
+    class HUGGLE_EX_CORE UserReputationRecord
+    {
+        public:
+            bool operator==(const UserReputationRecord &record) const;
+            long BadnessScore = 0;
+            byte_ht WarningLevel = 0;
+            bool IsReported = false;
+            //! Time when the record is no longer valid, in seconds since epoch (UTC)
+            qint64 Expires = 0;
+    };
+
+    /*!
+     * \brief Persistent store of reputation of users, so that known vandals are recognized right after start
+     *
+     * Records are appended to a log file, which is memory mapped when it's opened. Only position of each record
+     * is kept in memory, records that were written in current session are kept in memory until next compaction.
+     * Every update or removal of user leaves the old record in the file, so the file is rewritten with live records
+     * only once there are more dead records than live ones.
+     */
+    class HUGGLE_EX_CORE UserReputation
+    {
+        public:
+            //! Open the store, existing file is indexed and expired records are skipped, returns false if it can't be open
+            static bool Open(const QString &path);
+            //! Close the store, the file is compacted first if it contains too many dead records
+            static void Close();
+            static bool IsOpen();
+            //! Returns true and fills the record if user has a record that didn't expire yet
+            static bool Lookup(const QString &site, const QString &user, UserReputationRecord *record);
+            //! Insert or update a record of user, record that is same as the one that is already stored is not written
+            static void Store(const QString &site, const QString &user, const UserReputationRecord &record);
+            static void Remove(const QString &site, const QString &user);
+            //! Rewrite the file so that it contains only live records
+            static bool Compact();
+            //! Number of live records
+            static int Count();
+        private:
+            typedef QPair<QString, QString> Key;
+            static Key key(const QString &site, const QString &user);
+            static bool load();
+            static void unload();
+            static bool needsCompaction();
+            static bool compact();
+            static bool lookup(const Key &key, UserReputationRecord *record);
+            static void append(const Key &key, const UserReputationRecord &record, bool removal);
+            static QString path;
+            static QFile *file;
+            static uchar *map;
+            static qint64 mapSize;
+            //! Offsets of records in mapped part of the file
+            static QHash<Key, qint64> index;
+            //! Records that were written after the file was mapped
+            static QHash<Key, UserReputationRecord> appended;
+            //! Number of all records in file, including these which were replaced by newer record or removed
+            static int records;
+            static QMutex lock;
+    };
+}
+
+#endif // USERREPUTATION_HPP
@@ -246,7 +246,10 @@ void Warnings::ResendWarnings()
                         {
                             TPRevBaseTime = e.attribute("timestamp");
                         }
-                        warning->RelatedEdit->User->TalkPage_SetContents(e.text());
+                        revid_ht revision = WIKI_UNKNOWN_REVID;
+                        if (e.attributes().contains("revid"))
+                            revision = e.attribute("revid").toLongLong();
+                        warning->RelatedEdit->User->TalkPage_SetContents(e.text(), revision);
                     } else
                     {
                         // there was some error, which suck, we print it to console and delete this warning, there is a little point
@@ -329,7 +332,7 @@ void Warnings::ResendWarnings()
                     Syslog::HuggleLogs->DebugLog("Possible memory leak in MainWindow::ResendWarning: warning->Query != nullptr");
                 }
                 warning->Query = new Huggle::ApiQuery(ActionQuery, warning->RelatedEdit->GetSite());
-                warning->Query->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("timestamp|user|comment|content") +
+                warning->Query->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|timestamp|user|comment|content") +
                                              "&titles=" + QUrl::toPercentEncoding(warning->Warning->User->GetTalk());
                 HUGGLE_QP_APPEND(warning->Query);
                 warning->Query->Target = _l("main-user-retrieving-tp", warning->Warning->User->Username);
@@ -339,7 +342,7 @@ void Warnings::ResendWarnings()
                 Syslog::HuggleLogs->DebugLog("Expired " + warning->Warning->User->Username + " reparsing it now");
                 // we need to fetch the talk page again and later we need to issue new warning
                 warning->Query = new Huggle::ApiQuery(ActionQuery, warning->RelatedEdit->GetSite());
-                warning->Query->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("timestamp|user|comment|content") +
+                warning->Query->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|timestamp|user|comment|content") +
                                              "&titles=" + QUrl::toPercentEncoding(warning->Warning->User->GetTalk());
                 HUGGLE_QP_APPEND(warning->Query);
                 warning->Query->Target = _l("main-user-retrieving-tp", warning->Warning->User->Username);
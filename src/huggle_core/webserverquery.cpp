@@ -49,11 +49,11 @@ void WebserverQuery::Process()
     {
         this->Result = new QueryResult(true);
         this->Result->SetError("You provided invalid url");
-        this->status = StatusInError;
+        this->SetStatus(StatusInError);
         return;
     }
     this->ThrowOnValidResult();
-    this->status = StatusProcessing;
+    this->SetStatus(StatusProcessing);
     this->Result = new QueryResult();
 
     QUrl url = QUrl::fromEncoded(this->URL.toUtf8());
@@ -107,7 +107,7 @@ void WebserverQuery::Finished()
         this->Result->SetError(reply->errorString());
         this->reply->deleteLater();
         this->reply = nullptr;
-        this->status = StatusDone;
+        this->SetStatus(StatusDone);
         return;
     }
     this->reply->deleteLater();
@@ -116,5 +116,5 @@ void WebserverQuery::Finished()
     {
         Huggle::Syslog::HuggleLogs->DebugLog("Finished request " + URL, 2);
     }
-    this->status = StatusDone;
+    this->SetStatus(StatusDone);
 }
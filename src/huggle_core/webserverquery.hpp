@@ -29,6 +29,7 @@ namespace Huggle
             WebserverQuery();
             ~WebserverQuery() override;
             QString QueryTargetToString() override { return this->URL; }
+            bool IsPolled() override { return false; }
             //! Whether the query will submit parameters using POST data
             bool UsingPOST;
             //! This is an url of api request, you probably don't want to change it unless
@@ -11,10 +11,13 @@
 #include "wikiedit.hpp"
 #include <QMutex>
 #include <QUrl>
+#include "apiquerybatch.hpp"
 #include "apiqueryresult.hpp"
 #include "configuration.hpp"
 #include "hooks.hpp"
 #include "core.hpp"
+#include "diffextractor.hpp"
+#include "editregistry.hpp"
 #include "querypool.hpp"
 #include "exception.hpp"
 #include "syslog.hpp"
@@ -26,8 +29,29 @@
 #include "localization.hpp"
 
 using namespace Huggle;
-QList<WikiEdit*> WikiEdit::EditList;
-QMutex *WikiEdit::Lock_EditList = new QMutex(QMutex::Recursive);
+
+//! Returns the value of clcontinue if query didn't return all categories, otherwise empty string
+static QString getCategoriesContinuation(ApiQuery *query)
+{
+    // raw continuation is returned in query-continue/categories, new style in continue
+    QList<ApiQueryResultNode*> nodes = query->GetApiQueryResult()->GetNodes("categories");
+    nodes.append(query->GetApiQueryResult()->GetNodes("continue"));
+    foreach (ApiQueryResultNode *node, nodes)
+    {
+        if (node->Attributes.contains("clcontinue"))
+            return node->GetAttribute("clcontinue");
+    }
+    return "";
+}
+
+//! Returns username in form in which mediawiki compares them, only first letter is case insensitive
+static QString normalizeUsername(const QString &username)
+{
+    QString name = WikiUtil::SanitizeUser(username.trimmed());
+    if (!name.isEmpty())
+        name[0] = name[0].toUpper();
+    return name;
+}
 
 WikiEdit::WikiEdit()
 {
@@ -59,16 +83,12 @@ WikiEdit::WikiEdit()
     this->processingByWorkerThread = false;
     this->processedByWorkerThread = false;
     this->RevID = WIKI_UNKNOWN_REVID;
-    WikiEdit::Lock_EditList->lock();
-    WikiEdit::EditList.append(this);
-    WikiEdit::Lock_EditList->unlock();
+    EditRegistry::Insert(this);
 }
 
 WikiEdit::~WikiEdit()
 {
-    WikiEdit::Lock_EditList->lock();
-    WikiEdit::EditList.removeAll(this);
-    WikiEdit::Lock_EditList->unlock();
+    EditRegistry::Remove(this);
     if (this->Previous != nullptr && this->Next != nullptr)
     {
         this->Previous->Next = this->Next;
@@ -92,6 +112,9 @@ bool WikiEdit::finalizePostProcessing()
 {
     if (this->processedByWorkerThread || !this->postProcessing)
     {
+        this->Latency.Mark(EditLatencyStage_Finalized);
+        // revision id might have been retrieved by post processing
+        EditRegistry::Update(this);
         Hooks::EditAfterPostProcess(this);
         WikiUser::UpdateWl(this->User, this->Score);
         this->processCallback();
@@ -112,17 +135,42 @@ bool WikiEdit::finalizePostProcessing()
             Syslog::HuggleLogs->ErrorLog("Unable to fetch categories for page " + this->Page->PageName + ": " + this->qCategoriesAndWatched->GetFailureReason());
         } else
         {
-            QList<ApiQueryResultNode*> categories = this->qCategoriesAndWatched->GetApiQueryResult()->GetNodes("cl");
-            QStringList categoryStringList;
-            foreach (ApiQueryResultNode *cat, categories)
+            // query is shared with other edits, so we need to find the page that belongs to this one
+            ApiQueryResultNode *page = ApiQueryBatch::FindPage(this->qCategoriesAndWatched, this->Page->PageName);
+            if (page == nullptr)
             {
-                categoryStringList.append(WikiPage(cat->GetAttribute("title"), this->GetSite()).RootName());
+                Syslog::HuggleLogs->ErrorLog("Unable to fetch categories for page " + this->Page->PageName + ": page is missing in result");
+            } else
+            {
+                QString continuation = getCategoriesContinuation(this->qCategoriesAndWatched);
+                // categories are listed in order of page ids and continuation starts with id of page where the list was cut,
+                // so pages with lower id are complete and others need to be retrieved separately
+                if (this->categoriesBatched && !continuation.isEmpty() &&
+                        page->GetAttribute("pageid").toLongLong() >= continuation.section('|', 0, 0).toLongLong())
+                {
+                    HUGGLE_DEBUG("Categories of " + this->Page->PageName + " weren't complete in batch result, retrieving them separately", 2);
+                    this->categoriesBatched = false;
+                    this->retrieveCategories();
+                    return false;
+                }
+                foreach (ApiQueryResultNode *categories, page->ChildNodes)
+                {
+                    if (categories->Name != "categories")
+                        continue;
+                    foreach (ApiQueryResultNode *cat, categories->ChildNodes)
+                        this->categoriesRetrieved.append(WikiPage(cat->GetAttribute("title"), this->GetSite()).RootName());
+                }
+                if (!this->categoriesBatched && !continuation.isEmpty())
+                {
+                    // page alone has more categories than the limit
+                    this->retrieveCategories(continuation);
+                    return false;
+                }
+                this->Page->SetCategories(this->categoriesRetrieved);
+                this->Page->SetWatched(page->GetAttribute("watched", "false") != "false");
             }
-            this->Page->SetCategories(categoryStringList);
-
-            ApiQueryResultNode *page = this->qCategoriesAndWatched->GetApiQueryResult()->GetNode("page");
-            this->Page->SetWatched(page->GetAttribute("watched", "false") != "false");
         }
+        this->Latency.Mark(EditLatencyStage_CategoriesRetrieved);
         this->qCategoriesAndWatched = nullptr;
     }
 
@@ -152,6 +200,7 @@ bool WikiEdit::finalizePostProcessing()
                 }
             }
         }
+        this->Latency.Mark(EditLatencyStage_FounderRetrieved);
         this->qFounder = nullptr;
     }
 
@@ -168,11 +217,25 @@ bool WikiEdit::finalizePostProcessing()
         } else
         {
             // we fetch the number of edits, registration and groups of user
-            QList<ApiQueryResultNode*> user_data = this->qUser->GetApiQueryResult()->GetNodes("user");
-            QList<ApiQueryResultNode*> group_data = this->qUser->GetApiQueryResult()->GetNodes("g");
-            if (user_data.count() > 0)
+            // result contains information about all users in the batch
+            ApiQueryResultNode *user_info_ = nullptr;
+            QString username = normalizeUsername(this->User->Username);
+            foreach (ApiQueryResultNode *node, this->qUser->GetApiQueryResult()->GetNodes("user"))
+            {
+                if (normalizeUsername(node->GetAttribute("name")) == username)
+                {
+                    user_info_ = node;
+                    break;
+                }
+            }
+            QList<ApiQueryResultNode*> group_data;
+            if (user_info_ != nullptr)
             {
-                ApiQueryResultNode *user_info_ = user_data.at(0);
+                foreach (ApiQueryResultNode *groups, user_info_->ChildNodes)
+                {
+                    if (groups->Name == "groups")
+                        group_data.append(groups->ChildNodes);
+                }
                 if (user_info_->Attributes.contains("editcount"))
                 {
                     this->User->EditCount = user_info_->GetAttribute("editcount").toLong();
@@ -212,6 +275,7 @@ bool WikiEdit::finalizePostProcessing()
             // let's delete it now
             this->qUser = nullptr;
         }
+        this->Latency.Mark(EditLatencyStage_UserInfoRetrieved);
     }
 
     if (this->processingRevs)
@@ -225,18 +289,33 @@ bool WikiEdit::finalizePostProcessing()
             Huggle::Syslog::HuggleLogs->Log(_l("wikiedit-tp-fail", this->User->GetTalk()));
         } else
         {
-            // parse the talk page now
-            QList<ApiQueryResultNode*> rev_ = this->qTalkpage->GetApiQueryResult()->GetNodes("rev");
-            QList<ApiQueryResultNode*> pages_ = this->qTalkpage->GetApiQueryResult()->GetNodes("page");
+            // parse the talk page now, result is shared with other edits so we look up our page in it
+            QList<ApiQueryResultNode*> rev_;
             bool missing = false;
-            if (pages_.count() > 0)
+            ApiQueryResultNode *page = ApiQueryBatch::FindPage(this->qTalkpage, this->User->GetTalk());
+            if (page != nullptr)
             {
-                ApiQueryResultNode *node = pages_.at(0);
-                if (node->Attributes.contains("missing"))
-                {
+                if (page->Attributes.contains("missing"))
                     missing = true;
+                foreach (ApiQueryResultNode *revisions, page->ChildNodes)
+                {
+                    if (revisions->Name == "revisions")
+                        rev_.append(revisions->ChildNodes);
                 }
             }
+            if (!missing && rev_.isEmpty() && this->talkPageBatched)
+            {
+                // mediawiki doesn't return contents of all pages when they are too large for one response,
+                // so we need to retrieve this one separately
+                HUGGLE_DEBUG("Talk page " + this->User->GetTalk() + " wasn't in batch result, retrieving it separately", 2);
+                this->talkPageBatched = false;
+                this->qTalkpage = WikiUtil::RetrieveWikiPageContents(this->User->GetTalk(), this->GetSite());
+                this->qTalkpage->RequestPriority = ApiQuery::PriorityPrefetch;
+                HUGGLE_QP_APPEND(this->qTalkpage);
+                this->qTalkpage->Target = "Retrieving tp " + this->User->GetTalk();
+                this->qTalkpage->Process();
+                return false;
+            }
             // get last id
             if (!missing && rev_.count() > 0)
             {
@@ -252,7 +331,10 @@ bool WikiEdit::finalizePostProcessing()
                     // completely accurate but better than nothing
                     this->User->SetLastMessageTime(MediaWiki::FromMWTimestamp(this->TPRevBaseTime));
                 }
-                this->User->TalkPage_SetContents(rv->Value);
+                revid_ht revision = WIKI_UNKNOWN_REVID;
+                if (rv->Attributes.contains("revid"))
+                    revision = rv->GetAttribute("revid").toLongLong();
+                this->User->TalkPage_SetContents(rv->Value, revision);
             } else
             {
                 if (missing)
@@ -267,6 +349,7 @@ bool WikiEdit::finalizePostProcessing()
             }
         }
         this->processingRevs = false;
+        this->Latency.Mark(EditLatencyStage_TalkPageRetrieved);
     }
 
     if (this->processingEditInfo)
@@ -287,11 +370,20 @@ bool WikiEdit::finalizePostProcessing()
         }
 
         // parse the revision meta-data now
-        QList<ApiQueryResultNode*> revision_data = this->qRevisionInfo->GetApiQueryResult()->GetNodes("rev");
-        // get last id
-        if (revision_data.count() > 0)
+        ApiQueryResultNode *revision = nullptr;
+        if (this->RevID != WIKI_UNKNOWN_REVID)
+        {
+            // query was batched by revision id
+            revision = ApiQueryBatch::FindNode(this->qRevisionInfo, "rev", "revid", QString::number(this->RevID));
+        } else
+        {
+            QList<ApiQueryResultNode*> revision_data = this->qRevisionInfo->GetApiQueryResult()->GetNodes("rev");
+            // get last id
+            if (revision_data.count() > 0)
+                revision = revision_data.at(0);
+        }
+        if (revision != nullptr)
         {
-            ApiQueryResultNode *revision = revision_data.at(0);
             if (revision->Value.length() > 0)
                 this->Page->SetContent(revision->Value);
             // check if this revision matches our user
@@ -325,6 +417,7 @@ bool WikiEdit::finalizePostProcessing()
 
         this->qRevisionInfo = nullptr;
         this->processingEditInfo = false;
+        this->Latency.Mark(EditLatencyStage_RevisionInfoRetrieved);
     }
 
     if (this->processingDiff)
@@ -366,6 +459,7 @@ bool WikiEdit::finalizePostProcessing()
 
         this->qDifference.Delete();
         this->processingDiff = false;
+        this->Latency.Mark(EditLatencyStage_DiffRetrieved);
     }
 
     if (this->qText != nullptr && this->qText->IsProcessed())
@@ -382,21 +476,39 @@ bool WikiEdit::finalizePostProcessing()
             this->Page->SetContent(result);
         }
         this->qText = nullptr;
+        this->Latency.Mark(EditLatencyStage_TextRetrieved);
     }
 
     // check if everything was processed and clean up
     if (this->processingRevs || this->processingDiff || this->processingEditInfo || this->qUser != nullptr || this->qText != nullptr || this->qFounder != nullptr || this->qCategoriesAndWatched != nullptr)
         return false;
 
+    // pool doesn't exist during shutdown, edit will never be scored then
+    if (WikiEdit_ProcessorPool::Pool == nullptr)
+        return false;
     this->qTalkpage = nullptr;
+    // extract the added text now, so that the cache isn't written from worker thread
+    this->GetAddedText();
+    this->Latency.Mark(EditLatencyStage_QueriesFinished);
     this->processingByWorkerThread = true;
-    WikiEdit_ProcessorThread::EditLock.lock();
     this->RegisterConsumer(HUGGLECONSUMER_PROCESSOR);
-    WikiEdit_ProcessorThread::PendingEdits.append(this);
-    WikiEdit_ProcessorThread::EditLock.unlock();
+    WikiEdit_ProcessorPool::Pool->Enqueue(this);
     return false;
 }
 
+void WikiEdit::retrieveCategories(const QString &clcontinue)
+{
+    this->qCategoriesAndWatched = new ApiQuery(ActionQuery, this->GetSite());
+    this->qCategoriesAndWatched->Parameters = "prop=" + QUrl::toPercentEncoding("categories|info") + "&inprop=watched&cllimit=max&titles=" +
+                                              QUrl::toPercentEncoding(this->Page->PageName);
+    if (!clcontinue.isEmpty())
+        this->qCategoriesAndWatched->Parameters += "&clcontinue=" + QUrl::toPercentEncoding(clcontinue);
+    this->qCategoriesAndWatched->Target = "Retrieving categories of " + this->Page->PageName;
+    this->qCategoriesAndWatched->RequestPriority = ApiQuery::PriorityPrefetch;
+    HUGGLE_QP_APPEND(this->qCategoriesAndWatched);
+    this->qCategoriesAndWatched->Process();
+}
+
 QString WikiEdit::GetPixmap()
 {
     if (this->User == nullptr)
@@ -446,68 +558,38 @@ QString WikiEdit::GetPixmap()
     return ":/huggle/pictures/Resources/blob-none.png";
 }
 
-static long ProcessPartsInWikiText(QStringList *list, const QString& text, QList<ScoreWord> *wl)
+QString WikiEdit::GetAddedText()
 {
-    long rs = 0;
-    foreach (ScoreWord word, *wl)
+    // QString is implicitly shared, so as long as we hold a copy of the source, same data means same text
+    if (this->addedTextSource.constData() != this->DiffText.constData() || this->addedTextSource.size() != this->DiffText.size())
     {
-        QString w = word.word;
-        if (text.contains(w))
-        {
-            rs += word.score;
-            list->append(w);
-        }
+        this->addedText = DiffExtractor::ExtractAddedText(this->DiffText);
+        this->addedTextSource = this->DiffText;
     }
-    return rs;
+    return this->addedText;
 }
 
-static long ProcessWordsInWikiText(QStringList *list, const QString& text, QList<ScoreWord> *wl)
+score_ht WikiEdit::GetPreliminaryScore()
 {
-    long rs = 0;
-    foreach (ScoreWord word, *wl)
+    ProjectConfiguration *conf = this->GetSite()->GetProjectConfig();
+    score_ht score = 0;
+    if (this->User->IsIP())
+        score += conf->IPScore;
+    if (this->Bot)
+        score += conf->BotScore;
+    if (this->User->IsWhitelisted())
+        score += conf->WhitelistScore;
+    score += this->User->GetBadnessScore();
+    if (this->SizeIsKnown)
     {
-        QString w = word.word;
-        // if there is no such a string in text we can skip it
-        if (!text.contains(w))
-            continue;
-
-        int SD = 0;
-        bool found = false;
-        if (text == w)
-            found = true;
-        while (!found && SD < hcfg->SystemConfig_WordSeparators.count())
-        {
-            if (text.startsWith(w + hcfg->SystemConfig_WordSeparators.at(SD)))
-            {
-                found = true;
-                break;
-            }
-            if (text.endsWith(hcfg->SystemConfig_WordSeparators.at(SD) + w))
-            {
-                found = true;
-                break;
-            }
-            int SL = 0;
-            while (SL < hcfg->SystemConfig_WordSeparators.count())
-            {
-                if (text.contains(hcfg->SystemConfig_WordSeparators.at(SD) + w + hcfg->SystemConfig_WordSeparators.at(SL)))
-                {
-                    found = true;
-                    break;
-                }
-                if (found)
-                    break;
-                ++SL;
-            }
-            ++SD;
-        }
-        if (found)
-        {
-            rs += word.score;
-            list->append(w);
-        }
+        if (this->diffSize > 1200 || this->diffSize < -1200)
+            score += conf->ScoreChange;
+        if (this->diffSize < (-1 * conf->LargeRemoval))
+            score += conf->ScoreRemoval;
     }
-    return rs;
+    if (this->Summary.isEmpty())
+        score += 10;
+    return score;
 }
 
 void WikiEdit::ProcessWords()
@@ -516,20 +598,23 @@ void WikiEdit::ProcessWords()
     if (this->DiffText_IsSplit)
         text = this->DiffText_New.toLower();
     else
-        text = this->DiffText.toLower();
-    if (text.isEmpty() && this->Page->Contents.length() > 0)
+        text = this->GetAddedText();
+    // diff that only removes text has nothing to score, contents of page are used only when there is no diff at all
+    if (text.isEmpty() && (this->DiffText_IsSplit || this->DiffText.isEmpty()) && this->Page->Contents.length() > 0)
     {
         text = this->Page->Contents.toLower();
     }
     // we cache the project config pointer
     ProjectConfiguration *conf = this->GetSite()->GetProjectConfig();
+    // all score words and parts are found in one pass over the text
+    QVector<unsigned char> hits = conf->ScoreMatcher.Match(text);
     if (!this->Page->IsTalk())
     {
-        this->RecordScore("PartsInWikiText_NoTalk", ProcessPartsInWikiText(&this->ScoreWords, text, &conf->NoTalkScoreParts));
-        this->RecordScore("WordsInWikiText_NoTalk", ProcessWordsInWikiText(&this->ScoreWords, text, &conf->NoTalkScoreWords));
+        this->RecordScore("PartsInWikiText_NoTalk", conf->ScoreMatcher.Evaluate(conf->NoTalkScorePartsList, hits, &this->ScoreWords));
+        this->RecordScore("WordsInWikiText_NoTalk", conf->ScoreMatcher.Evaluate(conf->NoTalkScoreWordsList, hits, &this->ScoreWords));
     }
-    this->RecordScore("WordsInWikiText", ProcessWordsInWikiText(&this->ScoreWords, text, &conf->ScoreWords));
-    this->RecordScore("PartsInWikiText", ProcessPartsInWikiText(&this->ScoreWords, text, &conf->ScoreParts));
+    this->RecordScore("WordsInWikiText", conf->ScoreMatcher.Evaluate(conf->ScoreWordsList, hits, &this->ScoreWords));
+    this->RecordScore("PartsInWikiText", conf->ScoreMatcher.Evaluate(conf->ScorePartsList, hits, &this->ScoreWords));
 }
 
 void WikiEdit::RemoveFromHistoryChain()
@@ -597,52 +682,58 @@ void WikiEdit::PostProcess()
     if (this->Status != Huggle::StatusProcessed)
         throw new Huggle::Exception("Unable to post process an edit that wasn't in processed status", BOOST_CURRENT_FUNCTION);
     this->postProcessing = true;
+    this->Latency.Mark(EditLatencyStage_PostProcessStarted);
 #ifndef HUGGLE_SDK
     // Send info to other functions
     Hooks::EditBeforePostProcess(this);
 #endif
-    this->qTalkpage = WikiUtil::RetrieveWikiPageContents(this->User->GetTalk(), this->GetSite());
-    HUGGLE_QP_APPEND(this->qTalkpage);
-    this->qTalkpage->Target = "Retrieving tp " + this->User->GetTalk();
-    this->qTalkpage->Process();
+    // queries that are same for many edits are batched, every edit gets a query that is shared
+    // with other edits and that is sent together with them, see ApiQueryBatch
+    this->qTalkpage = ApiQueryBatch::Request(this->GetSite(), "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|timestamp|user|comment|content"),
+                                             "titles", this->User->GetTalk());
+    this->talkPageBatched = true;
     if (!this->NewPage)
     {
         // This query will fetch information about the revision(s) but not the diff itself
-        this->qRevisionInfo = new ApiQuery(ActionQuery, this->GetSite());
         if (this->RevID != WIKI_UNKNOWN_REVID)
         {
             // &rvprop=content can't be used because of fuck up of mediawiki
-            this->qRevisionInfo->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|tags|user|timestamp|comment") +
-                                              "&rvlimit=1&rvstartid=" + QString::number(this->RevID) + "&titles=" +
-                                              QUrl::toPercentEncoding(this->Page->PageName);
+            this->qRevisionInfo = ApiQueryBatch::Request(this->GetSite(), "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|tags|user|timestamp|comment"),
+                                                         "revids", QString::number(this->RevID));
         } else
         {
+            this->qRevisionInfo = new ApiQuery(ActionQuery, this->GetSite());
             this->qRevisionInfo->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|tags|user|timestamp|comment") +
                                               "&rvlimit=1&titles=" + QUrl::toPercentEncoding(this->Page->PageName);
+            this->qRevisionInfo->Target = this->Page->PageName;
+            this->qRevisionInfo->RequestPriority = ApiQuery::PriorityPrefetch;
+            HUGGLE_QP_APPEND(this->qRevisionInfo);
+            this->qRevisionInfo->Process();
+            if (hcfg->Verbosity > 0)
+                this->PropertyBag.insert("debug_api_url_rev_info", this->qRevisionInfo->GetURL());
         }
-        this->qRevisionInfo->Target = this->Page->PageName;
-        HUGGLE_QP_APPEND(this->qRevisionInfo);
-        this->qRevisionInfo->Process();
-        if (hcfg->Verbosity > 0)
-            this->PropertyBag.insert("debug_api_url_rev_info", this->qRevisionInfo->GetURL());
         this->processingEditInfo = true;
 
         // This query will download the actual diff of edit
         if (this->RevID != WIKI_UNKNOWN_REVID)
         {
             if (!this->IsRangeOfEdits())
-                this->qDifference = WikiUtil::APIRequest(ActionCompare, this->GetSite(), "fromrev=" + QString::number(this->RevID) + "&torelative=" + this->DiffTo, false, "Diff of " + this->Page->PageName);
+                this->qDifference = WikiUtil::APIRequest(ActionCompare, this->GetSite(), "fromrev=" + QString::number(this->RevID) + "&torelative=" + this->DiffTo, false, "Diff of " + this->Page->PageName,
+                                                             ApiQuery::PriorityPrefetch);
             else
-                this->qDifference = WikiUtil::APIRequest(ActionCompare, this->GetSite(), "fromrev=" + QString::number(this->RevID) + "&torev=" + this->DiffTo, false, "Diff of " + this->Page->PageName);
+                this->qDifference = WikiUtil::APIRequest(ActionCompare, this->GetSite(), "fromrev=" + QString::number(this->RevID) + "&torev=" + this->DiffTo, false, "Diff of " + this->Page->PageName,
+                                                             ApiQuery::PriorityPrefetch);
         } else
         {
-            this->qDifference = WikiUtil::APIRequest(ActionCompare, this->GetSite(), "fromtitle=" + QUrl::toPercentEncoding(this->Page->PageName) + "&torelative=" + this->DiffTo, false, "Diff of " + this->Page->PageName);
+            this->qDifference = WikiUtil::APIRequest(ActionCompare, this->GetSite(), "fromtitle=" + QUrl::toPercentEncoding(this->Page->PageName) + "&torelative=" + this->DiffTo, false, "Diff of " + this->Page->PageName,
+                                                             ApiQuery::PriorityPrefetch);
         }
         this->processingDiff = true;
     } else if (this->Page->Contents.isEmpty())
     {
         this->qText = WikiUtil::RetrieveWikiPageContents(this->Page, true);
         this->qText->Target = "Retrieving content of " + this->Page->PageName;
+        this->qText->RequestPriority = ApiQuery::PriorityPrefetch;
         HUGGLE_QP_APPEND(this->qText);
         this->qText->Process();
     }
@@ -652,51 +743,27 @@ void WikiEdit::PostProcess()
         this->qFounder->Parameters = "prop=revisions&titles=" + QUrl::toPercentEncoding(this->Page->PageName) + "&rvdir=newer&rvlimit=1&rvprop=" +
                                      QUrl::toPercentEncoding("ids|user|timestamp");
         this->qFounder->Target = this->Page->PageName + " (retrieving founder)";
+        this->qFounder->RequestPriority = ApiQuery::PriorityPrefetch;
         HUGGLE_QP_APPEND(this->qFounder);
         this->qFounder->Process();
     }
 
     if (hcfg->SystemConfig_CatScansAndWatched)
     {
-        this->qCategoriesAndWatched = new ApiQuery(ActionQuery, this->GetSite());
-        this->qCategoriesAndWatched->Parameters = "prop=" + QUrl::toPercentEncoding("categories|info") + "&titles=" + QUrl::toPercentEncoding(this->Page->PageName) + "&inprop=watched";
-        this->qCategoriesAndWatched->Target = this->Page->PageName + " (retrieving categories+watched)";
-        HUGGLE_QP_APPEND(this->qCategoriesAndWatched);
-        this->qCategoriesAndWatched->Process();
+        this->qCategoriesAndWatched = ApiQueryBatch::Request(this->GetSite(), "prop=" + QUrl::toPercentEncoding("categories|info") + "&inprop=watched&cllimit=max",
+                                                             "titles", this->Page->PageName);
+        this->categoriesBatched = true;
     }
 
     this->processingRevs = true;
     if (this->User->IsIP())
         return;
-    this->qUser = new ApiQuery(ActionQuery, this->GetSite());
-    this->qUser->Parameters = "list=users&usprop=blockinfo%7Cgroups%7Ceditcount%7Cregistration&ususers="
-                                + QUrl::toPercentEncoding(this->User->Username);
-    this->qUser->Process();
+    this->qUser = ApiQueryBatch::Request(this->GetSite(), "list=users&usprop=blockinfo%7Cgroups%7Ceditcount%7Cregistration", "ususers", this->User->Username);
 }
 
-Collectable_SmartPtr<WikiEdit> WikiEdit::FromCacheByRevID(revid_ht revid, const QString& prev)
+Collectable_SmartPtr<WikiEdit> WikiEdit::FromCacheByRevID(revid_ht revid, const QString& prev, WikiSite *site)
 {
-    Collectable_SmartPtr<WikiEdit> e;
-    if (revid == WIKI_UNKNOWN_REVID)
-    {
-        // there is no such an edit
-        return e;
-    }
-    WikiEdit::Lock_EditList->lock();
-    int x = 0;
-    while (x < WikiEdit::EditList.count())
-    {
-        WikiEdit *edit = WikiEdit::EditList.at(x);
-        ++x;
-        if (edit->RevID == revid && edit->DiffTo == prev)
-        {
-            e = edit;
-            // let's return it
-            break;
-        }
-    }
-    WikiEdit::Lock_EditList->unlock();
-    return e;
+    return EditRegistry::FindByRevID(revid, site, prev);
 }
 
 QString WikiEdit::GetPixmapFromEditType(EditType edit_type)
@@ -761,29 +828,148 @@ bool WikiEdit::IsReady()
     return Hooks::EditCheckIfReady(this);
 }
 
-QMutex WikiEdit_ProcessorThread::EditLock(QMutex::Recursive);
-QList<WikiEdit*> WikiEdit_ProcessorThread::PendingEdits;
+WikiEdit_ProcessorThread::WikiEdit_ProcessorThread(WikiEdit_ProcessorPool *processor_pool)
+{
+    this->pool = processor_pool;
+}
 
 void WikiEdit_ProcessorThread::run()
 {
-    while(Core::HuggleCore->Running)
+    WikiEdit *edit;
+    QElapsedTimer timer;
+    while ((edit = this->pool->take()) != nullptr)
     {
-        WikiEdit_ProcessorThread::EditLock.lock();
-        int e=0;
-        while (e<WikiEdit_ProcessorThread::PendingEdits.count())
-        {
-            this->Process(PendingEdits.at(e));
-            PendingEdits.at(e)->UnregisterConsumer(HUGGLECONSUMER_PROCESSOR);
-            ++e;
-        }
-        PendingEdits.clear();
-        WikiEdit_ProcessorThread::EditLock.unlock();
-        QThread::usleep(200000);
+        timer.start();
+        WikiEdit_ProcessorPool::Process(edit);
+        this->pool->recordProcessingTime(timer.nsecsElapsed());
+        edit->UnregisterConsumer(HUGGLECONSUMER_PROCESSOR);
     }
 }
 
-void WikiEdit_ProcessorThread::Process(WikiEdit *edit)
+WikiEdit_ProcessorPool *WikiEdit_ProcessorPool::Pool = nullptr;
+
+WikiEdit_ProcessorPool::WikiEdit_ProcessorPool(int workers)
+{
+    if (workers < 1)
+    {
+        // leave one core to main thread, scoring is cheap so that more than 4 workers wouldn't help much
+        workers = qBound(1, QThread::idealThreadCount() - 1, 4);
+    }
+    while (workers-- > 0)
+        this->workers.append(new WikiEdit_ProcessorThread(this));
+    this->clock.start();
+}
+
+WikiEdit_ProcessorPool::~WikiEdit_ProcessorPool()
+{
+    this->Stop();
+    qDeleteAll(this->workers);
+}
+
+void WikiEdit_ProcessorPool::Start()
+{
+    this->lock.lock();
+    this->stopping = false;
+    this->lock.unlock();
+    foreach (WikiEdit_ProcessorThread *worker, this->workers)
+    {
+        if (!worker->isRunning())
+            worker->start();
+    }
+}
+
+void WikiEdit_ProcessorPool::Stop()
+{
+    this->lock.lock();
+    this->stopping = true;
+    this->condition.wakeAll();
+    this->lock.unlock();
+    foreach (WikiEdit_ProcessorThread *worker, this->workers)
+        worker->wait();
+    this->lock.lock();
+    while (!this->queue.isEmpty())
+    {
+        this->queueTimes.dequeue();
+        this->queue.dequeue()->UnregisterConsumer(HUGGLECONSUMER_PROCESSOR);
+    }
+    this->lock.unlock();
+}
+
+void WikiEdit_ProcessorPool::Enqueue(WikiEdit *edit)
+{
+    if (edit == nullptr)
+        throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
+
+    this->lock.lock();
+    this->queue.enqueue(edit);
+    this->queueTimes.enqueue(this->clock.nsecsElapsed());
+    this->condition.wakeOne();
+    this->lock.unlock();
+}
+
+int WikiEdit_ProcessorPool::GetWorkerCount()
+{
+    return this->workers.count();
+}
+
+int WikiEdit_ProcessorPool::GetPendingCount()
+{
+    QMutexLocker locker(&this->lock);
+    return this->queue.count();
+}
+
+unsigned long long WikiEdit_ProcessorPool::GetProcessedCount()
+{
+    QMutexLocker locker(&this->lock);
+    return this->processed;
+}
+
+double WikiEdit_ProcessorPool::GetAverageWaitTime()
+{
+    QMutexLocker locker(&this->lock);
+    if (this->processed == 0)
+        return 0;
+    return static_cast<double>(this->totalWaitTime) / this->processed / 1000000;
+}
+
+double WikiEdit_ProcessorPool::GetMaxWaitTime()
+{
+    QMutexLocker locker(&this->lock);
+    return static_cast<double>(this->maxWaitTime) / 1000000;
+}
+
+double WikiEdit_ProcessorPool::GetAverageProcessingTime()
+{
+    QMutexLocker locker(&this->lock);
+    if (this->processed == 0)
+        return 0;
+    return static_cast<double>(this->totalProcessingTime) / this->processed / 1000000;
+}
+
+WikiEdit *WikiEdit_ProcessorPool::take()
+{
+    QMutexLocker locker(&this->lock);
+    while (this->queue.isEmpty() && !this->stopping)
+        this->condition.wait(&this->lock);
+    if (this->stopping)
+        return nullptr;
+    qint64 wait_time = this->clock.nsecsElapsed() - this->queueTimes.dequeue();
+    this->totalWaitTime += wait_time;
+    if (wait_time > this->maxWaitTime)
+        this->maxWaitTime = wait_time;
+    return this->queue.dequeue();
+}
+
+void WikiEdit_ProcessorPool::recordProcessingTime(qint64 nanoseconds)
+{
+    QMutexLocker locker(&this->lock);
+    this->processed++;
+    this->totalProcessingTime += nanoseconds;
+}
+
+void WikiEdit_ProcessorPool::Process(WikiEdit *edit)
 {
+    edit->Latency.Mark(EditLatencyStage_ScoringStarted);
     if (Hooks::EditBeforeScore(edit))
     {
         bool IgnoreWords = false;
@@ -864,6 +1050,8 @@ void WikiEdit_ProcessorThread::Process(WikiEdit *edit)
     }
     // This doesn't seem to work as JS engine is not thread safe
     // Hooks::EditAfterPostProcess(edit);
+    // this must be marked before the edit is flagged as processed, after that it belongs to main thread again
+    edit->Latency.Mark(EditLatencyStage_Scored);
     edit->postProcessing = false;
     edit->processedByWorkerThread = true;
     edit->Status = StatusPostProcessed;
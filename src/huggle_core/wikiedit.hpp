@@ -18,10 +18,15 @@
 #include <QHash>
 #include <QThread>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QList>
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
 #include "apiquery.hpp"
 #include "collectable.hpp"
 #include "collectable_smartptr.hpp"
+#include "editlatency.hpp"
 #include "edittype.hpp"
 
 namespace Huggle
@@ -51,16 +56,67 @@ namespace Huggle
 
     typedef void* (*WEPostprocessedCallback) (WikiEdit*);
 
-    //! Edits are post processed in this thread
+    class WikiEdit_ProcessorPool;
+
+    //! Worker of WikiEdit_ProcessorPool, it sleeps until there is some edit to score
     class HUGGLE_EX_CORE WikiEdit_ProcessorThread :  public QThread
     {
             Q_OBJECT
         public:
-            static QList<WikiEdit *> PendingEdits;
-            static QMutex EditLock;
-            void Process(WikiEdit *edit);
+            WikiEdit_ProcessorThread(WikiEdit_ProcessorPool *processor_pool);
         protected:
-            void run();
+            void run() override;
+        private:
+            WikiEdit_ProcessorPool *pool;
+    };
+
+    //! Edits that finished post processing are scored by threads of this pool
+
+    //! Every edit is handed over to one of the workers as soon as it's inserted, the lock of pool
+    //! is held only while the edit is being inserted or taken out of the queue, not while it's scored.
+    class HUGGLE_EX_CORE WikiEdit_ProcessorPool
+    {
+        public:
+            //! Pool used by huggle, it's created by core
+            static WikiEdit_ProcessorPool *Pool;
+            //! Score the edit, this is called from worker threads
+            static void Process(WikiEdit *edit);
+
+            //! Creates a pool, 0 workers means that number of workers is picked based on number of CPU cores
+            WikiEdit_ProcessorPool(int workers = 0);
+            ~WikiEdit_ProcessorPool();
+            void Start();
+            //! Stops all workers and waits for them to finish, edits that were not scored yet are released
+            void Stop();
+            //! Insert an edit to queue, it must have HUGGLECONSUMER_PROCESSOR registered, that is removed once it's scored
+            void Enqueue(WikiEdit *edit);
+            int GetWorkerCount();
+            //! Number of edits that are waiting for a worker
+            int GetPendingCount();
+            unsigned long long GetProcessedCount();
+            //! Average time edit spent in queue before some worker took it, in ms
+            double GetAverageWaitTime();
+            //! Longest time edit spent in queue, in ms
+            double GetMaxWaitTime();
+            //! Average time it took to score an edit, in ms
+            double GetAverageProcessingTime();
+        private:
+            friend class WikiEdit_ProcessorThread;
+            //! Take next edit from queue, this blocks until there is some, returns nullptr when pool is stopping
+            WikiEdit *take();
+            void recordProcessingTime(qint64 nanoseconds);
+            QList<WikiEdit_ProcessorThread*> workers;
+            QQueue<WikiEdit*> queue;
+            //! Time when the edits in queue were inserted, in ns since the pool was created
+            QQueue<qint64> queueTimes;
+            QMutex lock;
+            QWaitCondition condition;
+            QElapsedTimer clock;
+            bool stopping = false;
+            unsigned long long processed = 0;
+            qint64 totalWaitTime = 0;
+            qint64 maxWaitTime = 0;
+            qint64 totalProcessingTime = 0;
     };
 
     //! Wiki edit
@@ -81,11 +137,9 @@ namespace Huggle
             //! This function will return a constant (which needs to be generated runtime)
             //! which is used as "unknown time" in case we don't know the edit's time
             static QDateTime GetUnknownEditTime();
-            static Collectable_SmartPtr<WikiEdit> FromCacheByRevID(revid_ht revid, const QString& prev = "prev");
+            //! Returns edit with this revision id that is in memory, if site is null edit of any site is returned
+            static Collectable_SmartPtr<WikiEdit> FromCacheByRevID(revid_ht revid, const QString& prev = "prev", WikiSite *site = nullptr);
             static QString GetPixmapFromEditType(EditType edit_type);
-            //! This list contains reference to all existing edits in memory
-            static QList<WikiEdit*> EditList;
-            static QMutex *Lock_EditList;
 
             //! Creates a new empty wiki edit
             WikiEdit();
@@ -95,9 +149,22 @@ namespace Huggle
             WikiSite *GetSite();
             void SetSize(long size);
             long GetSize();
+            /*!
+             * \brief Rough estimate of score that only uses information known before post processing
+             *
+             * This is used by feed providers to decide which edits are least interesting when there is no space for them
+             */
+            score_ht GetPreliminaryScore();
             QString GetPixmap();
             //! Return a full url to edit
             QString GetFullUrl();
+            /*!
+             * \brief Returns text that was added by this edit, in lower case and without markup
+             *
+             * It is extracted from DiffText by DiffExtractor and cached until DiffText is changed. If DiffText
+             * isn't a html diff, the whole DiffText in lower case is returned.
+             */
+            QString GetAddedText();
             bool IsRangeOfEdits();
             //! Return true in case this edit was post processed already
             bool IsPostProcessed();
@@ -169,18 +236,31 @@ namespace Huggle
             //! List of parsed score words which were found in this edit
             QStringList ScoreWords;
             QDateTime Time;
+            //! Time when edit reached every stage of processing, see EditLatency
+            EditLatencyTrace Latency;
         protected:
             void processCallback();
             //! This function is called by core
             bool finalizePostProcessing();
+            //! Retrieve categories and watched status of this page only, clcontinue continues previous query of it
+            void retrieveCategories(const QString &clcontinue = "");
             bool processingByWorkerThread;
             bool processingRevs;
             bool processingEditInfo;
             bool processingDiff = false;
+            //! Talk page is being retrieved by a batch, so if it is missing in result we can retry with individual query
+            bool talkPageBatched = false;
+            //! Categories are retrieved by a batch, limit of categories is shared by all pages in it, so they might be incomplete
+            bool categoriesBatched = false;
+            //! Categories of page retrieved by previous queries, when there are more of them than the limit
+            QStringList categoriesRetrieved;
             //! This variable is used by worker thread and needs to be public so that it is working
             bool postProcessing;
             //! This variable is used by worker thread and needs to be public so that it is working
             bool processedByWorkerThread;
+            //! Cache of GetAddedText() and the DiffText it was extracted from
+            QString addedText;
+            QString addedTextSource;
             Collectable_SmartPtr<ApiQuery> qTalkpage;
             //! This is a query used to retrieve information about the user
             Collectable_SmartPtr<ApiQuery> qUser;
@@ -192,7 +272,7 @@ namespace Huggle
             Collectable_SmartPtr<ApiQuery> qCategoriesAndWatched;
             //! Size of change of edit
             long diffSize;
-            friend class WikiEdit_ProcessorThread;
+            friend class WikiEdit_ProcessorPool;
             friend class MainWindow;
     };
 
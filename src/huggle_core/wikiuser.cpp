@@ -9,7 +9,10 @@
 //GNU General Public License for more details.
 
 #include "wikiuser.hpp"
+#include <QHash>
 #include <QMutex>
+#include <QPair>
+#include <QReadWriteLock>
 #include "configuration.hpp"
 #include "projectconfiguration.hpp"
 #include "exception.hpp"
@@ -18,6 +21,7 @@
 #include "hooks.hpp"
 #include "huggleprofiler.hpp"
 #include "syslog.hpp"
+#include "userreputation.hpp"
 #include "wikipage.hpp"
 #include "wikisite.hpp"
 using namespace Huggle;
@@ -33,10 +37,41 @@ QRegExp WikiUser::IPv6Regex("(([0-9a-fA-F]{1,4}:){7,7}[0-9a-fA-F]{1,4}|([0-9a-fA
                             "-9]){0,1}[0-9]).){3,3}(25[0-5]|(2[0-4]|1{0,1}[0-9]){0,1}[0-9])|([0-9a-fA-F]{1,4}"\
                             ":){1,4}:((25[0-5]|(2[0-4]|1{0,1}[0-9]){0,1}[0-9]).){3,3}(25[0-5]|(2[0-4]|1{0,1}["\
                             "0-9]){0,1}[0-9]))");
-QList<WikiUser*> WikiUser::ProblematicUsers;
-QMutex WikiUser::ProblematicUserListLock(QMutex::Recursive);
 QDateTime WikiUser::InvalidTime = QDateTime::fromMSecsSinceEpoch(2);
 
+//! Number of parts of the list of problematic users, each part has its own lock so that threads rarely wait for each other
+#define HUGGLE_PROBLEMATIC_USERS_SHARDS 16
+
+typedef QPair<WikiSite*, QString> ProblematicUserKey;
+
+//! Part of list of users that are scored in this instance of huggle, users are indexed by site and username
+struct ProblematicUserShard
+{
+    QReadWriteLock Lock;
+    QHash<ProblematicUserKey, WikiUser*> Users;
+};
+
+static ProblematicUserShard problematicUsers[HUGGLE_PROBLEMATIC_USERS_SHARDS];
+
+static ProblematicUserKey problematicUserKey(const QString &user, WikiSite *site)
+{
+    // usernames are stored with underscores, but some sources give us spaces
+    QString name = user;
+    return ProblematicUserKey(site, name.replace(" ", "_"));
+}
+
+static ProblematicUserShard &problematicUserShard(const ProblematicUserKey &key)
+{
+    return problematicUsers[qHash(key) % HUGGLE_PROBLEMATIC_USERS_SHARDS];
+}
+
+//! Time when the reputation of user on given site expires, in seconds since epoch
+static qint64 reputationExpires(WikiSite *site)
+{
+    // warnings older than template age are ignored, so there is no point to remember them for longer
+    return QDateTime::currentDateTimeUtc().toMSecsSinceEpoch() / 1000 + static_cast<qint64>(qAbs(site->GetProjectConfig()->TemplateAge)) * 86400;
+}
+
 WikiUser *WikiUser::RetrieveUser(WikiUser *user)
 {
     return WikiUser::RetrieveUser(user->Username, user->GetSite());
@@ -45,78 +80,145 @@ WikiUser *WikiUser::RetrieveUser(WikiUser *user)
 WikiUser *WikiUser::RetrieveUser(const QString &user, WikiSite *site)
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
-    WikiUser::ProblematicUserListLock.lock();
-    foreach (WikiUser *user_, WikiUser::ProblematicUsers)
+    ProblematicUserKey key = problematicUserKey(user, site);
+    ProblematicUserShard &shard = problematicUserShard(key);
+    QReadLocker locker(&shard.Lock);
+    return shard.Users.value(key, nullptr);
+}
+
+int WikiUser::GetProblematicUserCount()
+{
+    int count = 0;
+    int i = 0;
+    while (i < HUGGLE_PROBLEMATIC_USERS_SHARDS)
     {
-        if (site == user_->Site && user == user_->Username)
-        {
-            WikiUser::ProblematicUserListLock.unlock();
-            return user_;
-        }
+        QReadLocker locker(&problematicUsers[i].Lock);
+        count += problematicUsers[i++].Users.count();
     }
-    WikiUser::ProblematicUserListLock.unlock();
-    return nullptr;
+    return count;
 }
 
 void WikiUser::TrimProblematicUsersList()
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
-    WikiUser::ProblematicUserListLock.lock();
     int i = 0;
-    while (i < WikiUser::ProblematicUsers.count())
+    while (i < HUGGLE_PROBLEMATIC_USERS_SHARDS)
     {
-        WikiUser *user = WikiUser::ProblematicUsers.at(i);
-        if (!user)
-            throw new Huggle::NullPointerException("WikiUser user", BOOST_CURRENT_FUNCTION);
-        if (user->GetBadnessScore(false) == 0 && user->warningLevel == 0)
+        ProblematicUserShard &shard = problematicUsers[i++];
+        QWriteLocker locker(&shard.Lock);
+        // users from the list may be changed directly, not only by UpdateUser, so all of them are checked
+        QHash<ProblematicUserKey, WikiUser*>::iterator it = shard.Users.begin();
+        while (it != shard.Users.end())
         {
+            WikiUser *user = it.value();
+            if (user->BadnessScore != 0 || user->warningLevel != 0)
+            {
+                ++it;
+                continue;
+            }
             // there is no point to hold information for them
-            WikiUser::ProblematicUsers.removeAt(i);
+            it = shard.Users.erase(it);
+            if (user->Site)
+                UserReputation::Remove(user->Site->Name, user->Username);
             delete user;
-            continue;
         }
-        ++i;
     }
-    WikiUser::ProblematicUserListLock.unlock();
+}
+
+void WikiUser::StoreProblematicUsers()
+{
+    HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    int i = 0;
+    while (i < HUGGLE_PROBLEMATIC_USERS_SHARDS)
+    {
+        ProblematicUserShard &shard = problematicUsers[i++];
+        QReadLocker locker(&shard.Lock);
+        foreach (WikiUser *user, shard.Users)
+        {
+            if (!user->Site || (user->BadnessScore == 0 && user->warningLevel == 0))
+                continue;
+            UserReputationRecord record;
+            record.BadnessScore = user->BadnessScore;
+            record.WarningLevel = user->warningLevel;
+            record.IsReported = user->IsReported;
+            record.Expires = reputationExpires(user->Site);
+            UserReputation::Store(user->Site->Name, user->Username, record);
+        }
+    }
 }
 
 void WikiUser::UpdateUser(WikiUser *us)
+{
+    WikiUser::updateUser(us, false);
+}
+
+void WikiUser::updateUser(WikiUser *us, bool matching_only, bool call_hooks)
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
-    WikiUser::ProblematicUserListLock.lock();
+    if (matching_only && WikiUser::RetrieveUser(us) == nullptr)
+        return;
     WikiUser::UpdateWl(us, us->GetBadnessScore(false));
-    foreach (WikiUser *user, WikiUser::ProblematicUsers)
+    ProblematicUserKey key = problematicUserKey(us->Username, us->Site);
+    ProblematicUserShard &shard = problematicUserShard(key);
+    bool changed = false;
+    bool inserted = false;
+    shard.Lock.lockForWrite();
+    WikiUser *user = shard.Users.value(key, nullptr);
+    if (user != nullptr)
     {
-        if (user->Username == us->Username)
+        user->BadnessScore = us->BadnessScore;
+        if (user->warningLevel != us->warningLevel)
         {
-            user->BadnessScore = us->BadnessScore;
-            if (user->warningLevel != us->warningLevel)
-            {
-                user->warningLevel = us->warningLevel;
-                Hooks::WikiUser_Updated(us);
-            }
-            user->whitelistInfo = us->whitelistInfo;
-            if (us->IsReported)
-            {
-                user->IsReported = true;
-            }
-            user->talkPageWasRetrieved = us->talkPageWasRetrieved;
-            user->dateOfTalkPage = us->dateOfTalkPage;
-            user->contentsOfTalkPage = us->contentsOfTalkPage;
-            user->LastMessageTime = us->LastMessageTime;
-            user->LastMessageTimeKnown = us->LastMessageTimeKnown;
-            if (!us->IsIP() && user->EditCount < 0)
-            {
-                user->EditCount = us->EditCount;
-            }
-            WikiUser::ProblematicUserListLock.unlock();
-            return;
+            user->warningLevel = us->warningLevel;
+            changed = true;
+        }
+        user->whitelistInfo = us->whitelistInfo;
+        if (us->IsReported)
+        {
+            user->IsReported = true;
+        }
+        user->talkPageWasRetrieved = us->talkPageWasRetrieved;
+        user->dateOfTalkPage = us->dateOfTalkPage;
+        user->contentsOfTalkPage = us->contentsOfTalkPage;
+        user->talkPageRevision = us->talkPageRevision;
+        user->LastMessageTime = us->LastMessageTime;
+        user->LastMessageTimeKnown = us->LastMessageTimeKnown;
+        if (!us->IsIP() && user->EditCount < 0)
+        {
+            user->EditCount = us->EditCount;
         }
+    } else if (!matching_only)
+    {
+        user = new WikiUser(us);
+        shard.Users.insert(key, user);
+        inserted = true;
     }
-    ProblematicUsers.append(new WikiUser(us));
-    WikiUser::ProblematicUserListLock.unlock();
-
-    if (us->GetWarningLevel() > 0)
+    // reputation is written right away, so that it's not lost if huggle crashes, store skips records that didn't change
+    bool store = false;
+    UserReputationRecord record;
+    QString site_name;
+    QString username;
+    if (user != nullptr && user->Site && (user->BadnessScore != 0 || user->warningLevel != 0))
+    {
+        store = true;
+        record.BadnessScore = user->BadnessScore;
+        record.WarningLevel = user->warningLevel;
+        record.IsReported = user->IsReported;
+        record.Expires = reputationExpires(user->Site);
+        site_name = user->Site->Name;
+        username = user->Username;
+    }
+    shard.Lock.unlock();
+    if (store)
+        UserReputation::Store(site_name, username, record);
+
+    if (!call_hooks)
+        return;
+    // hooks are called without lock, because they usually look at the user again
+    if (changed)
+    {
+        Hooks::WikiUser_Updated(us);
+    } else if (inserted && us->GetWarningLevel() > 0)
     {
         // this user has higher warning level than 0 so we need to update interface in case it was already somewhere
         Hooks::WikiUser_Updated(us);
@@ -191,6 +293,7 @@ WikiUser::WikiUser(WikiUser *u) : MediaWikiObject(u)
     this->dateOfTalkPage = u->dateOfTalkPage;
     this->IsBlocked = u->IsBlocked;
     this->contentsOfTalkPage = u->contentsOfTalkPage;
+    this->talkPageRevision = u->talkPageRevision;
     this->IsReported = u->IsReported;
     this->talkPageWasRetrieved = u->talkPageWasRetrieved;
     this->whitelistInfo = HUGGLE_WL_UNKNOWN;
@@ -212,6 +315,7 @@ WikiUser::WikiUser(const WikiUser &u) : MediaWikiObject(u)
     this->IsBlocked = u.IsBlocked;
     this->dateOfTalkPage = u.dateOfTalkPage;
     this->contentsOfTalkPage = u.contentsOfTalkPage;
+    this->talkPageRevision = u.talkPageRevision;
     this->talkPageWasRetrieved = u.talkPageWasRetrieved;
     this->whitelistInfo = HUGGLE_WL_UNKNOWN;
     this->isBot = u.isBot;
@@ -265,6 +369,7 @@ bool WikiUser::Resync()
     {
         this->BadnessScore = user->BadnessScore;
         this->contentsOfTalkPage = user->TalkPage_GetContents();
+        this->talkPageRevision = user->TalkPage_GetRevision();
         this->talkPageWasRetrieved = user->talkPageWasRetrieved;
         this->dateOfTalkPage = user->dateOfTalkPage;
         if (user->warningLevel > this->warningLevel)
@@ -277,6 +382,18 @@ bool WikiUser::Resync()
         this->LastMessageTimeKnown = user->LastMessageTimeKnown;
         return true;
     }
+    UserReputationRecord record;
+    if (this->Site && UserReputation::Lookup(this->Site->Name, this->Username, &record))
+    {
+        // user is known from previous session, so we put it to the list, this is also called from constructor
+        // so we must not call hooks with it
+        this->BadnessScore = record.BadnessScore;
+        if (record.WarningLevel > this->warningLevel)
+            this->warningLevel = record.WarningLevel;
+        this->IsReported = this->IsReported || record.IsReported;
+        WikiUser::updateUser(this, false, false);
+        return true;
+    }
     return false;
 }
 
@@ -302,12 +419,24 @@ QString WikiUser::TalkPage_GetContents()
     return contents;
 }
 
-void WikiUser::TalkPage_SetContents(const QString &text)
+revid_ht WikiUser::TalkPage_GetRevision()
+{
+    this->userMutex->lock();
+    WikiUser *user = WikiUser::RetrieveUser(this);
+    revid_ht revision = this->talkPageRevision;
+    if (user != nullptr && user->TalkPage_WasRetrieved())
+        revision = user->talkPageRevision;
+    this->userMutex->unlock();
+    return revision;
+}
+
+void WikiUser::TalkPage_SetContents(const QString &text, revid_ht revision)
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
     this->userMutex->lock();
     this->talkPageWasRetrieved = true;
     this->contentsOfTalkPage = text;
+    this->talkPageRevision = revision;
     this->dateOfTalkPage = QDateTime::currentDateTime();
     this->Update();
     this->userMutex->unlock();
@@ -316,27 +445,37 @@ void WikiUser::TalkPage_SetContents(const QString &text)
 void WikiUser::Update(bool MatchingOnly)
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
-    WikiUser::ProblematicUserListLock.lock();
-    if (MatchingOnly)
-    {
-        // here we want to update the user only if it already is in database so we
-        // need to check if it is there and if yes, we continue
-        if (WikiUser::RetrieveUser(this) == nullptr)
-        {
-            WikiUser::ProblematicUserListLock.unlock();
-            return;
-        }
-    }
-    WikiUser::UpdateUser(this);
-    WikiUser::ProblematicUserListLock.unlock();
+    WikiUser::updateUser(this, MatchingOnly);
 }
 
 void WikiUser::ParseTP(QDate bt)
 {
+    revid_ht revision = this->TalkPage_GetRevision();
     QString tp = this->TalkPage_GetContents();
     if (tp.length() > 0)
     {
-        this->warningLevel = HuggleParser::GetLevel(tp, bt, this->GetSite());
+        byte_ht level;
+        // if the talk page changed while we were reading it we can't tell which revision the text belongs to
+        if (revision == WIKI_UNKNOWN_REVID || revision != this->TalkPage_GetRevision())
+        {
+            level = HuggleParser::GetLevel(tp, bt, this->GetSite());
+        } else
+        {
+            // same revision of talk page is usually parsed for every edit of the user, so the result is remembered,
+            // settings that change the result of parser are part of the key
+            ProjectConfiguration *conf = this->GetSite()->GetProjectConfig();
+            QString key = QString::number(revision) + "\n" + QString::number(bt.toJulianDay()) + "\n" +
+                          QString::number(conf->TemplateAge) + "\n" + (hcfg->SystemConfig_TrimOldWarnings ? "1" : "0");
+            if (!conf->GetCachedWarningLevel(key, &level))
+            {
+                level = HuggleParser::GetLevel(tp, bt, this->GetSite());
+                conf->CacheWarningLevel(key, level);
+            }
+        }
+        // edits of this user can be scored by several threads at same time
+        this->userMutex->lock();
+        this->warningLevel = level;
+        this->userMutex->unlock();
     }
 }
 
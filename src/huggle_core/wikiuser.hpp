@@ -33,6 +33,10 @@ namespace Huggle
         public:
             //! Delete all users that have badness score 0 these users aren't necessary to be stored in a list
             static void TrimProblematicUsersList();
+            //! Write reputation of all problematic users to UserReputation store, so that they are known in next session
+
+            //! UpdateUser writes the record of user whenever it changes, this catches users that were changed directly
+            static void StoreProblematicUsers();
             static bool CompareUsernames(QString a, QString b);
             //! Update a list of problematic users
             static void UpdateUser(WikiUser *us);
@@ -50,13 +54,8 @@ namespace Huggle
              */
             static WikiUser *RetrieveUser(const QString &user, WikiSite *site);
             static WikiUser *RetrieveUser(WikiUser *user);
-            /*!
-             * \brief List of users that are scored in this instance of huggle
-             *
-             * Either vandals or even good users, this list is preserved on shutdown and startup
-             */
-            static QList<WikiUser*> ProblematicUsers;
-            static QMutex ProblematicUserListLock;
+            //! Number of users that are scored in this instance of huggle, either vandals or even good users
+            static int GetProblematicUserCount();
             static QDateTime InvalidTime;
 
             WikiUser(WikiSite *site);
@@ -79,8 +78,11 @@ namespace Huggle
             /*!
              * \brief SetContentsOfTalkPage Change a cache for talk page in local and global cache
              * \param text New content of talk page
+             * \param revision Id of revision of the text, if it's known
              */
-            void TalkPage_SetContents(const QString &text);
+            void TalkPage_SetContents(const QString &text, revid_ht revision = WIKI_UNKNOWN_REVID);
+            //! Id of revision of talk page returned by TalkPage_GetContents(), WIKI_UNKNOWN_REVID if we don't know it
+            revid_ht TalkPage_GetRevision();
             //! Call UpdateUser on current user
             void Update(bool MatchingOnly = false);
             QString UnderscorelessUsername();
@@ -100,6 +102,8 @@ namespace Huggle
 
             //! This is useful when you created user in past and since then a global user has changed
             //! so that you just call this to refresh all the scores and information or stuff
+
+            //! Users that are not known in this session are looked up in UserReputation store
             bool Resync();
             //! Return a name of talk page of this user (like User talk:Jimbo)
             QString GetTalk();
@@ -151,6 +155,8 @@ namespace Huggle
             QDateTime LastMessageTime;
 
     protected:
+            //! Update user in list of problematic users, if matching_only is true the user is not inserted if it isn't there
+            static void updateUser(WikiUser *us, bool matching_only, bool call_hooks = true);
             //! Matches only IPv4
             static QRegExp IPv4Regex;
             //! Matches all IP
@@ -169,6 +175,7 @@ namespace Huggle
             byte_ht whitelistInfo;
             //! In case that we retrieved the talk page during parse of warning level, this string contains it
             QString contentsOfTalkPage;
+            revid_ht talkPageRevision = WIKI_UNKNOWN_REVID;
             bool talkPageWasRetrieved;
             //! This is a date when we retrieved this talk page
             QDateTime dateOfTalkPage;
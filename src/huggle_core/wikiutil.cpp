@@ -25,21 +25,11 @@
 
 using namespace Huggle;
 
-bool WikiUtil::IsRevert(const QString &summary)
+bool WikiUtil::IsRevert(const QString &summary, WikiSite *site)
 {
-    if (summary.size() > 0)
-    {
-        int xx = 0;
-        while (xx < Configuration::HuggleConfiguration->ProjectConfig->_revertPatterns.count())
-        {
-            if (summary.contains(Configuration::HuggleConfiguration->ProjectConfig->_revertPatterns.at(xx)))
-            {
-                return true;
-            }
-            xx++;
-        }
-    }
-    return false;
+    if (site == nullptr)
+        throw new Huggle::NullPointerException("WikiSite *site", BOOST_CURRENT_FUNCTION);
+    return site->GetProjectConfig()->Summaries.IsRevert(summary);
 }
 
 QString WikiUtil::MonthText(int n, WikiSite *site)
@@ -214,7 +204,7 @@ Collectable_SmartPtr<ApiQuery> WikiUtil::Unwatchlist(WikiPage *page)
         return wt;
     }
     wt->Parameters = "titles=" + page->EncodedName() + "&unwatch=1&token=" + QUrl::toPercentEncoding(page->GetSite()->GetProjectConfig()->Token_Watch);
-    QueryPool::HugglePool->PendingWatches.append(wt);
+    QueryPool::HugglePool->PendingWatches.insert(wt);
     wt->Process();
     return wt;
 }
@@ -234,7 +224,7 @@ Collectable_SmartPtr<ApiQuery> WikiUtil::Watchlist(WikiPage *page)
         return wt;
     }
     wt->Parameters = "titles=" + page->EncodedName() + "&token=" + QUrl::toPercentEncoding(page->GetSite()->GetProjectConfig()->Token_Watch);
-    QueryPool::HugglePool->PendingWatches.append(wt);
+    QueryPool::HugglePool->PendingWatches.insert(wt);
     wt->Process();
     return wt;
 }
@@ -415,12 +405,14 @@ void WikiUtil::RetrieveEditByRevid(revid_ht revid, WikiSite *site, void *source,
 
 /////////////////////////////////////////////////////////////////
 
-Collectable_SmartPtr<ApiQuery> WikiUtil::APIRequest(Action action, WikiSite *site, const QString &parameters, bool using_post, const QString &target)
+Collectable_SmartPtr<ApiQuery> WikiUtil::APIRequest(Action action, WikiSite *site, const QString &parameters, bool using_post, const QString &target,
+                                                   ApiQuery::Priority priority)
 {
     Collectable_SmartPtr <ApiQuery> request = new ApiQuery(action, site);
     request->Parameters = parameters;
     request->UsingPOST = using_post;
     request->Target = target;
+    request->RequestPriority = priority;
     HUGGLE_QP_APPEND(request);
     request->Process();
     return request;
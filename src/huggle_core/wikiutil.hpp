@@ -47,10 +47,13 @@ namespace Huggle
          * \param parameters Parameters of query
          * \param using_post If request should be submitted using POST method of HTTP protocol
          * \param target     Optional target name
+         * \param priority   Priority with which QueryScheduler sends the request
          * \return           Pointer to ApiQuery
          */
-        HUGGLE_EX_CORE Collectable_SmartPtr<ApiQuery> APIRequest(Action action, WikiSite *site, const QString &parameters, bool using_post = false, const QString &target = "");
-        HUGGLE_EX_CORE bool IsRevert(const QString &summary);
+        HUGGLE_EX_CORE Collectable_SmartPtr<ApiQuery> APIRequest(Action action, WikiSite *site, const QString &parameters, bool using_post = false,
+                                                                 const QString &target = "", ApiQuery::Priority priority = ApiQuery::PriorityAuto);
+        //! Returns true if summary matches one of revert patterns of given site
+        HUGGLE_EX_CORE bool IsRevert(const QString &summary, WikiSite *site);
         //! Return a localized month for a current wiki
         HUGGLE_EX_CORE QString MonthText(int n, WikiSite *site = nullptr);
         /*!
@@ -60,7 +60,7 @@ void WLQuery::Kill()
         QObject::disconnect(this->networkReply, SIGNAL(readyRead()), this, SLOT(readData()));
         if (this->status == StatusProcessing)
         {
-            this->status = StatusKilled;
+            this->SetStatus(StatusKilled);
             this->disconnect(this->networkReply);
             this->networkReply->abort();
             this->networkReply->disconnect(this);
@@ -80,10 +80,10 @@ void WLQuery::Process()
         Syslog::HuggleLogs->ErrorLog("Unable to process WL request, there is no whitelist server defined");
         this->Result = new QueryResult();
         this->Result->SetError("Invalid URL");
-        this->status = Query::StatusInError;
+        this->SetStatus(Query::StatusInError);
         return;
     }
-    this->status = StatusProcessing;
+    this->SetStatus(StatusProcessing);
     this->Result = new QueryResult();
     QUrl url(Configuration::HuggleConfiguration->GlobalConfig_Whitelist
              + "?action=read&wp=" + this->GetSite()->WhiteList);
@@ -164,7 +164,7 @@ void WLQuery::finished()
     }
     this->networkReply->deleteLater();
     this->networkReply = nullptr;
-    this->status = StatusDone;
+    this->SetStatus(StatusDone);
 }
 
 void WLQuery::writeProgress(qint64 n, qint64 m)
@@ -38,6 +38,7 @@ namespace Huggle
             QString QueryTargetToString() override;
             //! Returns a type of query as a string
             QString QueryTypeToString() override;
+            bool IsPolled() override { return false; }
             void Kill() override;
             void Process() override;
             QString Parameters;
@@ -0,0 +1,87 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "editlatencyform.hpp"
+#include <QFileInfo>
+#include <QHeaderView>
+#include <huggle_core/configuration.hpp>
+#include <huggle_core/editlatency.hpp>
+#include <huggle_core/localization.hpp>
+#include <huggle_core/syslog.hpp>
+#include "ui_editlatencyform.h"
+
+using namespace Huggle;
+
+EditLatencyForm::EditLatencyForm(QWidget *parent) : QDockWidget(parent), ui(new Ui::EditLatencyForm)
+{
+    this->ui->setupUi(this);
+    this->setWindowTitle(_l("latency-widget-name"));
+    this->ui->pushButtonReset->setText(_l("latency-reset"));
+    this->ui->pushButtonDump->setText(_l("latency-dump"));
+    QStringList header;
+    header << _l("latency-interval") << _l("latency-count") << "avg (ms)" << "p50 (ms)" << "p95 (ms)" << "p99 (ms)" << "max (ms)";
+    this->ui->tableWidget->setColumnCount(header.count());
+    this->ui->tableWidget->setHorizontalHeaderLabels(header);
+    this->ui->tableWidget->verticalHeader()->setVisible(false);
+    this->ui->tableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    this->ui->tableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    this->ui->tableWidget->setShowGrid(false);
+    this->timer = new QTimer(this);
+    connect(this->timer, SIGNAL(timeout()), this, SLOT(OnTick()));
+    this->timer->start(2000);
+}
+
+EditLatencyForm::~EditLatencyForm()
+{
+    delete this->ui;
+}
+
+void EditLatencyForm::Refresh()
+{
+    int count = EditLatency::GetIntervalCount();
+    this->ui->tableWidget->setRowCount(count);
+    int interval = 0;
+    while (interval < count)
+    {
+        LatencyHistogram histogram = EditLatency::GetHistogram(interval);
+        this->ui->tableWidget->setItem(interval, 0, new QTableWidgetItem(EditLatency::GetIntervalName(interval)));
+        this->ui->tableWidget->setItem(interval, 1, new QTableWidgetItem(QString::number(histogram.GetCount())));
+        this->ui->tableWidget->setItem(interval, 2, new QTableWidgetItem(QString::number(histogram.GetAverage(), 'f', 2)));
+        this->ui->tableWidget->setItem(interval, 3, new QTableWidgetItem(QString::number(histogram.GetPercentile(50), 'f', 2)));
+        this->ui->tableWidget->setItem(interval, 4, new QTableWidgetItem(QString::number(histogram.GetPercentile(95), 'f', 2)));
+        this->ui->tableWidget->setItem(interval, 5, new QTableWidgetItem(QString::number(histogram.GetPercentile(99), 'f', 2)));
+        this->ui->tableWidget->setItem(interval, 6, new QTableWidgetItem(QString::number(histogram.GetMax(), 'f', 2)));
+        interval++;
+    }
+}
+
+void EditLatencyForm::OnTick()
+{
+    // there is no point in updating the table no one can see
+    if (this->isVisible())
+        this->Refresh();
+}
+
+void EditLatencyForm::on_pushButtonReset_clicked()
+{
+    EditLatency::Reset();
+    this->Refresh();
+}
+
+void EditLatencyForm::on_pushButtonDump_clicked()
+{
+    QString path = Configuration::GetConfigurationPath() + "latency.txt";
+    if (!EditLatency::Dump(path))
+    {
+        Syslog::HuggleLogs->ErrorLog("Unable to write to " + path);
+        return;
+    }
+    Syslog::HuggleLogs->Log(_l("latency-dumped", QFileInfo(path).absoluteFilePath()));
+}
@@ -0,0 +1,44 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef EDITLATENCYFORM_HPP
+#define EDITLATENCYFORM_HPP
+
+#include <huggle_core/definitions.hpp>
+
+#include <QDockWidget>
+#include <QTimer>
+
+namespace Ui
+{
+    class EditLatencyForm;
+}
+
+namespace Huggle
+{
+    //! Displays percentiles of time that edits spend in every stage of processing, see EditLatency
+    class HUGGLE_EX_UI EditLatencyForm : public QDockWidget
+    {
+            Q_OBJECT
+        public:
+            explicit EditLatencyForm(QWidget *parent = nullptr);
+            ~EditLatencyForm();
+            void Refresh();
+        private slots:
+            void OnTick();
+            void on_pushButtonReset_clicked();
+            void on_pushButtonDump_clicked();
+        private:
+            QTimer *timer;
+            Ui::EditLatencyForm *ui;
+    };
+}
+
+#endif // EDITLATENCYFORM_HPP
@@ -9,6 +9,8 @@
 //GNU General Public License for more details.
 
 #include <huggle_core/configuration.hpp>
+#include <huggle_core/editlatency.hpp>
+#include <huggle_core/editregistry.hpp>
 #include <huggle_core/exception.hpp>
 #include <huggle_core/hooks.hpp>
 #include <huggle_core/huggleprofiler.hpp>
@@ -89,33 +91,12 @@ void HuggleQueue::AddItem(WikiEdit *edit)
     if (Configuration::HuggleConfiguration->UserConfig->DeleteEditsAfterRevert)
     {
         // check if there was a revert to this edit which is newer than itself
-        int i = 0;
-        WikiEdit::Lock_EditList->lock();
-        while (i < Huggle::WikiEdit::EditList.count())
+        if (EditRegistry::IsReverted(edit))
         {
-            // retrieve the edit
-            WikiEdit *current_edit = Huggle::WikiEdit::EditList.at(i++);
-            if (!current_edit->IsPostProcessed())
-                continue;
-            // if this is a same edit we can go next
-            if (current_edit == edit)
-                continue;
-            // if this edit is not newer we can continue
-            if (current_edit->RevID < edit->RevID)
-                continue;
-            // if edit is not a revert we can continue
-            if (!current_edit->IsRevert)
-                continue;
-            // if edit is not made to this page, we can continue
-            if (current_edit->Page->SanitizedName() != edit->Page->SanitizedName())
-                continue;
-            // we found it
             HUGGLE_DEBUG("Ignoring edit to " + edit->Page->PageName + " because it was reverted by someone", 1);
-            WikiEdit::Lock_EditList->unlock();
             edit->UnregisterConsumer(HUGGLECONSUMER_QUEUE);
             return;
         }
-        WikiEdit::Lock_EditList->unlock();
     }
     if (Configuration::HuggleConfiguration->UserConfig->TruncateEdits)
     {
@@ -165,6 +146,8 @@ void HuggleQueue::AddItem(WikiEdit *edit)
 
     this->Items.append(label);
     this->RedrawTitle();
+    edit->Latency.Mark(EditLatencyStage_Queued);
+    EditLatency::Record(edit->Latency);
 
     if (hcfg->SystemConfig_PlaySoundOnQueue && edit->Score >= hcfg->SystemConfig_PlaySoundQueueScore)
         Resources::PlayEmbeddedSoundFile("not1.wav");
@@ -644,7 +644,8 @@ bool LoginForm::retrieveGlobalConfig()
     this->Update(_l("[[login-progress-global]]"));
     this->qConfig = new ApiQuery(ActionQuery, hcfg->GlobalWiki);
     this->qConfig->OverrideWiki = hcfg->SystemConfig_GlobalConfigurationWikiAddress;
-    this->qConfig->Parameters = "prop=revisions&rvprop=content&rvlimit=1&titles=" + hcfg->SystemConfig_GlobalConfigYAML;
+    this->qConfig->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|content") + "&rvlimit=1&titles=" + hcfg->SystemConfig_GlobalConfigYAML;
+    this->qConfig->CachePolicy = ResponseCache::PolicyValidated;
     this->qConfig->Process();
     return false;
 }
@@ -829,7 +830,8 @@ void LoginForm::retrieveProjectYamlConfig(WikiSite *site)
     query->IncRef();
     if (!hcfg->GlobalConfig_OverrideConfigYAMLPath.isEmpty())
         hcfg->GlobalConfig_LocalConfigYAMLPath = hcfg->GlobalConfig_OverrideConfigYAMLPath;
-    query->Parameters = "prop=revisions&rvprop=content&rvlimit=1&titles=" + hcfg->GlobalConfig_LocalConfigYAMLPath;
+    query->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|content") + "&rvlimit=1&titles=" + hcfg->GlobalConfig_LocalConfigYAMLPath;
+    query->CachePolicy = ResponseCache::PolicyValidated;
     query->Process();
     this->LoginQueries.insert(site, query);
 }
@@ -891,7 +893,8 @@ void LoginForm::retrieveProjectConfig(WikiSite *site)
     this->loadingForm->ModifyIcon(this->GetRowIDForSite(site, LOGINFORM_LOCALCONFIG), LoadingForm_Icon_Loading);
     ApiQuery *query = new ApiQuery(ActionQuery, site);
     query->IncRef();
-    query->Parameters = "prop=revisions&rvprop=content&rvlimit=1&titles=" + hcfg->GlobalConfig_LocalConfigWikiPath;
+    query->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|content") + "&rvlimit=1&titles=" + hcfg->GlobalConfig_LocalConfigWikiPath;
+    query->CachePolicy = ResponseCache::PolicyValidated;
     query->Process();
     this->LoginQueries.insert(site, query);
 }
@@ -927,7 +930,8 @@ void LoginForm::retrieveUserConfig(WikiSite *site)
                     q->IncRef();
                     QString page = hcfg->GlobalConfig_UserConf_old;
                     page = page.replace("$1", hcfg->SystemConfig_UserName);
-                    q->Parameters = "prop=revisions&rvprop=content&rvlimit=1&titles=" + QUrl::toPercentEncoding(page);
+                    q->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|content") + "&rvlimit=1&titles=" + QUrl::toPercentEncoding(page);
+                    q->CachePolicy = ResponseCache::PolicyValidated;
                     q->Process();
                     return;
                 }
@@ -985,7 +989,8 @@ void LoginForm::retrieveUserConfig(WikiSite *site)
     this->LoginQueries.insert(site, query);
     QString page = hcfg->GlobalConfig_UserConf;
     page = page.replace("$1", hcfg->SystemConfig_UserName);
-    query->Parameters = "prop=revisions&rvprop=content&rvlimit=1&titles=" + QUrl::toPercentEncoding(page);
+    query->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|content") + "&rvlimit=1&titles=" + QUrl::toPercentEncoding(page);
+    query->CachePolicy = ResponseCache::PolicyValidated;
     query->Process();
 }
 
@@ -1523,7 +1528,8 @@ void LoginForm::on_pushButton_clicked()
     this->timer->start(HUGGLE_TIMER);
     this->qDatabase->OverrideWiki = hcfg->SystemConfig_GlobalConfigurationWikiAddress;
     this->ui->ButtonOK->setText(_l("[[cancel]]"));
-    this->qDatabase->Parameters = "prop=revisions&rvprop=content&rvlimit=1&titles=" + hcfg->SystemConfig_GlobalConfigWikiList;
+    this->qDatabase->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|content") + "&rvlimit=1&titles=" + hcfg->SystemConfig_GlobalConfigWikiList;
+    this->qDatabase->CachePolicy = ResponseCache::PolicyValidated;
     this->qDatabase->Process();
 }
 
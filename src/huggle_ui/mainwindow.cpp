@@ -17,6 +17,7 @@
 #include "history.hpp"
 #include "hugglelog.hpp"
 #include "huggletool.hpp"
+#include "editlatencyform.hpp"
 #include "hugglequeue.hpp"
 #include "hugglequeueitemlabel.hpp"
 #include "ignorelist.hpp"
@@ -45,16 +46,20 @@
 #include "requestprotect.hpp"
 #include "queuehelp.hpp"
 #include <huggle_core/apiquery.hpp>
+#include <huggle_core/apiquerybatch.hpp>
 #include <huggle_core/apiqueryresult.hpp>
+#include <huggle_core/editregistry.hpp>
 #include <huggle_core/events.hpp>
 #include <huggle_core/configuration.hpp>
 #include <huggle_core/generic.hpp>
 #include <huggle_core/gc.hpp>
 #include <huggle_core/querypool.hpp>
+#include <huggle_core/responsecache.hpp>
 #include <huggle_core/hooks.hpp>
 #include <huggle_core/hugglefeedproviderwiki.hpp>
 #include <huggle_core/hugglefeedproviderirc.hpp>
 #include <huggle_core/hugglefeedproviderxml.hpp>
+#include <huggle_core/hugglefeedproviderreplay.hpp>
 #include <huggle_core/huggleparser.hpp>
 #include <huggle_core/huggleprofiler.hpp>
 
@@ -90,6 +95,7 @@
 #include <QVBoxLayout>
 #include <QSplitter>
 #include <QDockWidget>
+#include <QtXml>
 #include "aboutform.hpp"
 #ifdef DeleteForm
     #undef DeleteForm
@@ -139,6 +145,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     this->wHistory = new HistoryForm(this);
     this->wUserInfo = new UserinfoForm(this);
     this->VandalDock = new VandalNw(this);
+    this->wLatency = new EditLatencyForm(this);
     this->addDockWidget(Qt::LeftDockWidgetArea, this->Queue1);
     this->addDockWidget(Qt::BottomDockWidgetArea, this->SystemLog);
     this->addDockWidget(Qt::TopDockWidgetArea, this->tb);
@@ -147,7 +154,9 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     this->addDockWidget(Qt::RightDockWidgetArea, this->wUserInfo);
     this->addDockWidget(Qt::BottomDockWidgetArea, this->VandalDock);
     this->addDockWidget(Qt::TopDockWidgetArea, this->wEditBar);
+    this->addDockWidget(Qt::BottomDockWidgetArea, this->wLatency);
     this->wEditBar->hide();
+    this->wLatency->hide();
     this->aboutForm = nullptr;
     this->ui->actionDisplay_bot_data->setChecked(hcfg->UserConfig->HAN_DisplayBots);
     this->ui->actionDisplay_user_data->setChecked(hcfg->UserConfig->HAN_DisplayUser);
@@ -224,8 +233,14 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
         this->huggleFeeds.append(new HuggleFeedProviderWiki(site));
         this->huggleFeeds.append(new HuggleFeedProviderIRC(site));
         this->huggleFeeds.append(new HuggleFeedProviderXml(site));
+        // replay of recorded feed replaces the live one, it's only available when requested from command line
+        if (!hcfg->FeedReplayPath.isEmpty())
+            this->huggleFeeds.append(new HuggleFeedProviderReplay(site, hcfg->FeedReplayPath, hcfg->FeedReplaySpeed));
         Hooks::FeedProvidersOnInit(site);
-        this->ChangeProvider(site, hcfg->UserConfig->PreferredProvider);
+        if (!hcfg->FeedReplayPath.isEmpty())
+            this->ChangeProvider(site, HUGGLE_FEED_PROVIDER_REPLAY);
+        else
+            this->ChangeProvider(site, hcfg->UserConfig->PreferredProvider);
     }
     if (hcfg->DeveloperMode)
     {
@@ -353,6 +368,7 @@ MainWindow::~MainWindow()
     delete this->tStatusBarRefreshTimer;
     delete this->RevertSummaries;
     delete this->Queries;
+    delete this->wLatency;
     delete this->aboutForm;
     delete this->fSessionData;
     delete this->fScoreWord;
@@ -708,9 +724,22 @@ void MainWindow::UpdateStatusBarData()
                << Generic::ShrinkText(QString::number(RevertsPerMinute), 6)
                << Generic::ShrinkText(QString::number(VandalismLevel), 8);
         statistics_ = " <font color=" + color + ">" + _l("main-stat", counter_params) + "</font>";
+        unsigned long long dropped = this->GetCurrentWikiSite()->Provider->GetDroppedEdits();
+        if (dropped > 0)
+            statistics_ += " <font color=red>" + _l("main-stat-dropped", QString::number(dropped)) + "</font>";
     }
     if (hcfg->Verbosity > 0)
-        statistics_ += " QGC: " + QString::number(GC::gc->list.count()) + " U: " + QString::number(WikiUser::ProblematicUsers.count());
+    {
+        statistics_ += " QGC: " + QString::number(GC::gc->Count()) + " U: " + QString::number(WikiUser::GetProblematicUserCount());
+        WikiEdit_ProcessorPool *pool = WikiEdit_ProcessorPool::Pool;
+        if (pool != nullptr)
+            statistics_ += " PP: " + QString::number(pool->GetPendingCount()) + " wait " + QString::number(pool->GetAverageWaitTime(), 'f', 2) +
+                           "ms (max " + QString::number(pool->GetMaxWaitTime(), 'f', 2) + "ms) score " +
+                           QString::number(pool->GetAverageProcessingTime(), 'f', 2) + "ms";
+        statistics_ += " B: " + QString::number(ApiQueryBatch::ValuesRequested) + "/" + QString::number(ApiQueryBatch::QueriesSent);
+        statistics_ += " C: " + QString::number(ApiQuery::CoalescedHits) + "/" + QString::number(ApiQuery::CoalescedMisses);
+        statistics_ += " RC: " + ResponseCache::ToString();
+    }
     params << statistics_ << this->GetCurrentWikiSite()->Name;
     QString status_text = _l("main-status-bar", params);
 #ifdef HUGGLE_METRICS
@@ -1548,24 +1577,32 @@ void MainWindow::OnMainTimerTick()
     if (this->PendingEdits.count() > 0)
     {
         // postprocessed edits can be added to queue
+        QList<WikiEdit*> ready;
         int c = 0;
         while (c < this->PendingEdits.count())
         {
             if (this->PendingEdits.at(c)->IsReady() && this->PendingEdits.at(c)->IsPostProcessed())
             {
-                WikiEdit *edit = this->PendingEdits.at(c);
-                Hooks::WikiEdit_ScoreJS(edit);
-                // We need to check the edit against filter once more, because some of the checks work
-                // only on post processed edits
-                if (edit->GetSite()->CurrentFilter->Matches(edit))
-                    this->Queue1->AddItem(edit);
+                ready.append(this->PendingEdits.at(c));
                 this->PendingEdits.removeAt(c);
-                edit->UnregisterConsumer(HUGGLECONSUMER_MAINPEND);
             } else
             {
                 c++;
             }
         }
+        // all edits that are ready are rescored at once, so that every script is entered only once per tick
+        foreach (WikiEdit *edit, ready)
+            edit->Latency.Mark(EditLatencyStage_RescoreStarted);
+        Hooks::WikiEdit_ScoreJS(ready);
+        foreach (WikiEdit *edit, ready)
+        {
+            edit->Latency.Mark(EditLatencyStage_Rescored);
+            // We need to check the edit against filter once more, because some of the checks work
+            // only on post processed edits
+            if (edit->GetSite()->CurrentFilter->Matches(edit))
+                this->Queue1->AddItem(edit);
+            edit->UnregisterConsumer(HUGGLECONSUMER_MAINPEND);
+        }
     }
     // let's refresh the edits that are being post processed
     if (QueryPool::HugglePool->ProcessingEdits.count() > 0)
@@ -1600,6 +1637,7 @@ void MainWindow::OnMainTimerTick()
         }
     }
     this->Queries->RemoveExpired();
+    this->Queries->RefreshScheduler();
     if (this->OnNext_EvPage != nullptr && this->qNext != nullptr && this->qNext->IsProcessed())
     {
         this->tb->SetPage(this->OnNext_EvPage);
@@ -2282,7 +2320,7 @@ void MainWindow::DisplayRevid(revid_ht revid, WikiSite *site)
 {
     // kill currently displayed edit
     this->LockPage();
-    Collectable_SmartPtr<WikiEdit> edit = WikiEdit::FromCacheByRevID(revid);
+    Collectable_SmartPtr<WikiEdit> edit = WikiEdit::FromCacheByRevID(revid, "prev", site);
     if (edit != nullptr)
     {
         this->ProcessEdit(edit);
@@ -2303,7 +2341,7 @@ void MainWindow::PauseQueue()
 
     this->QueueIsNowPaused = true;
     foreach (WikiSite *site, Configuration::HuggleConfiguration->Projects)
-        site->Provider->Pause();
+        site->Provider->PauseByUser();
 }
 
 void MainWindow::ResumeQueue()
@@ -2313,7 +2351,7 @@ void MainWindow::ResumeQueue()
 
     this->QueueIsNowPaused = false;
     foreach (WikiSite *site, Configuration::HuggleConfiguration->Projects)
-        site->Provider->Resume();
+        site->Provider->ResumeByUser();
 }
 
 void MainWindow::FlagGood()
@@ -2544,7 +2582,7 @@ void MainWindow::ChangeProvider(WikiSite *site, int id)
         this->SwitchAlternativeFeedProvider(site);
     } else if (this->QueueIsNowPaused)
     {
-        site->Provider->Pause();
+        site->Provider->PauseByUser();
     }
 }
 
@@ -2800,14 +2838,9 @@ void MainWindow::on_actionClear_talk_page_of_user_triggered()
 
 void MainWindow::on_actionList_all_QGC_items_triggered()
 {
-    int xx=0;
     GC::gc->Lock->lock();
-    while (xx<GC::gc->list.count())
-    {
-        Collectable *query = GC::gc->list.at(xx);
+    foreach (Collectable *query, GC::gc->GetList())
         Syslog::HuggleLogs->Log(query->DebugHgc());
-        xx++;
-    }
     GC::gc->Lock->unlock();
 }
 
@@ -2960,7 +2993,7 @@ void MainWindow::on_actionProtect_triggered()
 void MainWindow::on_actionEdit_info_triggered()
 {
     // don't localize this please
-    Syslog::HuggleLogs->Log("Current number of edits in memory: " + QString::number(WikiEdit::EditList.count()));
+    Syslog::HuggleLogs->Log("Current number of edits in memory: " + QString::number(EditRegistry::Count()));
 }
 
 void MainWindow::on_actionFlag_as_suspicious_edit_triggered()
@@ -3770,3 +3803,10 @@ void MainWindow::on_actionProfiler_info_triggered()
 {
     Core::HuggleCore->WriteProfilerDataIntoSyslog();
 }
+
+void MainWindow::on_actionEdit_latency_triggered()
+{
+    this->wLatency->Refresh();
+    this->wLatency->show();
+    this->wLatency->raise();
+}
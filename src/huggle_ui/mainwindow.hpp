@@ -65,6 +65,7 @@ namespace Huggle
     class SpeedyForm;
     class RevertQuery;
     class EditQuery;
+    class EditLatencyForm;
     class ProcessList;
     class WhitelistForm;
     class Message;
@@ -232,6 +233,8 @@ namespace Huggle
             SpeedyForm* fSpeedyDelete = nullptr;
             //! Pointer to processes
             ProcessList *Queries;
+            //! Latency statistics of edit processing, hidden by default
+            EditLatencyForm *wLatency;
             //! Pointer to history
             History *_History;
             //! Pointer to menu of revert warn button
@@ -409,6 +412,7 @@ namespace Huggle
             void on_actionFind_triggered();
             void on_actionEdit_page_triggered();
             void on_actionProfiler_info_triggered();
+            void on_actionEdit_latency_triggered();
 
         private:
             void closeTab(int tab);
@@ -17,6 +17,8 @@
 #include <huggle_core/exception.hpp>
 #include <huggle_core/huggleprofiler.hpp>
 #include <huggle_core/localization.hpp>
+#include <huggle_core/querypool.hpp>
+#include <huggle_core/queryscheduler.hpp>
 #include "ui_processlist.h"
 
 using namespace Huggle;
@@ -168,6 +170,13 @@ void ProcessList::RemoveExpired()
     }
 }
 
+void ProcessList::RefreshScheduler()
+{
+    if (QueryPool::HugglePool == nullptr || QueryPool::HugglePool->Scheduler == nullptr)
+        return;
+    this->ui->labelScheduler->setText(QueryPool::HugglePool->Scheduler->ToString());
+}
+
 int ProcessList::GetItem(Query *q)
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
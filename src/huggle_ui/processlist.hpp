@@ -63,6 +63,8 @@ namespace Huggle
             //! Update information about query in list
             void UpdateQuery(Query *query);
             void RemoveExpired();
+            //! Show queue depths and wait times of query scheduler
+            void RefreshScheduler();
             ~ProcessList();
         private slots:
             void ContextMenu(const QPoint& position);
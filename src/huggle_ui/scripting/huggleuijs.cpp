@@ -311,7 +311,7 @@ QJSValue HuggleUIJS::get_current_wiki_edit()
     if (!edit)
         return QJSValue(QJSValue::SpecialValue::NullValue);
 
-    return JSMarshallingHelper::FromEdit(edit, this->GetScript()->GetEngine());
+    return this->GetScript()->GetMemPool()->MarshallEdit(edit, this->GetScript()->GetEngine());
 }
 
 bool HuggleUIJS::is_current_edit_locked()
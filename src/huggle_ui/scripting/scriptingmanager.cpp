@@ -37,6 +37,12 @@ ScriptingManager::ScriptingManager(QWidget *parent) : QDialog(parent), ui(new Ui
     this->ui->tableWidget->setHorizontalHeaderLabels(headers);
     this->ui->tableWidget->setShowGrid(false);
     this->ui->tableWidget->resizeRowsToContents();
+    QStringList stats_headers;
+    stats_headers << "Script" << "Function" << "Hook" << "Calls" << "Total (ms)" << "Average (ms)" << "Max (ms)" << "Over budget" << "Status";
+    this->ui->tableStats->setColumnCount(stats_headers.count());
+    this->ui->tableStats->verticalHeader()->setVisible(false);
+    this->ui->tableStats->setHorizontalHeaderLabels(stats_headers);
+    this->ui->tableStats->setShowGrid(false);
     this->Reload();
 }
 
@@ -65,6 +71,46 @@ void ScriptingManager::Reload()
     }
     this->ui->tableWidget->resizeColumnsToContents();
     this->ui->tableWidget->resizeRowsToContents();
+    this->reloadStatistics();
+}
+
+static QTableWidgetItem *numberItem(double value)
+{
+    QTableWidgetItem *item = new QTableWidgetItem();
+    // Store the number itself, so that the columns are sorted by value rather than as text
+    item->setData(Qt::DisplayRole, value);
+    return item;
+}
+
+void ScriptingManager::reloadStatistics()
+{
+    this->ui->tableStats->setSortingEnabled(false);
+    this->ui->tableStats->setRowCount(0);
+    foreach (Script *sx, Script::GetScripts())
+    {
+        QHash<QString, ScriptFunctionStatistics> statistics = sx->GetStatistics();
+        QList<QString> disabled = sx->GetDisabledHooks().values();
+        foreach (QString function, statistics.keys())
+        {
+            const ScriptFunctionStatistics &stats = statistics[function];
+            int row = this->ui->tableStats->rowCount();
+            this->ui->tableStats->insertRow(row);
+            this->ui->tableStats->setItem(row, 0, new QTableWidgetItem(sx->GetName()));
+            this->ui->tableStats->setItem(row, 1, new QTableWidgetItem(function));
+            this->ui->tableStats->setItem(row, 2, new QTableWidgetItem(sx->GetHookOfFunction(function)));
+            this->ui->tableStats->setItem(row, 3, numberItem(static_cast<double>(stats.Calls)));
+            this->ui->tableStats->setItem(row, 4, numberItem(static_cast<double>(stats.TotalTime / 1000) / 1000));
+            double average = stats.Calls ? static_cast<double>(stats.TotalTime / stats.Calls / 1000) / 1000 : 0;
+            this->ui->tableStats->setItem(row, 5, numberItem(average));
+            this->ui->tableStats->setItem(row, 6, numberItem(static_cast<double>(stats.MaxTime / 1000) / 1000));
+            this->ui->tableStats->setItem(row, 7, numberItem(static_cast<double>(stats.Overruns)));
+            this->ui->tableStats->setItem(row, 8, new QTableWidgetItem(disabled.contains(function) ? "Disabled (too slow)" : "Active"));
+        }
+    }
+    this->ui->tableStats->setSortingEnabled(true);
+    this->ui->tableStats->sortByColumn(4, Qt::DescendingOrder);
+    this->ui->tableStats->resizeColumnsToContents();
+    this->ui->tableStats->resizeRowsToContents();
 }
 
 void ScriptingManager::LoadFile(QString path)
@@ -122,9 +168,14 @@ void ScriptingManager::on_tableWidget_customContextMenuRequested(const QPoint &p
     QAction *unload = new QAction("Unload", &menu);
     QAction *reload = new QAction("Reload", &menu);
     QAction *delete_file = new QAction("Delete from disk", &menu);
+    QAction *reset_stats = new QAction("Reset statistics", &menu);
+    QAction *enable_hooks = new QAction("Enable disabled hooks", &menu);
     menu.addAction(unload);
     menu.addAction(reload);
     menu.addSeparator();
+    menu.addAction(reset_stats);
+    menu.addAction(enable_hooks);
+    menu.addSeparator();
     menu.addAction(delete_file);
     menu.addSeparator();
     menu.addAction(edit);
@@ -138,6 +189,19 @@ void ScriptingManager::on_tableWidget_customContextMenuRequested(const QPoint &p
     } else if (selection == reload)
     {
         this->reloadSelectSc();
+    } else if (selection == reset_stats || selection == enable_hooks)
+    {
+        foreach (int i, this->selectedRows())
+        {
+            Script *script = Script::GetScriptByName(this->ui->tableWidget->item(i, 0)->text());
+            if (!script)
+                continue;
+            if (selection == reset_stats)
+                script->ResetStatistics();
+            else
+                script->EnableDisabledHooks();
+        }
+        this->reloadStatistics();
     } else if (selection == edit)
     {
         QList<int> selected_sc = this->selectedRows();
@@ -167,6 +231,11 @@ void ScriptingManager::on_pushScript_clicked()
     this->Reload();
 }
 
+void ScriptingManager::on_bRefreshStats_clicked()
+{
+    this->reloadStatistics();
+}
+
 void ScriptingManager::unloadSelectSc()
 {
     QList<int> selected = selectedRows();
@@ -37,8 +37,11 @@ namespace Huggle
             void on_bReload_clicked();
             void on_tableWidget_customContextMenuRequested(const QPoint &pos);
             void on_pushScript_clicked();
+            void on_bRefreshStats_clicked();
 
         private:
+            //! Fill the table with call counts and times of functions of all scripts
+            void reloadStatistics();
             void unloadSelectSc();
             void deleteSelectSc();
             void reloadSelectSc();
@@ -175,8 +175,8 @@ void UiScript::Hook_OnSpeedyFinished(WikiEdit *edit, QString tags, bool success)
         return;
 
     QJSValueList parameters;
-    int pool_id = this->memPool->RegisterEdit(edit);
-    parameters.append(JSMarshallingHelper::FromEdit(edit, this->engine, pool_id));
+    this->memPool->RegisterEdit(edit);
+    parameters.append(this->memPool->MarshallEdit(edit, this->engine));
     parameters.append(QJSValue(tags));
     parameters.append(QJSValue(success));
     this->executeFunction(this->attachedHooks[HUGGLE_SCRIPT_HOOK_SPEEDY_FINISHED], parameters);
@@ -15,6 +15,7 @@
 #include "uihooks.hpp"
 #include <QtXml>
 #include <huggle_core/configuration.hpp>
+#include <huggle_core/editregistry.hpp>
 #include <huggle_core/exception.hpp>
 #include <huggle_core/hooks.hpp>
 #include <huggle_core/localization.hpp>
@@ -234,21 +235,12 @@ void UserinfoForm::JumpToSpecificContrib(long revid, QString page)
         return;
 
     // check if we don't have this edit in a buffer
-    int x = 0;
-    WikiEdit::Lock_EditList->lock();
-    while (x < WikiEdit::EditList.count())
+    Collectable_SmartPtr<WikiEdit> cached = EditRegistry::FindByRevID(revid, this->User->GetSite(), "", true);
+    if (cached != nullptr)
     {
-        WikiEdit *edit = WikiEdit::EditList.at(x++);
-        if (!edit->IsPostProcessed())
-            continue;
-        if (edit->RevID == revid)
-        {
-            MainWindow::HuggleMain->ProcessEdit(edit, true, false, true);
-            WikiEdit::Lock_EditList->unlock();
-            return;
-        }
+        MainWindow::HuggleMain->ProcessEdit(cached, true, false, true);
+        return;
     }
-    WikiEdit::Lock_EditList->unlock();
     // there is no such edit, let's get it
     this->edit = new WikiEdit();
     this->edit->User = new WikiUser(this->User);
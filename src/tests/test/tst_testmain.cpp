@@ -10,19 +10,75 @@
 
 #include <QString>
 #include <iostream>
+#include <QNetworkAccessManager>
 #include <QtTest>
 #include <huggle_core/huggleparser.hpp>
+#include <huggle_core/apiquery.hpp>
+#include <huggle_core/apiqueryresult.hpp>
+#include <huggle_core/collectable.hpp>
 #include <huggle_core/configuration.hpp>
+#include <huggle_core/diffextractor.hpp>
+#include <huggle_core/editlatency.hpp>
+#include <huggle_core/editregistry.hpp>
 #include <huggle_core/generic.hpp>
+#include <huggle_core/hugglefeed.hpp>
+#include <huggle_core/hugglefeedproviderirc.hpp>
+#include <huggle_core/hugglefeedproviderxml.hpp>
+#include <huggle_core/querypool.hpp>
+#include <huggle_core/queryscheduler.hpp>
+#include <huggle_core/responsecache.hpp>
 #include <huggle_core/wikiedit.hpp>
 #include <huggle_core/wikipage.hpp>
 #include <huggle_core/wikisite.hpp>
 #include <huggle_core/sleeper.hpp>
+#include <huggle_core/summaryclassifier.hpp>
+#include <huggle_core/syslog.hpp>
 #include <huggle_core/terminalparser.hpp>
+#include <huggle_core/userreputation.hpp>
 #include <huggle_core/wikiuser.hpp>
 #include <huggle_core/version.hpp>
 
 static void testTalkPageWarningParser(QString id, QDate date, int level);
+//! Collectable that tells us when it was deleted
+class TestCollectable : public Huggle::Collectable
+{
+    public:
+        TestCollectable(bool *deleted) { this->deleted = deleted; }
+        ~TestCollectable() { *this->deleted = true; }
+    private:
+        bool *deleted;
+};
+
+//! Query that counts how many times it was checked
+class TestQuery : public Huggle::Query
+{
+    public:
+        TestQuery(bool polled) { this->polled = polled; }
+        bool IsProcessed() override { this->Checks++; return Query::IsProcessed(); }
+        bool IsPolled() override { return this->polled; }
+        void Kill() override { this->SetStatus(StatusKilled); }
+        int Checks = 0;
+    private:
+        bool polled;
+};
+
+class TestFeed : public Huggle::HuggleFeed
+{
+    public:
+        TestFeed(Huggle::WikiSite *site) : Huggle::HuggleFeed(site) {}
+        void Pause() override { this->paused = true; }
+        void Resume() override { this->paused = false; }
+        bool IsPaused() override { return this->paused; }
+        //! Same as what happens when buffer is full and overflow policy is to pause the feed
+        void PauseByBuffer() { this->pausedByBuffer = true; this->Pause(); }
+        int GetID() override { return 0; }
+        QString ToString() override { return "Test"; }
+        unsigned long long GetBytesReceived() override { return 0; }
+        unsigned long long GetBytesSent() override { return 0; }
+    private:
+        bool paused = false;
+};
+
 //! This is a unit test
 class HuggleTest : public QObject
 {
@@ -48,15 +104,36 @@ class HuggleTest : public QObject
         void testCaseTalkPageParser0013() { testTalkPageWarningParser("0013", QDate(2014, 5, 13), 2); }
         void testCaseTalkPageParser0014() { testTalkPageWarningParser("0014", QDate(2014, 5, 13), 4); }
         void testCaseTalkPageParser0015() { testTalkPageWarningParser("0015", QDate(2014, 5, 16), 1); }
+        //! Level of talk page that was changed must not be taken from the cache
+        void testCaseTalkPageParserChanged();
+        void benchmarkTalkPageParser();
         //! Test if IsIP returns true for users who are IP's
         void testCaseWikiUserCheckIP();
         void testCaseTerminalParser();
         void testCaseConfigurationParse_YAML();
         void testCaseConfigurationParse_QL();
         void testCaseScores();
+        void benchmarkScoreWords();
+        void testCaseDiffExtractor();
+        void testCaseSummaryClassifier();
         void testCaseVersionComparison();
         void testCaseGenerics();
         void testCaseWikiPage();
+        void testCaseIRCParser();
+        void benchmarkIRCParser();
+        void testCaseXmlRcsParser();
+        void benchmarkXmlRcsParser();
+        void testCaseFeedBuffer();
+        //! Feed paused by user must not be resumed once there is space in its buffer
+        void testCaseFeedPause();
+        void testCaseLatencyHistogram();
+        void testCaseGC();
+        void testCaseEditRegistry();
+        void testCaseProblematicUsers();
+        void testCaseUserReputation();
+        void testCaseApiQueryResult();
+        void testCaseQueryPool();
+        void testCaseResponseCache();
 };
 
 HuggleTest::HuggleTest()
@@ -124,6 +201,57 @@ static void testTalkPageWarningParser(QString id, QDate date, int level)
 
 }
 
+void HuggleTest::testCaseTalkPageParserChanged()
+{
+    Huggle::WikiUser *user = new Huggle::WikiUser(Huggle::Configuration::HuggleConfiguration->Project);
+    user->Username = "Changed talk page";
+    QStringList pages;
+    foreach (QString id, QStringList() << "0005" << "0006")
+    {
+        QFile file(":/test/wikipage/tp" + id + ".txt");
+        file.open(QIODevice::ReadOnly);
+        pages << QString(file.readAll());
+        file.close();
+    }
+    user->TalkPage_SetContents(pages.at(0), 5);
+    user->ParseTP(QDate(2014, 5, 7));
+    QVERIFY2(user->GetWarningLevel() == 4, "Invalid level of first talk page");
+    user->TalkPage_SetContents(pages.at(1), 6);
+    user->ParseTP(QDate(2014, 5, 7));
+    QVERIFY2(user->GetWarningLevel() == 1, "Level of previous talk page was used");
+    user->TalkPage_SetContents(pages.at(0), 7);
+    user->ParseTP(QDate(2014, 5, 7));
+    QVERIFY2(user->GetWarningLevel() == 4, "Invalid level of talk page that was restored");
+    // level cached for this revision must not be used once parser settings are different
+    int template_age = hcfg->ProjectConfig->TemplateAge;
+    hcfg->ProjectConfig->TemplateAge = -1;
+    byte_ht expected = Huggle::HuggleParser::GetLevel(pages.at(0), QDate(2014, 5, 7), hcfg->Project);
+    user->ParseTP(QDate(2014, 5, 7));
+    hcfg->ProjectConfig->TemplateAge = template_age;
+    QVERIFY2(user->GetWarningLevel() == expected, "Level parsed with different template age was used");
+    delete user;
+}
+
+void HuggleTest::benchmarkTalkPageParser()
+{
+    // large archived talk page, made of all sample talk pages repeated many times
+    QString page;
+    for (int i = 1; i <= 15; i++)
+    {
+        QFile file(":/test/wikipage/tp" + QString::number(i).rightJustified(4, '0') + ".txt");
+        file.open(QIODevice::ReadOnly);
+        page += QString(file.readAll()) + "\n\n";
+        file.close();
+    }
+    QString archive;
+    for (int i = 0; i < 20; i++)
+        archive += page;
+    QBENCHMARK
+    {
+        Huggle::HuggleParser::GetLevel(archive, QDate(2014, 5, 10), hcfg->Project);
+    }
+}
+
 void HuggleTest::testCaseScores()
 {
     Huggle::Configuration::HuggleConfiguration->ProjectConfig->ScoreWords.clear();
@@ -134,6 +262,7 @@ void HuggleTest::testCaseScores()
     Huggle::Configuration::HuggleConfiguration->ProjectConfig->ScoreWords.append(new Huggle::ScoreWord("suck", 60));
     Huggle::Configuration::HuggleConfiguration->ProjectConfig->ScoreWords.append(new Huggle::ScoreWord("ass", 60));
     Huggle::Configuration::HuggleConfiguration->SystemConfig_WordSeparators << " " << "." << "," << "(" << ")" << ":" << ";" << "!" << "?" << "/";
+    Huggle::Configuration::HuggleConfiguration->ProjectConfig->CompileScoreWords();
     Huggle::GC::gc = new Huggle::GC();
     Huggle::WikiEdit *edit = new Huggle::WikiEdit();
     edit->Page = new Huggle::WikiPage("test", hcfg->Project);
@@ -214,6 +343,68 @@ void HuggleTest::testCaseScores()
 }
 
 
+void HuggleTest::benchmarkScoreWords()
+{
+    // score words of english wikipedia, matched against all sample pages
+    QFile f(":/test/wikipage/config.txt");
+    f.open(QIODevice::ReadOnly);
+    Huggle::WikiSite *site = new Huggle::WikiSite("benchmark", "benchmark.wikipedia");
+    site->ProjectConfig = new Huggle::ProjectConfiguration("benchmark");
+    site->ProjectConfig->Parse(f.readAll(), nullptr, site);
+    f.close();
+    QStringList pages;
+    for (int i = 1; i <= 4; i++)
+    {
+        QFile page(":/test/wikipage/page0" + QString::number(i) + ".txt");
+        page.open(QIODevice::ReadOnly);
+        pages << QString(page.readAll()).toLower();
+        page.close();
+    }
+    QVERIFY2(site->ProjectConfig->ScoreWords.count() > 0, "No score words were parsed");
+    Huggle::ScoreWordMatcher *matcher = &site->ProjectConfig->ScoreMatcher;
+    QBENCHMARK
+    {
+        foreach (QString text, pages)
+        {
+            QStringList found;
+            QVector<unsigned char> hits = matcher->Match(text);
+            matcher->Evaluate(site->ProjectConfig->ScoreWordsList, hits, &found);
+            matcher->Evaluate(site->ProjectConfig->ScorePartsList, hits, &found);
+        }
+    }
+    delete site;
+}
+
+void HuggleTest::testCaseDiffExtractor()
+{
+    QString diff = "<tr><td colspan=\"2\" class=\"diff-lineno\">Line 1:</td><td colspan=\"2\" class=\"diff-lineno\">Line 1:</td></tr>"
+                   "<tr><td class=\"diff-marker\">-</td><td class=\"diff-deletedline\"><div>Removed <del class=\"diffchange diffchange-inline\">Vagina</del> text</div></td>"
+                   "<td class=\"diff-marker\">+</td><td class=\"diff-addedline\"><div>Removed <ins class=\"diffchange diffchange-inline\">Changed &amp; Fuck</ins> text</div></td></tr>"
+                   "<tr><td class=\"diff-marker\">&#160;</td><td class=\"diff-context\"><div>Context suck</div></td></tr>"
+                   "<tr><td colspan=\"2\" class=\"diff-empty\">&#160;</td><td class=\"diff-marker\">+</td><td class=\"diff-addedline\"><div>New &lt;b&gt;line&#33;</div></td></tr>";
+    bool is_diff = false;
+    QString added = Huggle::DiffExtractor::ExtractAddedText(diff, &is_diff);
+    QVERIFY2(is_diff, "Diff table wasn't recognized");
+    QCOMPARE(added, QString("changed & fuck  new <b>line!"));
+    added = Huggle::DiffExtractor::ExtractAddedText("Plain Text", &is_diff);
+    QVERIFY2(!is_diff, "Plain text was recognized as diff");
+    QCOMPARE(added, QString("plain text"));
+}
+
+void HuggleTest::testCaseSummaryClassifier()
+{
+    Huggle::SummaryClassifier classifier;
+    classifier.Compile(QStringList() << "^Reverted" << "^Undid revision" << "([" << "rv\\b",
+                       QStringList() << "using [[WP:TW|TW]]" << "[[WP:STiki|STiki]]", "([[WP:HG|HG]] (3.0))");
+    QCOMPARE(classifier.Classify("Reverted edits by Foo"), HUGGLE_SUMMARY_REVERT);
+    QCOMPARE(classifier.Classify("Undid revision 123 using [[WP:TW|TW]]"), HUGGLE_SUMMARY_REVERT | HUGGLE_SUMMARY_ASSISTED);
+    QCOMPARE(classifier.Classify("Reverted edits by Foo to last revision ([[WP:HG|HG]] (3.0))"), HUGGLE_SUMMARY_REVERT | HUGGLE_SUMMARY_HUGGLE);
+    QCOMPARE(classifier.Classify("rv vandalism"), HUGGLE_SUMMARY_REVERT);
+    QCOMPARE(classifier.Classify("added rvalue references"), 0);
+    QCOMPARE(classifier.Classify("Not Reverted"), 0);
+    QCOMPARE(classifier.Classify(""), 0);
+}
+
 void HuggleTest::testCaseWikiUserCheckIP()
 {
     QVERIFY2(Huggle::WikiUser("10.0.0.1", hcfg->Project).IsIP(), "Invalid result for new WikiUser with username of 10.0.0.1, the result of IsIP() was false, but should have been true");
@@ -313,6 +504,617 @@ void HuggleTest::testCaseWikiPage()
     delete page1_talk;
 }
 
+static QStringList loadCorpus(QString name)
+{
+    QFile f(":/test/wikipage/" + name);
+    f.open(QIODevice::ReadOnly);
+    QStringList lines = QString::fromUtf8(f.readAll()).split("\n", QString::SkipEmptyParts);
+    f.close();
+    return lines;
+}
+
+void HuggleTest::testCaseIRCParser()
+{
+    QStringList lines = loadCorpus("irc_rc.txt");
+    QVERIFY2(lines.count() == 17, "Invalid number of lines in irc corpus");
+    Huggle::IRCRecentChange rc;
+    QVERIFY2(rc.Parse(lines.at(0)), "Failed to parse line 1");
+    QVERIFY2(rc.Title == "Albert Einstein", "Invalid title");
+    QVERIFY2(rc.Diff == 912345678 && rc.OldID == 912345001, "Invalid revision ids");
+    QVERIFY2(rc.User == "192.0.2.15", "Invalid user");
+    QVERIFY2(rc.HasSize && rc.Size == 12, "Invalid size");
+    QVERIFY2(rc.Summary == "fix typo", "Invalid summary");
+    QVERIFY2(!rc.IsLog() && !rc.Bot && !rc.Minor && !rc.NewPage, "Invalid flags");
+    rc = Huggle::IRCRecentChange();
+    QVERIFY2(rc.Parse(lines.at(1)), "Failed to parse line 2");
+    QVERIFY2(rc.Minor && !rc.Bot && rc.Size == -1204, "Invalid flags or size for line 2");
+    rc = Huggle::IRCRecentChange();
+    QVERIFY2(rc.Parse(lines.at(2)), "Failed to parse line 3");
+    QVERIFY2(rc.Bot && rc.HasSize && rc.Size == 5002, "Invalid bold size for line 3");
+    rc = Huggle::IRCRecentChange();
+    QVERIFY2(rc.Parse(lines.at(3)), "Failed to parse line 4");
+    QVERIFY2(rc.NewPage && rc.Title == "Draft:Sample article" && rc.User == "Newbie 2018", "Invalid new page");
+    rc = Huggle::IRCRecentChange();
+    QVERIFY2(rc.Parse(lines.at(6)), "Failed to parse line 7");
+    QVERIFY2(rc.Bot && rc.Minor && !rc.HasSize, "Invalid flags or size for line 7");
+    rc = Huggle::IRCRecentChange();
+    QVERIFY2(rc.Parse(lines.at(7)), "Failed to parse line 8");
+    QVERIFY2(rc.User == QString::fromUtf8("\xC3\x84rger") && rc.Size == -32 && rc.Summary.isEmpty(), "Invalid line 8");
+    rc = Huggle::IRCRecentChange();
+    QVERIFY2(rc.Parse(lines.at(8)), "Failed to parse line 9");
+    QVERIFY2(rc.Log == Huggle::IRCRecentChange::LogType_Block && rc.User == "Admin", "Invalid block log entry");
+    rc = Huggle::IRCRecentChange();
+    QVERIFY2(rc.Parse(lines.at(9)), "Failed to parse line 10");
+    QVERIFY2(rc.Log == Huggle::IRCRecentChange::LogType_Move, "Invalid move log entry");
+    rc = Huggle::IRCRecentChange();
+    QVERIFY2(rc.Parse(lines.at(15)), "Failed to parse line 16");
+    QVERIFY2(rc.Log == Huggle::IRCRecentChange::LogType_Unknown, "Invalid unknown log entry");
+    int edits = 0;
+    foreach (QString line, lines)
+    {
+        Huggle::IRCRecentChange change;
+        QVERIFY2(change.Parse(line), QString("Failed to parse: " + line).toUtf8().data());
+        if (!change.IsLog())
+            edits++;
+    }
+    QVERIFY2(edits == 9, QString("Invalid number of edits in corpus: " + QString::number(edits)).toUtf8().data());
+    rc = Huggle::IRCRecentChange();
+    QVERIFY2(!rc.Parse("PRIVMSG #en.wikipedia :hello"), "Garbage was parsed as recent change");
+}
+
+void HuggleTest::benchmarkIRCParser()
+{
+    QStringList lines = loadCorpus("irc_rc.txt");
+    QBENCHMARK
+    {
+        foreach (QString line, lines)
+        {
+            Huggle::IRCRecentChange rc;
+            rc.Parse(line);
+        }
+    }
+}
+
+static QByteArray loadStream(QString name)
+{
+    QFile f(":/test/wikipage/" + name);
+    f.open(QIODevice::ReadOnly);
+    QByteArray data = f.readAll();
+    f.close();
+    return data;
+}
+
+//! Replay recorded XmlRcs stream in blocks of given size, same as if it was coming from socket
+static int replayXmlRcs(Huggle::XmlRcsParser *parser, const QByteArray &stream, int block_size, int *lines)
+{
+    int edits = 0;
+    *lines = 0;
+    QByteArray line;
+    for (int i = 0; i < stream.size(); i += block_size)
+    {
+        parser->Append(stream.mid(i, block_size));
+        while (parser->NextLine(&line))
+        {
+            (*lines)++;
+            if (!parser->Parse(line) || parser->Name != "edit")
+                continue;
+            QStringRef type = parser->Attributes.value("type");
+            if (type != "edit" && type != "new")
+                continue;
+            QString title = parser->Attributes.value("title").toString();
+            QString user = parser->Attributes.value("user").toString();
+            QString summary = parser->Attributes.value("summary").toString();
+            if (!title.isEmpty() && !user.isEmpty() && parser->Attributes.value("revid").toLongLong() > 0)
+                edits++;
+        }
+    }
+    return edits;
+}
+
+void HuggleTest::testCaseXmlRcsParser()
+{
+    QByteArray stream = loadStream("xmlrcs.txt");
+    Huggle::XmlRcsParser parser;
+    int lines = 0;
+    int edits = replayXmlRcs(&parser, stream, 97, &lines);
+    QVERIFY2(lines == 201, QString("Invalid number of lines framed: " + QString::number(lines)).toUtf8().data());
+    QVERIFY2(edits == 162, QString("Invalid number of edits parsed: " + QString::number(edits)).toUtf8().data());
+    // partial lines must stay in buffer until they are finished
+    parser.Append("<edit type=\"edit\" title=\"A &amp; B\"");
+    QByteArray line;
+    QVERIFY2(!parser.NextLine(&line), "Unfinished line was returned by parser");
+    parser.Append(" user=\"\xC3\x84rger\" revid=\"10\"></edit>\n<ping />\n");
+    QVERIFY2(parser.NextLine(&line), "Finished line wasn't returned by parser");
+    QVERIFY2(parser.Parse(line) && parser.Name == "edit", "Failed to parse an edit");
+    QVERIFY2(parser.Attributes.value("title") == "A & B", "Entities were not decoded in title");
+    QVERIFY2(parser.Attributes.value("user") == QString::fromUtf8("\xC3\x84rger"), "Invalid user name");
+    QVERIFY2(parser.NextLine(&line) && parser.Parse(line) && parser.Name == "ping", "Failed to parse a ping");
+    QVERIFY2(!parser.NextLine(&line), "Parser returned a line that doesn't exist");
+    parser.Append("<error>You are not subscribed</error>\n");
+    QVERIFY2(parser.NextLine(&line) && parser.Parse(line) && parser.Text == "You are not subscribed", "Invalid error message");
+    // log events don't have revid, they are dropped without being reported as invalid xml
+    int warnings = Huggle::Syslog::HuggleLogs->RingLogToQStringList().filter("Invalid Xml").count();
+    parser.Append("<edit wiki=\"enwiki\" server_name=\"en.wikipedia.org\" title=\"User:Test\" user=\"Test\" type=\"log\"></edit>\n");
+    QVERIFY2(parser.NextLine(&line) && parser.Parse(line) && parser.Name == "edit", "Failed to parse a log event");
+    QVERIFY2(parser.CreateEdit(hcfg->Project, line) == nullptr, "Log event was turned into an edit");
+    QVERIFY2(Huggle::Syslog::HuggleLogs->RingLogToQStringList().filter("Invalid Xml").count() == warnings, "Log event was reported as invalid");
+}
+
+void HuggleTest::benchmarkXmlRcsParser()
+{
+    QByteArray stream = loadStream("xmlrcs.txt");
+    int lines = 0;
+    QBENCHMARK
+    {
+        Huggle::XmlRcsParser parser;
+        replayXmlRcs(&parser, stream, 1460, &lines);
+    }
+}
+
+static void pushToFeedBuffer(Huggle::HuggleFeedBuffer *buffer, QList<Huggle::WikiEdit*> edits, QList<int> indexes,
+                             Huggle::HuggleFeedOverflowPolicy policy, QList<bool> *results, QList<score_ht> scores = QList<score_ht>())
+{
+    // every edit in buffer holds one reference, which is released by whoever takes it out
+    for (int i = 0; i < indexes.count(); i++)
+    {
+        Huggle::WikiEdit *edit = edits.at(indexes.at(i));
+        edit->IncRef();
+        bool inserted = buffer->Push(edit, policy, scores.isEmpty() ? 0 : scores.at(i));
+        if (!inserted)
+            edit->DecRef();
+        results->append(inserted);
+    }
+}
+
+static void popFromFeedBuffer(Huggle::HuggleFeedBuffer *buffer, QList<Huggle::WikiEdit*> edits, QList<int> *indexes)
+{
+    Huggle::WikiEdit *edit;
+    while ((edit = buffer->Pop()) != nullptr)
+    {
+        indexes->append(edits.indexOf(edit));
+        edit->DecRef();
+    }
+}
+
+void HuggleTest::testCaseFeedBuffer()
+{
+    QList<Huggle::WikiEdit*> edits;
+    for (int i = 0; i < 6; i++)
+        edits.append(new Huggle::WikiEdit());
+    QList<bool> results;
+    QList<int> order;
+    Huggle::HuggleFeedBuffer buffer(3);
+    QVERIFY2(buffer.IsEmpty() && buffer.Pop() == nullptr, "New buffer isn't empty");
+    // oldest edits are removed to make space for new ones
+    pushToFeedBuffer(&buffer, edits, QList<int>() << 0 << 1 << 2 << 3 << 4, Huggle::HuggleFeedOverflowPolicy_DropOldest, &results);
+    QVERIFY2(!results.contains(false), "Edit wasn't inserted");
+    QVERIFY2(buffer.Dropped == 2, QString("Invalid number of dropped edits: " + QString::number(buffer.Dropped)).toUtf8().data());
+    QVERIFY2(buffer.Count() == 3, "Invalid number of edits in buffer");
+    QVERIFY2(!edits[0]->HasSomeConsumers() && edits[2]->HasSomeConsumers(), "Dropped edits were not released");
+    popFromFeedBuffer(&buffer, edits, &order);
+    QVERIFY2(order == (QList<int>() << 2 << 3 << 4), "Edits were not returned in order");
+    QVERIFY2(buffer.IsEmpty(), "Buffer isn't empty");
+    // edit with lowest score is replaced, unless the new one is even less interesting
+    results.clear();
+    order.clear();
+    buffer.Dropped = 0;
+    pushToFeedBuffer(&buffer, edits, QList<int>() << 1 << 2 << 3 << 4 << 5, Huggle::HuggleFeedOverflowPolicy_DropLowestScore,
+                     &results, QList<score_ht>() << 50 << 10 << 30 << 5 << 40);
+    QVERIFY2(results == (QList<bool>() << true << true << true << false << true), "Edit with lowest score was inserted");
+    QVERIFY2(buffer.Dropped == 2, "Invalid number of dropped edits");
+    popFromFeedBuffer(&buffer, edits, &order);
+    QVERIFY2(order == (QList<int>() << 1 << 5 << 3), "Wrong edit was dropped");
+    // paused feed just refuses new edits
+    results.clear();
+    order.clear();
+    pushToFeedBuffer(&buffer, edits, QList<int>() << 1 << 3 << 5 << 4, Huggle::HuggleFeedOverflowPolicy_PauseFeed, &results);
+    QVERIFY2(results == (QList<bool>() << true << true << true << false), "Edit was inserted to full buffer");
+    popFromFeedBuffer(&buffer, edits, &order);
+    QVERIFY2(order == (QList<int>() << 1 << 3 << 5), "Edit was removed from paused buffer");
+    foreach (Huggle::WikiEdit *edit, edits)
+    {
+        QVERIFY2(!edit->HasSomeConsumers(), "Edit wasn't released");
+        edit->SafeDelete();
+    }
+}
+
+void HuggleTest::testCaseFeedPause()
+{
+    TestFeed feed(hcfg->Project);
+    feed.PauseByBuffer();
+    feed.PauseByUser();
+    feed.RetrieveEdit();
+    QVERIFY2(feed.IsPaused(), "Feed paused by user was resumed when buffer was emptied");
+    feed.ResumeByUser();
+    QVERIFY2(!feed.IsPaused(), "Feed wasn't resumed by user");
+    feed.PauseByBuffer();
+    feed.PauseByUser();
+    feed.ResumeByUser();
+    QVERIFY2(feed.IsPaused(), "Feed with full buffer was resumed by user");
+    feed.RetrieveEdit();
+    QVERIFY2(!feed.IsPaused(), "Feed wasn't resumed when buffer was emptied");
+}
+
+void HuggleTest::testCaseLatencyHistogram()
+{
+    Huggle::LatencyHistogram histogram;
+    QVERIFY2(histogram.GetCount() == 0 && histogram.GetPercentile(50) == 0, "New histogram isn't empty");
+    // 1 ms to 100 ms
+    for (int i = 1; i <= 100; i++)
+        histogram.Add(static_cast<qint64>(i) * 1000000);
+    QVERIFY2(histogram.GetCount() == 100, "Invalid number of values");
+    QVERIFY2(qAbs(histogram.GetAverage() - 50.5) < 0.001, "Invalid average");
+    QVERIFY2(histogram.GetMax() == 100, "Invalid maximum");
+    // buckets are 1/8 of power of two wide, so percentiles are within 7%
+    QVERIFY2(qAbs(histogram.GetPercentile(50) - 50) < 3.5, QString("Invalid p50: " + QString::number(histogram.GetPercentile(50))).toUtf8().data());
+    QVERIFY2(qAbs(histogram.GetPercentile(95) - 95) < 6.7, QString("Invalid p95: " + QString::number(histogram.GetPercentile(95))).toUtf8().data());
+    QVERIFY2(histogram.GetPercentile(99) <= 100, "p99 is bigger than maximum");
+    QVERIFY2(histogram.GetPercentile(50) <= histogram.GetPercentile(95), "Percentiles are not monotonic");
+    histogram.Clear();
+    QVERIFY2(histogram.GetCount() == 0 && histogram.GetMax() == 0, "Histogram wasn't cleared");
+    // intervals are only recorded when edit passed through both stages
+    Huggle::EditLatency::Reset();
+    Huggle::EditLatencyTrace trace;
+    trace.Mark(Huggle::EditLatencyStage_FeedReceived);
+    trace.Mark(Huggle::EditLatencyStage_PreProcessed);
+    Huggle::EditLatency::Record(trace);
+    QVERIFY2(Huggle::EditLatency::GetHistogram(0).GetCount() == 1, "Pre processing wasn't recorded");
+    QVERIFY2(Huggle::EditLatency::GetHistogram(Huggle::EditLatency::GetIntervalCount() - 1).GetCount() == 0, "Total was recorded for edit that isn't in queue");
+}
+
+void HuggleTest::testCaseGC()
+{
+    Huggle::GC::gc = new Huggle::GC();
+    // collector thread would delete the objects any time, but we need to know when it happens
+    Huggle::GC::gc->Stop();
+    while (Huggle::GC::gc->IsRunning())
+        Huggle::Sleeper::usleep(2);
+    bool deleted = false;
+    TestCollectable *object = new TestCollectable(&deleted);
+    object->RegisterConsumer(HUGGLECONSUMER_CORE);
+    object->IncRef();
+    QVERIFY2(Huggle::GC::gc->Count() == 1, "Managed object isn't in GC");
+    object->UnregisterConsumer(HUGGLECONSUMER_CORE);
+    Huggle::GC::gc->DeleteOld();
+    QVERIFY2(!deleted, "Object with reference was deleted");
+    object->DecRef();
+    QVERIFY2(!deleted, "Object was deleted before GC run");
+    Huggle::GC::gc->DeleteOld();
+    QVERIFY2(deleted, "Unused object wasn't deleted");
+    QVERIFY2(Huggle::GC::gc->Count() == 0, "Deleted object is still in GC");
+    // object that got a new consumer while it was waiting in queue must survive
+    deleted = false;
+    object = new TestCollectable(&deleted);
+    object->SetReclaimable();
+    object->RegisterConsumer(HUGGLECONSUMER_CORE);
+    object->UnregisterConsumer(HUGGLECONSUMER_CORE);
+    object->RegisterConsumer(HUGGLECONSUMER_QUEUE);
+    Huggle::GC::gc->DeleteOld();
+    QVERIFY2(!deleted, "Reclaimed object was deleted");
+    object->UnregisterConsumer(HUGGLECONSUMER_QUEUE);
+    Huggle::GC::gc->DeleteOld();
+    QVERIFY2(deleted, "Reclaimed object wasn't deleted");
+    // queued object is deleted by GC only, not by SafeDelete
+    deleted = false;
+    object = new TestCollectable(&deleted);
+    object->IncRef();
+    object->DecRef();
+    QVERIFY2(!object->SafeDelete() && !deleted, "Queued object was deleted by SafeDelete");
+    Huggle::GC::gc->DeleteOld();
+    QVERIFY2(deleted, "Queued object wasn't deleted");
+    // consumers without a bit in the mask are kept in side table
+    deleted = false;
+    object = new TestCollectable(&deleted);
+    object->RegisterConsumer("test consumer");
+    object->RegisterConsumer(12345);
+    object->RegisterConsumer(HUGGLECONSUMER_CORE);
+    QVERIFY2(object->DebugHgc().contains("test consumer"), "String consumer is missing in debug info");
+    object->UnregisterConsumer(HUGGLECONSUMER_CORE);
+    object->UnregisterConsumer("test consumer");
+    Huggle::GC::gc->DeleteOld();
+    QVERIFY2(!deleted && object->HasSomeConsumers(), "Object with unknown consumer was deleted");
+    object->UnregisterConsumer(12345);
+    QVERIFY2(!object->HasSomeConsumers(), "Side table consumers weren't removed");
+    Huggle::GC::gc->DeleteOld();
+    QVERIFY2(deleted, "Object without consumers wasn't deleted");
+    delete Huggle::GC::gc;
+    Huggle::GC::gc = NULL;
+}
+
+void HuggleTest::testCaseEditRegistry()
+{
+    int count = Huggle::EditRegistry::Count();
+    QList<Huggle::WikiEdit*> edits;
+    // edit 100 and 102 were made by vandal, 101 is a revert of the first one
+    for (int i = 0; i < 3; i++)
+    {
+        Huggle::WikiEdit *edit = new Huggle::WikiEdit();
+        edit->Page = new Huggle::WikiPage("Test page", hcfg->Project);
+        edit->User = new Huggle::WikiUser(i == 1 ? "Patroller" : "Vandal", hcfg->Project);
+        edit->RevID = 100 + i;
+        edit->Time = QDateTime(QDate(2014, 1, 1), QTime(0, i));
+        edit->IsRevert = i == 1;
+        edit->Status = Huggle::StatusPostProcessed;
+        edits.append(edit);
+    }
+    QVERIFY2(Huggle::EditRegistry::Count() == count + 3, "Edits weren't registered");
+    QVERIFY2(Huggle::EditRegistry::FindByRevID(101).GetPtr() == nullptr, "Edit that wasn't indexed was found");
+    foreach (Huggle::WikiEdit *edit, edits)
+        Huggle::EditRegistry::Update(edit);
+    QVERIFY2(Huggle::EditRegistry::FindByRevID(101).GetPtr() == edits.at(1), "Edit wasn't found by revid");
+    QVERIFY2(Huggle::EditRegistry::FindByRevID(101, hcfg->Project, "prev", true).GetPtr() == edits.at(1), "Edit wasn't found by site");
+    QVERIFY2(Huggle::EditRegistry::FindByRevID(101, hcfg->Project, "cur").GetPtr() == nullptr, "Edit with other diff was found");
+    QVERIFY2(Huggle::EditRegistry::IsReverted(edits.at(0)), "Reverted edit wasn't recognized");
+    QVERIFY2(!Huggle::EditRegistry::IsReverted(edits.at(1)), "Revert is reverted by itself");
+    QVERIFY2(!Huggle::EditRegistry::IsReverted(edits.at(2)), "Newer edit than revert is reverted");
+    bool made_by_same_user = true;
+    QVERIFY2(Huggle::EditRegistry::HasNewerEdits(edits.at(0), &made_by_same_user), "Newer edits weren't found");
+    QVERIFY2(!made_by_same_user, "Newer edits were made by other user too");
+    made_by_same_user = true;
+    QVERIFY2(!Huggle::EditRegistry::HasNewerEdits(edits.at(2), &made_by_same_user), "Newest edit has newer edits");
+    foreach (Huggle::WikiEdit *edit, edits)
+        edit->SafeDelete();
+    QVERIFY2(Huggle::EditRegistry::Count() == count, "Edits weren't removed");
+    QVERIFY2(Huggle::EditRegistry::FindByRevID(101).GetPtr() == nullptr, "Deleted edit was found");
+}
+
+void HuggleTest::testCaseProblematicUsers()
+{
+    int count = Huggle::WikiUser::GetProblematicUserCount();
+    Huggle::WikiUser *user = new Huggle::WikiUser("Problematic_user", hcfg->Project);
+    user->SetBadnessScore(200, false, false);
+    Huggle::WikiUser::UpdateUser(user);
+    QVERIFY2(Huggle::WikiUser::GetProblematicUserCount() == count + 1, "User wasn't inserted");
+    Huggle::WikiUser *stored = Huggle::WikiUser::RetrieveUser("Problematic user", hcfg->Project);
+    QVERIFY2(stored != nullptr, "User wasn't found by name with spaces");
+    QVERIFY2(stored->GetBadnessScore(false) == 200, "User has wrong score");
+    QVERIFY2(Huggle::WikiUser::RetrieveUser("Problematic_user", nullptr) == nullptr, "User was found on other site");
+    Huggle::WikiUser::UpdateUser(user);
+    QVERIFY2(Huggle::WikiUser::GetProblematicUserCount() == count + 1, "User was inserted twice");
+    Huggle::WikiUser::TrimProblematicUsersList();
+    QVERIFY2(Huggle::WikiUser::RetrieveUser(user) == stored, "User with score was trimmed");
+    user->SetBadnessScore(0, false, true);
+    QVERIFY2(stored->GetBadnessScore(false) == 0, "Score wasn't updated");
+    Huggle::WikiUser::TrimProblematicUsersList();
+    QVERIFY2(Huggle::WikiUser::RetrieveUser(user) == nullptr, "User without score wasn't trimmed");
+    QVERIFY2(Huggle::WikiUser::GetProblematicUserCount() == count, "Wrong count after trim");
+    // user in list might be changed directly, without UpdateUser
+    user->SetBadnessScore(200, false, false);
+    Huggle::WikiUser::UpdateUser(user);
+    stored = Huggle::WikiUser::RetrieveUser(user);
+    QVERIFY2(stored != nullptr, "User wasn't inserted again");
+    stored->SetBadnessScore(0, false, false);
+    Huggle::WikiUser::TrimProblematicUsersList();
+    QVERIFY2(Huggle::WikiUser::RetrieveUser(user) == nullptr, "User changed directly wasn't trimmed");
+    delete user;
+}
+
+void HuggleTest::testCaseUserReputation()
+{
+    QTemporaryDir dir;
+    QString path = dir.path() + "/reputation.db";
+    qint64 now = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch() / 1000;
+    QVERIFY2(Huggle::UserReputation::Open(path), "Store wasn't open");
+    Huggle::UserReputationRecord record;
+    record.BadnessScore = 400;
+    record.WarningLevel = 3;
+    record.IsReported = true;
+    record.Expires = now + 3600;
+    Huggle::UserReputation::Store("testwiki", "Returning vandal", record);
+    Huggle::UserReputation::Store("testwiki", "Removed user", record);
+    Huggle::UserReputation::Remove("testwiki", "Removed user");
+    record.Expires = now - 3600;
+    Huggle::UserReputation::Store("testwiki", "Old vandal", record);
+    Huggle::UserReputation::Close();
+
+    QVERIFY2(Huggle::UserReputation::Open(path), "Store wasn't open again");
+    Huggle::UserReputationRecord stored;
+    QVERIFY2(Huggle::UserReputation::Lookup("testwiki", "Returning_vandal", &stored), "Record wasn't loaded");
+    QVERIFY2(stored.BadnessScore == 400 && stored.WarningLevel == 3 && stored.IsReported, "Record was loaded with wrong values");
+    QVERIFY2(!Huggle::UserReputation::Lookup("otherwiki", "Returning vandal", &stored), "Record was found on other site");
+    QVERIFY2(!Huggle::UserReputation::Lookup("testwiki", "Old vandal", &stored), "Expired record was found");
+    QVERIFY2(!Huggle::UserReputation::Lookup("testwiki", "Removed user", &stored), "Removed record was found");
+    QVERIFY2(Huggle::UserReputation::Compact(), "Store wasn't compacted");
+    QVERIFY2(Huggle::UserReputation::Count() == 1, "Compacted store has wrong number of records");
+    QVERIFY2(Huggle::UserReputation::Lookup("testwiki", "Returning vandal", &stored), "Record was lost by compaction");
+
+    // users that are not known in this session are restored from store
+    record.Expires = now + 3600;
+    Huggle::UserReputation::Store(hcfg->Project->Name, "Known vandal", record);
+    Huggle::WikiUser user("Known vandal", hcfg->Project);
+    QVERIFY2(user.GetBadnessScore(false) == 400, "User wasn't restored from store");
+    QVERIFY2(Huggle::WikiUser::RetrieveUser(&user) != nullptr, "Restored user wasn't inserted to list of problematic users");
+    // reputation is stored as soon as it changes, not only on shutdown
+    Huggle::WikiUser vandal("New vandal", hcfg->Project);
+    vandal.SetBadnessScore(300, false, false);
+    Huggle::WikiUser::UpdateUser(&vandal);
+    QVERIFY2(Huggle::UserReputation::Lookup(hcfg->Project->Name, "New vandal", &stored) && stored.BadnessScore == 300,
+             "Reputation wasn't stored when user was updated");
+    Huggle::UserReputation::Close();
+}
+
+void HuggleTest::testCaseApiQueryResult()
+{
+    Huggle::ApiQueryResult result;
+    result.Data = "<?xml version=\"1.0\"?><api><warnings><main xml:space=\"preserve\">Unrecognized parameter</main></warnings>"
+                  "<query><pages><page title=\"Test\" ns=\"0\"><revisions><rev revid=\"10\" user=\"Joe\">Hello <b>world</b></rev>"
+                  "<rev revid=\"9\" user=\"Frank\">Hi</rev></revisions></page></pages></query></api>";
+    result.Process();
+    QVERIFY2(!result.IsFailed(), "Result without error node failed");
+    QVERIFY2(result.Warning == "Unrecognized parameter", "Warning wasn't parsed");
+    QVERIFY2(result.GetNode("main") == nullptr, "Warnings were parsed as nodes");
+    QVERIFY2(result.Nodes.count() == 8, "Wrong number of nodes");
+    QList<Huggle::ApiQueryResultNode*> revisions = result.GetNodes("rev");
+    QVERIFY2(revisions.count() == 2, "Wrong number of rev nodes");
+    QVERIFY2(revisions.at(0)->GetAttribute("revid") == "10" && revisions.at(1)->Attributes["user"] == "Frank", "Nodes are in wrong order");
+    QVERIFY2(revisions.at(0)->Value == "Hello world", "Value doesn't contain text of child nodes");
+    Huggle::ApiQueryResultNode *page = result.GetNode("page");
+    QVERIFY2(page != nullptr && page->Attributes.contains("ns") && !page->Attributes.contains("revid"), "Wrong attributes of page");
+    QVERIFY2(page->ChildNodes.count() == 1 && page->ChildNodes.at(0)->ChildNodes.count() == 2, "Wrong hierarchy of nodes");
+    QVERIFY2(result.Root->ChildNodes.count() == 1 && result.Root->ChildNodes.at(0)->Name == "api", "Wrong root node");
+
+    Huggle::ApiQueryResult failed;
+    failed.Data = "<?xml version=\"1.0\"?><api><error code=\"badtoken\" info=\"Invalid token\">Invalid token</error></api>";
+    failed.Process();
+    QVERIFY2(failed.IsFailed(), "Error node wasn't recognized");
+    QVERIFY2(failed.GetNodeValue("error") == "Invalid token", "Wrong value of error node");
+
+    Huggle::ApiQueryResult json;
+    json.Data = "{\"query\":{\"recentchanges\":[{\"revid\":1}]}}";
+    json.ProcessJson(json.Data.toUtf8());
+    QVERIFY2(!json.IsFailed(), "Valid JSON failed");
+    QVERIFY2(json.Json.object().value("query").toObject().value("recentchanges").toArray().count() == 1, "JSON wasn't parsed");
+}
+
+void HuggleTest::testCaseQueryPool()
+{
+    Huggle::QueryPool::HugglePool = new Huggle::QueryPool();
+    TestQuery *waiting = new TestQuery(false);
+    TestQuery *polled = new TestQuery(true);
+    Huggle::QueryPool::HugglePool->AppendQuery(waiting);
+    Huggle::QueryPool::HugglePool->AppendQuery(polled);
+    waiting->SetStatus(Huggle::Query::StatusProcessing);
+    polled->SetStatus(Huggle::Query::StatusProcessing);
+    Huggle::QueryPool::HugglePool->CheckQueries();
+    QVERIFY2(waiting->Checks == 1, "Changed query wasn't checked");
+    Huggle::QueryPool::HugglePool->CheckQueries();
+    Huggle::QueryPool::HugglePool->CheckQueries();
+    QVERIFY2(waiting->Checks == 1, "Query that didn't change was checked again");
+    QVERIFY2(polled->Checks >= 3, "Polled query wasn't checked on every tick");
+    QVERIFY2(Huggle::QueryPool::HugglePool->RunningQueriesGetCount() == 2, "Running query was removed");
+    waiting->Result = new Huggle::QueryResult();
+    waiting->SetStatus(Huggle::Query::StatusDone);
+    Huggle::QueryPool::HugglePool->CheckQueries();
+    QVERIFY2(Huggle::QueryPool::HugglePool->RunningQueriesGetCount() == 1, "Finished query wasn't removed");
+    // finished query may be deleted right away, pool must not touch it when its time out comes
+    TestQuery *finished = new TestQuery(false);
+    finished->Timeout = 1;
+    Huggle::QueryPool::HugglePool->AppendQuery(finished);
+    finished->SetStatus(Huggle::Query::StatusProcessing);
+    finished->StartTime = QDateTime::currentDateTime();
+    Huggle::QueryPool::HugglePool->CheckQueries();
+    finished->Result = new Huggle::QueryResult();
+    finished->SetStatus(Huggle::Query::StatusDone);
+    Huggle::QueryPool::HugglePool->CheckQueries();
+    QVERIFY2(Huggle::QueryPool::HugglePool->RunningQueriesGetCount() == 1, "Finished query wasn't removed");
+    delete finished;
+    // query that never reports anything is still checked once it times out
+    waiting = new TestQuery(false);
+    waiting->Timeout = 1;
+    waiting->RetryOnTimeoutFailure = false;
+    Huggle::QueryPool::HugglePool->AppendQuery(waiting);
+    waiting->SetStatus(Huggle::Query::StatusProcessing);
+    waiting->StartTime = QDateTime::currentDateTime();
+    Huggle::QueryPool::HugglePool->CheckQueries();
+    QVERIFY2(!waiting->IsFailed(), "Query timed out too soon");
+    Huggle::Sleeper::msleep(1100);
+    Huggle::QueryPool::HugglePool->CheckQueries();
+    QVERIFY2(waiting->IsFailed(), "Query didn't time out");
+    QVERIFY2(Huggle::QueryPool::HugglePool->RunningQueriesGetCount() == 1, "Timed out query wasn't removed");
+    polled->Kill();
+    Huggle::QueryPool::HugglePool->CheckQueries();
+    QVERIFY2(Huggle::QueryPool::HugglePool->RunningQueriesGetCount() == 0, "Killed query wasn't removed");
+    // query that waits in scheduler doesn't time out, its time out starts once it's sent
+    int queries_per_site = hcfg->SystemConfig_QueriesPerSite;
+    hcfg->SystemConfig_QueriesPerSite = 1;
+    QNetworkAccessManager *network_manager = Huggle::Query::NetworkManager;
+    if (network_manager == nullptr)
+        Huggle::Query::NetworkManager = new QNetworkAccessManager();
+    Huggle::ApiQuery *sent = new Huggle::ApiQuery(Huggle::ActionQuery, hcfg->Project);
+    sent->URL = "http://127.0.0.1:1/api.php?action=query&titles=A";
+    Huggle::ApiQuery *queued = new Huggle::ApiQuery(Huggle::ActionQuery, hcfg->Project);
+    queued->URL = "http://127.0.0.1:1/api.php?action=query&titles=B";
+    queued->Timeout = 1;
+    queued->RetryOnTimeoutFailure = false;
+    Huggle::QueryPool::HugglePool->AppendQuery(sent);
+    Huggle::QueryPool::HugglePool->AppendQuery(queued);
+    sent->Process();
+    queued->Process();
+    QVERIFY2(Huggle::QueryPool::HugglePool->Scheduler->GetQueued() == 1, "Query wasn't queued");
+    Huggle::Sleeper::msleep(1100);
+    Huggle::QueryPool::HugglePool->CheckQueries();
+    QVERIFY2(!queued->IsFailed() && !queued->IsProcessed(), "Queued query timed out");
+    QDateTime before_sent = QDateTime::currentDateTime();
+    sent->Kill();
+    QVERIFY2(Huggle::QueryPool::HugglePool->Scheduler->GetQueued() == 0, "Query wasn't sent when slot was free");
+    QVERIFY2(queued->StartTime >= before_sent, "Time out of query doesn't start when it's sent");
+    Huggle::QueryPool::HugglePool->CheckQueries();
+    QVERIFY2(!queued->IsFailed(), "Query timed out right after it was sent");
+    queued->Kill();
+    Huggle::QueryPool::HugglePool->CheckQueries();
+    QVERIFY2(Huggle::QueryPool::HugglePool->RunningQueriesGetCount() == 0, "Killed query wasn't removed");
+    delete sent;
+    delete queued;
+    if (network_manager == nullptr)
+    {
+        delete Huggle::Query::NetworkManager;
+        Huggle::Query::NetworkManager = nullptr;
+    }
+    hcfg->SystemConfig_QueriesPerSite = queries_per_site;
+    delete Huggle::QueryPool::HugglePool;
+    Huggle::QueryPool::HugglePool = nullptr;
+}
+
+void HuggleTest::testCaseResponseCache()
+{
+    QTemporaryDir dir;
+    QString url = "https://en.wikipedia.org/w/api.php?action=compare&fromrev=10&torev=12&format=xml";
+    QByteArray data;
+    QString revision;
+    QVERIFY2(!Huggle::ResponseCache::Open(dir.path(), 0), "Cache with no size was open");
+    QVERIFY2(!Huggle::ResponseCache::Lookup(url, &data), "Closed cache returned data");
+    QVERIFY2(Huggle::ResponseCache::Open(dir.path(), 1024 * 1024), "Cache wasn't open");
+    QVERIFY2(!Huggle::ResponseCache::Lookup(url, &data), "Empty cache returned data");
+    Huggle::ResponseCache::Store(url, "<api><compare /></api>");
+    Huggle::ResponseCache::Store(url + "&titles=Test", "<api><page /></api>", "1234");
+    // data must survive restart
+    Huggle::ResponseCache::Close();
+    QVERIFY2(Huggle::ResponseCache::Open(dir.path(), 1024 * 1024), "Cache wasn't open again");
+    QVERIFY2(Huggle::ResponseCache::Lookup(url, &data, &revision), "Stored response wasn't found");
+    QVERIFY2(data == "<api><compare /></api>" && revision.isEmpty(), "Wrong data in cache");
+    QVERIFY2(Huggle::ResponseCache::Lookup(url + "&titles=Test", &data, &revision), "Stored page wasn't found");
+    QVERIFY2(data == "<api><page /></api>" && revision == "1234", "Wrong revision in cache");
+    QVERIFY2(Huggle::ResponseCache::GetSize() > 0, "Size of cache is unknown");
+    Huggle::ResponseCache::Clear();
+    QVERIFY2(!Huggle::ResponseCache::Lookup(url, &data), "Cleared cache returned data");
+    // config pages are cached only if their revision can be checked
+    Huggle::ApiQuery config(Huggle::ActionQuery, hcfg->Project);
+    config.CachePolicy = Huggle::ResponseCache::PolicyValidated;
+    config.Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|content") + "&rvlimit=1&titles=Project%3AHuggle%2FConfig";
+    QVERIFY2(config.GetCachePolicy() == Huggle::ResponseCache::PolicyValidated, "Config page isn't validated");
+    config.Parameters = "prop=revisions&rvprop=content&rvlimit=1&titles=Project%3AHuggle%2FConfig";
+    QVERIFY2(config.GetCachePolicy() == Huggle::ResponseCache::PolicyNever, "Content without revision id is cached");
+    Huggle::ApiQuery diff(Huggle::ActionCompare, hcfg->Project);
+    diff.Parameters = "fromrev=10&torelative=prev";
+    QVERIFY2(diff.GetCachePolicy() == Huggle::ResponseCache::PolicyPermanent, "Diff of fixed revision isn't cached");
+    diff.Parameters = "fromrev=10&torelative=cur";
+    QVERIFY2(diff.GetCachePolicy() == Huggle::ResponseCache::PolicyNever, "Diff to current revision is cached");
+    Huggle::ApiQuery revision(Huggle::ActionQuery, hcfg->Project);
+    revision.Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|timestamp|content") + "&revids=10";
+    QVERIFY2(revision.GetCachePolicy() == Huggle::ResponseCache::PolicyPermanent, "Text of revision isn't cached");
+    revision.Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|tags|user|timestamp|comment") + "&revids=10";
+    QVERIFY2(revision.GetCachePolicy() == Huggle::ResponseCache::PolicyNever, "Tags and user of revision are cached");
+    revision.Parameters = "prop=revisions&revids=10";
+    QVERIFY2(revision.GetCachePolicy() == Huggle::ResponseCache::PolicyNever, "Default properties of revision are cached");
+    Huggle::ApiQuery tokens(Huggle::ActionQuery, hcfg->Project);
+    tokens.Parameters = "meta=tokens&type=rollback";
+    QVERIFY2(tokens.GetCachePolicy() == Huggle::ResponseCache::PolicyNever, "Tokens are cached");
+    QString check = Huggle::ResponseCache::GetValidationUrl("https://en.wikipedia.org/w/api.php?action=query&prop=revisions&rvprop=ids%7Ccontent&titles=Test");
+    QVERIFY2(check.contains("rvprop=ids") && !check.contains("content"), "Validation url retrieves content");
+    Huggle::ApiQueryResult page;
+    page.Data = "<?xml version=\"1.0\"?><api><query><pages><page pageid=\"1\" ns=\"4\" title=\"Project:Huggle/Config\"><revisions>"
+                "<rev revid=\"1234\" parentid=\"1200\" xml:space=\"preserve\">enable-all:true</rev></revisions></page></pages></query></api>";
+    page.Process();
+    QVERIFY2(Huggle::ResponseCache::GetRevision(&page) == "1234", "Revision of page wasn't found");
+    Huggle::ApiQueryResult content;
+    content.Data = "<?xml version=\"1.0\"?><api><query><pages><page pageid=\"1\" ns=\"4\" title=\"Project:Huggle/Config\"><revisions>"
+                   "<rev xml:space=\"preserve\">enable-all:true</rev></revisions></page></pages></query></api>";
+    content.Process();
+    QVERIFY2(Huggle::ResponseCache::GetRevision(&content).isEmpty(), "Result without revision id has a revision");
+    Huggle::ResponseCache::Close();
+    QVERIFY2(config.GetCachePolicy() == Huggle::ResponseCache::PolicyNever, "Closed cache is used");
+}
+
 QTEST_APPLESS_MAIN(HuggleTest)
 
 #include "tst_testmain.moc"